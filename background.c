@@ -72,6 +72,7 @@
 #include "menu.h"
 #include "desktop.h"
 #include "background.h"
+#include "stats.h"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -261,9 +262,15 @@ static void BackgroundLoadImage(Background * background)
     xcb_rectangle_t rectangle;
     char *name;
 
-    // load icon
+    // load icon, scaled backgrounds are reduced while loading
     name = ExpandPath(background->Value);
-    icon = IconLoadNamed(name);
+    if (background->Type == BACKGROUND_IMAGE) {
+	icon = IconLoadNamed(name);
+    } else {
+	icon =
+	    IconLoadSized(name, XcbScreen->width_in_pixels,
+	    XcbScreen->height_in_pixels);
+    }
     free(name);
 
     if (!icon) {
@@ -348,7 +355,7 @@ void BackgroundInit(void)
     ia_cookie =
 	xcb_intern_atom_unchecked(Connection, 1, sizeof("XSETROOT_ID") - 1,
 	"XSETROOT_ID");
-    if ((ia_reply = xcb_intern_atom_reply(Connection, ia_cookie, NULL))) {
+    if ((ia_reply = StatsReply(xcb_intern_atom_reply, ia_cookie, NULL))) {
 	if (ia_reply->atom) {
 	    xcb_get_property_cookie_t gp_cookie;
 
@@ -357,7 +364,7 @@ void BackgroundInit(void)
 		xcb_get_property_unchecked(Connection, 1, XcbScreen->root,
 		ia_reply->atom, XCB_ATOM_PIXMAP, 0, UINT32_MAX);
 
-	    gp_reply = xcb_get_property_reply(Connection, gp_cookie, NULL);
+	    gp_reply = StatsReply(xcb_get_property_reply, gp_cookie, NULL);
 	    if (gp_reply) {
 		const void *data;
 
@@ -375,7 +382,7 @@ void BackgroundInit(void)
     }
 #endif
 
-    gp_reply = xcb_get_property_reply(Connection, Cookie, NULL);
+    gp_reply = StatsReply(xcb_get_property_reply, Cookie, NULL);
     if (gp_reply) {
 	const void *data;
 
@@ -55,6 +55,7 @@
 #include "menu.h"
 
 #include "readable_bitmap.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 // Declares
@@ -466,6 +467,8 @@ static void BorderDrawBorder(const Client * client, int draw_icon)
     uint32_t corner_pixel;
     xcb_rectangle_t rectangles[2];
 
+    StatsRedrawCount(STATS_REDRAW_BORDER);
+
     icon_size = BorderGetIconSize();
     BorderGetSize(client, &north, &south, &east, &west);
 
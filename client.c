@@ -28,7 +28,6 @@
 #include <string.h>
 
 #include <xcb/xcb_icccm.h>
-#include <xcb/xcb_aux.h>
 #ifdef USE_SHAPE
 #include <xcb/shape.h>
 #endif
@@ -53,6 +52,7 @@
 #include "plugin/swallow.h"
 #include "plugin/task.h"
 #include "desktop.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 // Placement
@@ -435,7 +435,7 @@ void ClientGetStrut(const Client * client)
     //	right_start_y, right_end_y, top_start_x, top_end_x, bottom_start_x,
     //	bottom_end_x,CARDINAL[12]/32
     // Struts MUST be specified in root window coordinates.
-    reply = xcb_get_property_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_property_reply, cookie, NULL);
     if (reply) {
 	if (reply->value_len && (data = xcb_get_property_value(reply))) {
 	    if (data[0] > 0) {		// left
@@ -488,7 +488,7 @@ void ClientGetStrut(const Client * client)
 
     // _NET_WM_STRUT, left, right, top, bottom, CARDINAL[4]/32
 
-    reply = xcb_get_property_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_property_reply, cookie, NULL);
     if (reply) {
 	if (reply->value_len && (data = xcb_get_property_value(reply))) {
 	    if (data[0] > 0) {		// left
@@ -1284,7 +1284,7 @@ static void ClientCheckShape(xcb_shape_query_extents_cookie_t cookie,
 {
     xcb_shape_query_extents_reply_t *reply;
 
-    if ((reply = xcb_shape_query_extents_reply(Connection, cookie, NULL))) {
+    if ((reply = StatsReply(xcb_shape_query_extents_reply, cookie, NULL))) {
 	if (reply->bounding_shaped) {
 	    client->State |= WM_STATE_SHAPE;
 	}
@@ -1372,6 +1372,48 @@ void ClientUnshade(Client * client)
     ClientRestack();
 }
 
+/**
+**	Update client frame after border size changes.
+**
+**	Keeps the client window at its position and resizes the frame
+**	around it.
+**
+**	@param client	client to update
+*/
+void ClientUpdateFrame(Client * client)
+{
+    int north;
+    int south;
+    int east;
+    int west;
+    uint32_t values[4];
+
+    if (client->State & WM_STATE_FULLSCREEN) {	// fullscreen has no frame
+	return;
+    }
+
+    BorderGetSize(client, &north, &south, &east, &west);
+    values[0] = client->X - west;
+    values[1] = client->Y - north;
+    values[2] = client->Width + east + west;
+    values[3] = north;
+    if (!(client->State & WM_STATE_SHADED)) {
+	values[3] += client->Height + south;
+    }
+    xcb_configure_window(Connection, client->Parent,
+	XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH |
+	XCB_CONFIG_WINDOW_HEIGHT, values);
+
+    values[0] = west;
+    values[1] = north;
+    xcb_configure_window(Connection, client->Window,
+	XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+
+    ClientUpdateShape(client);
+    HintSetAllStates(client);
+    ClientSendConfigureEvent(client);
+}
+
 /**
 **	Set full screen status of client.
 **
@@ -1667,6 +1709,7 @@ void ClientRestore(Client * client, int raise)
 
     ClientRestack();
     TaskUpdate();
+    PagerUpdateThumbnails();
     PagerUpdate();
 }
 
@@ -2163,7 +2206,7 @@ Client *ClientAddWindow(xcb_window_t window,
     xcb_get_geometry_reply_t *geom_reply;
     Client *client;
 
-    attr_reply = xcb_get_window_attributes_reply(Connection, cookie, NULL);
+    attr_reply = StatsReply(xcb_get_window_attributes_reply, cookie, NULL);
     if (!attr_reply) {
 	return NULL;			// error can't get reply
     }
@@ -2186,12 +2229,15 @@ Client *ClientAddWindow(xcb_window_t window,
 
 #ifdef USE_COLORMAP
     client->Colormap = attr_reply->colormap;
+#endif
+#ifdef USE_PAGER_THUMBNAIL
+    client->Visual = attr_reply->visual;
 #endif
     free(attr_reply);
 
     // FIXME: pre fetch all properties
 
-    geom_reply = xcb_get_geometry_reply(Connection, geom_cookie, NULL);
+    geom_reply = StatsReply(xcb_get_geometry_reply, geom_cookie, NULL);
     client->X = geom_reply->x;
     client->Y = geom_reply->y;
     client->Width = geom_reply->width;
@@ -2240,6 +2286,7 @@ Client *ClientAddWindow(xcb_window_t window,
     // FIXME: not needed during startup
     TaskUpdate();
     HintSetNetClientList();
+    PagerUpdateThumbnails();
 
     if (!already_mapped) {
 	ClientRaise(client);
@@ -2365,6 +2412,7 @@ void ClientDelWindow(Client * client)
     TaskUpdate();
     HintSetNetClientList();
     ClientDelStrut(client);
+    PagerUpdateThumbnails();
     PagerUpdate();
 
 #ifdef USE_COLORMAP
@@ -2415,11 +2463,11 @@ static void ClientKillHandler(Client * client)
     }
 
     xcb_grab_server(Connection);
-    xcb_aux_sync(Connection);
+    StatsSync();
 
     xcb_kill_client(Connection, client->Window);
 
-    xcb_aux_sync(Connection);
+    StatsSync();
     xcb_ungrab_server(Connection);
 
     ClientDelWindow(client);
@@ -2457,7 +2505,8 @@ void ClientDelete(Client * client)
 
     // FIXME: move into functions...
     // check if client supports WM_DELETE_WINDOW
-    if (xcb_icccm_get_wm_protocols_reply(Connection, cookie, &protocols, NULL)) {
+    if (StatsReply(xcb_icccm_get_wm_protocols_reply, cookie, &protocols,
+	    NULL)) {
 	unsigned u;
 
 	for (u = 0; u < protocols.atoms_len; ++u) {
@@ -2489,7 +2538,7 @@ static void ClientUpdateFocus(void)
     Client *client;
 
     cookie = xcb_query_pointer_unchecked(Connection, XcbScreen->root);
-    reply = xcb_query_pointer_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_query_pointer_reply, cookie, NULL);
     if (reply) {
 	client = ClientFindByAny(reply->child);
 	if (client) {
@@ -2539,7 +2588,7 @@ void ClientInit(void)
     // load windows that are already mapped
     //
     // query client windows pre-fetched from pre-init
-    if (!(reply = xcb_query_tree_reply(Connection, QueryTreeCookie, NULL))) {
+    if (!(reply = StatsReply(xcb_query_tree_reply, QueryTreeCookie, NULL))) {
 	Debug(2, "xcb_query_tree_reply failed\n");
 	return;
     }
@@ -150,6 +150,9 @@ struct _client_
     xcb_colormap_t Colormap;		///< window's colormap
     // ColormapNode *Colormaps;		///< colormaps assigned to this window
 #endif
+#ifdef USE_PAGER_THUMBNAIL
+    xcb_visualid_t Visual;		///< window's visual
+#endif
 
     //@{
     WmState State:16;			///< state bit mask
@@ -241,6 +244,9 @@ extern void ClientShade(Client *);
     /// Unshade a client.
 extern void ClientUnshade(Client *);
 
+    /// Update client frame after border size changes.
+extern void ClientUpdateFrame(Client *);
+
     /// Set full screen status of a client.
 extern void ClientSetFullscreen(Client *, int);
 
@@ -0,0 +1,702 @@
+///
+///	@file uwm-bench.c	@brief benchmark client for uwm
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+///
+///	@defgroup bench The benchmark client.
+///
+///	This standalone client drives a running uwm with storms of client
+///	requests and prints the results as JSON to stdout.
+///
+///	After each phase the client waits until uwm has handled all
+///	events, by requesting the runtime statistics (_UWM_STATISTICS) and
+///	waiting for the property update.  The statistics also give the
+///	bytes uwm has written to the X11 server and its round-trips.
+///
+///	Usage: uwm-bench [-n windows] [-i iterations] [-p uwm-pid]
+///
+/// @{
+
+#include <xcb/xcb.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+
+#define BENCH_DESKTOPS	4		///< desktops to switch through
+#define BENCH_ICON_SIZE	16		///< size of _NET_WM_ICON
+
+/**
+**	Result of a benchmark phase.
+*/
+typedef struct _bench_phase_
+{
+    const char *Name;			///< name of phase
+    unsigned Operations;		///< number of operations
+    uint64_t Time;			///< time of phase in us
+    uint64_t Bytes;			///< bytes written by uwm
+    unsigned RoundTrips;		///< round-trips of uwm
+    uint64_t Cpu;			///< cpu time of uwm in us
+    uint64_t ManagedTotal;		///< sum of time-to-managed in us
+    uint64_t ManagedMax;		///< longest time-to-managed in us
+    unsigned Managed;			///< number of managed windows
+} BenchPhase;
+
+static xcb_connection_t *Connection;	///< connection to X11 server
+static xcb_screen_t *Screen;		///< our screen
+
+static xcb_atom_t AtomStatistics;	///< _UWM_STATISTICS
+static xcb_atom_t AtomNetWmName;	///< _NET_WM_NAME
+static xcb_atom_t AtomNetWmIcon;	///< _NET_WM_ICON
+static xcb_atom_t AtomNetCurrentDesktop;	///< _NET_CURRENT_DESKTOP
+static xcb_atom_t AtomUtf8String;	///< UTF8_STRING
+
+static int WmPid;			///< process id of uwm, 0 unknown
+
+static unsigned WindowCount = 64;	///< number of windows
+static unsigned Iterations = 16;	///< iterations per window
+static xcb_window_t *Windows;		///< our windows
+static uint64_t *MapTimes;		///< time stamps of map requests
+
+static BenchPhase *Phase;		///< current phase
+static uint64_t PhaseBytes;		///< uwm bytes at start of phase
+static unsigned PhaseRoundTrips;	///< uwm round-trips at phase start
+static uint64_t PhaseCpu;		///< uwm cpu time at start of phase
+
+/**
+**	Get time stamp.
+**
+**	@returns monotonic time in us.
+*/
+static uint64_t GetTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+**	Get cpu time of uwm.
+**
+**	@returns user + system time of uwm in us, 0 if unknown.
+*/
+static uint64_t WmGetCpu(void)
+{
+    char path[64];
+    FILE *file;
+    unsigned long utime;
+    unsigned long stime;
+    int n;
+
+    if (!WmPid) {
+	return 0;
+    }
+    snprintf(path, sizeof(path), "/proc/%d/stat", WmPid);
+    if (!(file = fopen(path, "r"))) {
+	return 0;
+    }
+    // skip pid, comm, ... until utime and stime (fields 14 and 15)
+    n = fscanf(file, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u"
+	" %lu %lu", &utime, &stime);
+    fclose(file);
+    if (n != 2) {
+	return 0;
+    }
+    return (utime + stime) * 1000000ULL / sysconf(_SC_CLK_TCK);
+}
+
+/**
+**	Intern an atom.
+**
+**	@param name	atom name
+**
+**	@returns atom.
+*/
+static xcb_atom_t InternAtom(const char *name)
+{
+    xcb_intern_atom_reply_t *reply;
+    xcb_atom_t atom;
+
+    reply =
+	xcb_intern_atom_reply(Connection, xcb_intern_atom(Connection, 0,
+	    strlen(name), name), NULL);
+    if (!reply) {
+	fprintf(stderr, "Can't intern atom '%s'\n", name);
+	exit(-1);
+    }
+    atom = reply->atom;
+    free(reply);
+    return atom;
+}
+
+/**
+**	Send client message to the root window.
+**
+**	@param type	message type
+**	@param data0	first data word
+*/
+static void SendRootMessage(xcb_atom_t type, uint32_t data0)
+{
+    xcb_client_message_event_t event;
+
+    memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.format = 32;
+    event.window = Screen->root;
+    event.type = type;
+    event.data.data32[0] = data0;
+
+    xcb_send_event(Connection, 0, Screen->root,
+	XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT |
+	XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, (void *)&event);
+}
+
+/**
+**	Handle event of our windows.
+**
+**	Accounts the time-to-managed, when uwm maps the window.
+**
+**	@param event	map notify event
+*/
+static void HandleMapNotify(const xcb_map_notify_event_t * event)
+{
+    uint64_t time;
+    unsigned u;
+
+    for (u = 0; u < WindowCount; ++u) {
+	if (Windows[u] == event->window && MapTimes[u]) {
+	    time = GetTime() - MapTimes[u];
+	    MapTimes[u] = 0;
+	    Phase->ManagedTotal += time;
+	    if (time > Phase->ManagedMax) {
+		Phase->ManagedMax = time;
+	    }
+	    Phase->Managed++;
+	    break;
+	}
+    }
+}
+
+/**
+**	Handle all pending events.
+**
+**	@returns true if the statistics property was updated.
+*/
+static int HandleEvents(void)
+{
+    xcb_generic_event_t *event;
+    int updated;
+
+    updated = 0;
+    while ((event = xcb_poll_for_event(Connection))) {
+	switch (event->response_type & ~0x80) {
+	    case XCB_MAP_NOTIFY:
+		HandleMapNotify((xcb_map_notify_event_t *) event);
+		break;
+	    case XCB_PROPERTY_NOTIFY:
+		if (((xcb_property_notify_event_t *) event)->atom ==
+		    AtomStatistics) {
+		    updated = 1;
+		}
+		break;
+	}
+	free(event);
+    }
+    return updated;
+}
+
+/**
+**	Parse uwm statistics.
+**
+**	@param text		statistics text
+**	@param[out] bytes	bytes written by uwm
+**	@param[out] round_trips	round-trips of uwm
+*/
+static void ParseStatistics(const char *text, uint64_t * bytes,
+    unsigned *round_trips)
+{
+    const char *s;
+    unsigned long long written;
+    unsigned count;
+    int audit;
+
+    *bytes = 0;
+    *round_trips = 0;
+    if ((s = strstr(text, "\nloop: "))
+	&& sscanf(s, "\nloop: %*u iterations, %llu", &written) == 1) {
+	*bytes = written;
+    }
+    // round-trips section, audit has count in first column
+    audit = 0;
+    if ((s = strstr(text, "\nround-trip audit"))) {
+	audit = 1;
+	s = strchr(s + 1, '\n');	// skip column header
+    } else {
+	s = strstr(text, "\nround-trips:");
+    }
+    if (!s) {
+	return;
+    }
+    s = strchr(s + 1, '\n');
+    while (s && s[1] == ' ' && s[2] == ' ') {
+	const char *e;
+
+	e = strchr(s + 1, '\n');
+	if (audit) {
+	    count = strtoul(s + 1, NULL, 10);
+	} else {
+	    const char *n;
+
+	    // count is last number of line
+	    for (n = e; n > s && n[-1] != ' '; --n) {
+	    }
+	    count = strtoul(n, NULL, 10);
+	}
+	*round_trips += count;
+	s = e;
+    }
+}
+
+/**
+**	Wait until uwm has handled all previous events.
+**
+**	@param timeout		timeout in ms
+**	@param[out] bytes	bytes written by uwm
+**	@param[out] round_trips	round-trips of uwm
+*/
+static void WmSync(int timeout, uint64_t * bytes, unsigned *round_trips)
+{
+    xcb_get_property_reply_t *reply;
+    struct pollfd fds[1];
+    char *text;
+
+    SendRootMessage(AtomStatistics, 0);
+    xcb_flush(Connection);
+
+    fds[0].fd = xcb_get_file_descriptor(Connection);
+    fds[0].events = POLLIN;
+    while (!HandleEvents()) {
+	if (poll(fds, 1, timeout) <= 0
+	    || xcb_connection_has_error(Connection)) {
+	    fprintf(stderr, "No statistics from uwm (NO_STATS?)\n");
+	    exit(-1);
+	}
+    }
+
+    reply =
+	xcb_get_property_reply(Connection, xcb_get_property(Connection, 0,
+	    Screen->root, AtomStatistics, XCB_ATOM_STRING, 0, UINT32_MAX / 4),
+	NULL);
+    if (!reply) {
+	*bytes = 0;
+	*round_trips = 0;
+	return;
+    }
+    text = strndup(xcb_get_property_value(reply),
+	xcb_get_property_value_length(reply));
+    ParseStatistics(text, bytes, round_trips);
+    free(text);
+    free(reply);
+}
+
+/**
+**	Begin benchmark phase.
+**
+**	@param phase	phase result
+**	@param name	name of phase
+*/
+static void PhaseBegin(BenchPhase * phase, const char *name)
+{
+    memset(phase, 0, sizeof(*phase));
+    phase->Name = name;
+    Phase = phase;
+
+    WmSync(5000, &PhaseBytes, &PhaseRoundTrips);
+    PhaseCpu = WmGetCpu();
+    phase->Time = GetTime();
+}
+
+/**
+**	End benchmark phase.
+**
+**	@param operations	number of operations done in phase
+*/
+static void PhaseEnd(unsigned operations)
+{
+    uint64_t bytes;
+    unsigned round_trips;
+
+    WmSync(30000, &bytes, &round_trips);
+    Phase->Time = GetTime() - Phase->Time;
+    Phase->Cpu = WmGetCpu() - PhaseCpu;
+    Phase->Operations = operations;
+    // the statistics request itself costs a little
+    Phase->Bytes = bytes - PhaseBytes;
+    Phase->RoundTrips = round_trips - PhaseRoundTrips;
+}
+
+/**
+**	Create and map windows.
+**
+**	@param phase	phase result
+*/
+static void BenchMap(BenchPhase * phase)
+{
+    uint32_t values[1];
+    unsigned u;
+
+    PhaseBegin(phase, "map");
+    values[0] = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    for (u = 0; u < WindowCount; ++u) {
+	char name[32];
+
+	Windows[u] = xcb_generate_id(Connection);
+	xcb_create_window(Connection, XCB_COPY_FROM_PARENT, Windows[u],
+	    Screen->root, (u * 16) % 640, (u * 12) % 480, 200, 150, 0,
+	    XCB_WINDOW_CLASS_INPUT_OUTPUT, Screen->root_visual,
+	    XCB_CW_EVENT_MASK, values);
+	snprintf(name, sizeof(name), "bench %u", u);
+	xcb_change_property(Connection, XCB_PROP_MODE_REPLACE, Windows[u],
+	    XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, strlen(name), name);
+	MapTimes[u] = GetTime();
+	xcb_map_window(Connection, Windows[u]);
+	xcb_flush(Connection);
+	// time map notifies when they arrive, not after all maps
+	HandleEvents();
+    }
+    PhaseEnd(WindowCount);
+}
+
+/**
+**	Change titles of all windows.
+**
+**	@param phase	phase result
+*/
+static void BenchTitle(BenchPhase * phase)
+{
+    unsigned i;
+    unsigned u;
+
+    PhaseBegin(phase, "title");
+    for (i = 0; i < Iterations; ++i) {
+	for (u = 0; u < WindowCount; ++u) {
+	    char name[64];
+
+	    snprintf(name, sizeof(name), "bench %u title %u", u, i);
+	    xcb_change_property(Connection, XCB_PROP_MODE_REPLACE, Windows[u],
+		AtomNetWmName, AtomUtf8String, 8, strlen(name), name);
+	    xcb_change_property(Connection, XCB_PROP_MODE_REPLACE, Windows[u],
+		XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, strlen(name), name);
+	}
+	xcb_flush(Connection);
+    }
+    PhaseEnd(Iterations * WindowCount);
+}
+
+/**
+**	Change icons of all windows.
+**
+**	@param phase	phase result
+*/
+static void BenchIcon(BenchPhase * phase)
+{
+    uint32_t icon[2 + BENCH_ICON_SIZE * BENCH_ICON_SIZE];
+    unsigned i;
+    unsigned u;
+    unsigned j;
+
+    PhaseBegin(phase, "icon");
+    icon[0] = BENCH_ICON_SIZE;
+    icon[1] = BENCH_ICON_SIZE;
+    for (i = 0; i < Iterations; ++i) {
+	for (u = 0; u < WindowCount; ++u) {
+	    for (j = 0; j < BENCH_ICON_SIZE * BENCH_ICON_SIZE; ++j) {
+		icon[2 + j] = 0xFF000000 | ((i * 16) << 16) | (u << 8) | j;
+	    }
+	    xcb_change_property(Connection, XCB_PROP_MODE_REPLACE, Windows[u],
+		AtomNetWmIcon, XCB_ATOM_CARDINAL, 32,
+		sizeof(icon) / sizeof(*icon), icon);
+	}
+	xcb_flush(Connection);
+    }
+    PhaseEnd(Iterations * WindowCount);
+}
+
+/**
+**	Raise and lower all windows.
+**
+**	@param phase	phase result
+*/
+static void BenchRaiseLower(BenchPhase * phase)
+{
+    uint32_t values[1];
+    unsigned i;
+    unsigned u;
+
+    PhaseBegin(phase, "raise-lower");
+    for (i = 0; i < Iterations; ++i) {
+	values[0] = i & 1 ? XCB_STACK_MODE_BELOW : XCB_STACK_MODE_ABOVE;
+	for (u = 0; u < WindowCount; ++u) {
+	    xcb_configure_window(Connection, Windows[u],
+		XCB_CONFIG_WINDOW_STACK_MODE, values);
+	}
+	xcb_flush(Connection);
+    }
+    PhaseEnd(Iterations * WindowCount);
+}
+
+/**
+**	Switch desktops.
+**
+**	@param phase	phase result
+*/
+static void BenchDesktop(BenchPhase * phase)
+{
+    unsigned i;
+
+    PhaseBegin(phase, "desktop");
+    for (i = 0; i < Iterations * BENCH_DESKTOPS; ++i) {
+	SendRootMessage(AtomNetCurrentDesktop, (i + 1) % BENCH_DESKTOPS);
+	xcb_flush(Connection);
+    }
+    PhaseEnd(Iterations * BENCH_DESKTOPS);
+}
+
+/**
+**	Move all windows in steps.
+**
+**	Clients can't drag with the pointer, the steps are sent as
+**	configure requests.
+**
+**	@param phase	phase result
+*/
+static void BenchMove(BenchPhase * phase)
+{
+    uint32_t values[2];
+    unsigned i;
+    unsigned u;
+
+    PhaseBegin(phase, "move");
+    for (i = 0; i < Iterations; ++i) {
+	for (u = 0; u < WindowCount; ++u) {
+	    values[0] = (u * 16 + i * 8) % 640;
+	    values[1] = (u * 12 + i * 6) % 480;
+	    xcb_configure_window(Connection, Windows[u],
+		XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+	}
+	xcb_flush(Connection);
+    }
+    PhaseEnd(Iterations * WindowCount);
+}
+
+/**
+**	Resize all windows in steps.
+**
+**	@param phase	phase result
+*/
+static void BenchResize(BenchPhase * phase)
+{
+    uint32_t values[2];
+    unsigned i;
+    unsigned u;
+
+    PhaseBegin(phase, "resize");
+    for (i = 0; i < Iterations; ++i) {
+	for (u = 0; u < WindowCount; ++u) {
+	    values[0] = 200 + i * 8;
+	    values[1] = 150 + i * 6;
+	    xcb_configure_window(Connection, Windows[u],
+		XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+	}
+	xcb_flush(Connection);
+    }
+    PhaseEnd(Iterations * WindowCount);
+}
+
+/**
+**	Destroy all windows.
+**
+**	@param phase	phase result
+*/
+static void BenchDestroy(BenchPhase * phase)
+{
+    unsigned u;
+
+    PhaseBegin(phase, "destroy");
+    for (u = 0; u < WindowCount; ++u) {
+	xcb_destroy_window(Connection, Windows[u]);
+    }
+    xcb_flush(Connection);
+    PhaseEnd(WindowCount);
+}
+
+/**
+**	Print results as JSON.
+**
+**	@param phases	phase results
+**	@param n	number of phases
+*/
+static void PrintJson(const BenchPhase * phases, int n)
+{
+    int i;
+
+    printf("{\n  \"windows\": %u,\n  \"iterations\": %u,\n  \"phases\": [\n",
+	WindowCount, Iterations);
+    for (i = 0; i < n; ++i) {
+	const BenchPhase *phase;
+	unsigned ops;
+
+	phase = &phases[i];
+	ops = phase->Operations ? phase->Operations : 1;
+	printf("    {\n      \"name\": \"%s\",\n", phase->Name);
+	printf("      \"operations\": %u,\n", phase->Operations);
+	printf("      \"time_us\": %llu,\n", (unsigned long long)phase->Time);
+	printf("      \"time_us_per_op\": %.2f,\n",
+	    (double)phase->Time / ops);
+	printf("      \"wm_bytes_per_op\": %.2f,\n",
+	    (double)phase->Bytes / ops);
+	printf("      \"wm_round_trips_per_op\": %.3f,\n",
+	    (double)phase->RoundTrips / ops);
+	printf("      \"wm_cpu_us_per_op\": %.2f", (double)phase->Cpu / ops);
+	if (phase->Managed) {
+	    printf(",\n      \"managed\": %u,\n", phase->Managed);
+	    printf("      \"time_to_managed_avg_us\": %.1f,\n",
+		(double)phase->ManagedTotal / phase->Managed);
+	    printf("      \"time_to_managed_max_us\": %llu",
+		(unsigned long long)phase->ManagedMax);
+	}
+	printf("\n    }%s\n", i + 1 < n ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+/**
+**	Print usage.
+*/
+static void PrintUsage(void)
+{
+    printf("Usage: uwm-bench [-n windows] [-i iterations] [-p uwm-pid]\n"
+	"\t-n windows\tnumber of windows (%u)\n"
+	"\t-i iterations\titerations per window (%u)\n"
+	"\t-p uwm-pid\tprocess id of uwm, for cpu time\n", WindowCount,
+	Iterations);
+}
+
+/**
+**	Main entry point.
+**
+**	@param argc	number of arguments
+**	@param argv	arguments vector
+**
+**	@returns -1 on failures, 0 clean exit.
+*/
+int main(int argc, char *const argv[])
+{
+    BenchPhase phases[8];
+    uint32_t value;
+    uint64_t bytes;
+    unsigned round_trips;
+    int screen_nr;
+    xcb_screen_iterator_t iter;
+    int i;
+
+    for (;;) {
+	switch (getopt(argc, argv, "h?n:i:p:")) {
+	    case 'n':
+		WindowCount = strtoul(optarg, NULL, 0);
+		continue;
+	    case 'i':
+		Iterations = strtoul(optarg, NULL, 0);
+		continue;
+	    case 'p':
+		WmPid = strtol(optarg, NULL, 0);
+		continue;
+	    case EOF:
+		break;
+	    case '?':
+	    case 'h':
+		PrintUsage();
+		return 0;
+	    default:
+		PrintUsage();
+		return -1;
+	}
+	break;
+    }
+    if (!WindowCount || !Iterations) {
+	PrintUsage();
+	return -1;
+    }
+
+    Connection = xcb_connect(NULL, &screen_nr);
+    if (!Connection || xcb_connection_has_error(Connection)) {
+	fprintf(stderr, "Can't connect to X11 server\n");
+	return -1;
+    }
+    iter = xcb_setup_roots_iterator(xcb_get_setup(Connection));
+    for (i = 0; i < screen_nr; ++i) {
+	xcb_screen_next(&iter);
+    }
+    Screen = iter.data;
+
+    AtomStatistics = InternAtom("_UWM_STATISTICS");
+    AtomNetWmName = InternAtom("_NET_WM_NAME");
+    AtomNetWmIcon = InternAtom("_NET_WM_ICON");
+    AtomNetCurrentDesktop = InternAtom("_NET_CURRENT_DESKTOP");
+    AtomUtf8String = InternAtom("UTF8_STRING");
+
+    // property changes of the root window signal handled statistics
+    value = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(Connection, Screen->root,
+	XCB_CW_EVENT_MASK, &value);
+
+    Windows = calloc(WindowCount, sizeof(*Windows));
+    MapTimes = calloc(WindowCount, sizeof(*MapTimes));
+
+    // wait for uwm to be ready
+    memset(phases, 0, sizeof(phases));
+    Phase = phases;
+    WmSync(10000, &bytes, &round_trips);
+
+    BenchMap(&phases[0]);
+    BenchTitle(&phases[1]);
+    BenchIcon(&phases[2]);
+    BenchRaiseLower(&phases[3]);
+    BenchDesktop(&phases[4]);
+    BenchMove(&phases[5]);
+    BenchResize(&phases[6]);
+    BenchDestroy(&phases[7]);
+
+    PrintJson(phases, 8);
+
+    free(MapTimes);
+    free(Windows);
+    xcb_disconnect(Connection);
+
+    return 0;
+}
+
+/// @}
@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+#	this script runs the uwm benchmark client under Xvfb.
+#
+#	Usage: contrib/uwm-bench.sh [uwm-bench options] > bench.json
+#
+#	BENCH_DISPLAY selects the display of Xvfb (:97).
+#	uwm must be compiled with USE_STATS (default).
+#
+BENCH_DISPLAY=${BENCH_DISPLAY:-:97}
+
+CONFIG=`mktemp -t uwm-bench.XXXXXX` || exit 1
+XVFB=
+UWM=
+
+cleanup() {
+	[ -n "$UWM" ] && kill $UWM 2>/dev/null
+	[ -n "$XVFB" ] && kill $XVFB 2>/dev/null
+	rm -f $CONFIG
+}
+trap cleanup EXIT INT TERM
+
+#	fixed configuration, independent of ~/.uwm/uwmrc
+cat > $CONFIG <<EOF
+desktop.count = 4
+panel = [
+    [0] = [
+	gravity = "south" height = 24 width = -100
+	[ type = \`pager ]
+	[ type = \`task ]
+    ]
+]
+EOF
+
+SOCKET=/tmp/.X11-unix/X${BENCH_DISPLAY#:}
+
+#	don't benchmark another X11 server or stale sockets
+if [ -e $SOCKET -o -e /tmp/.X${BENCH_DISPLAY#:}-lock ]; then
+	echo "display $BENCH_DISPLAY is in use, set BENCH_DISPLAY" >&2
+	exit 1
+fi
+
+Xvfb $BENCH_DISPLAY -screen 0 1280x1024x24 -nolisten tcp >/dev/null 2>&1 &
+XVFB=$!
+export DISPLAY=$BENCH_DISPLAY
+
+#	wait for the X11 server
+i=0
+until [ -e $SOCKET ]; do
+	i=$((i + 1))
+	if ! kill -0 $XVFB 2>/dev/null || [ $i -gt 50 ]; then
+		echo "Xvfb $BENCH_DISPLAY didn't start" >&2
+		exit 1
+	fi
+	sleep 0.1
+done
+
+./uwm -c $CONFIG >/dev/null &
+UWM=$!
+
+#	uwm-bench waits until uwm answers its first statistics request
+contrib/uwm-bench -p $UWM "$@"
@@ -134,6 +134,7 @@ void DesktopChange(int desktop)
 
     ClientRestack();
     TaskUpdate();
+    PagerUpdateThumbnails();
     PagerUpdate();
     DesktopUpdate();
 
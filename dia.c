@@ -63,11 +63,19 @@
 #ifdef USE_DIA				// {
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
 
 #include <xcb/xcb_icccm.h>
 #include <xcb/xcb_atom.h>
@@ -107,20 +115,99 @@
     /// default corner command height
 #define DIA_CORNER_HEIGHT (96 / 2)
 
-#if 0
+    /// maximal number of cached images
+#define DIA_CACHE_SIZE 128
+    /// maximal memory used by cached images and pixmaps
+#define DIA_CACHE_MEMORY (64 * 1024 * 1024)
+    /// number of background image decoder threads
+#define DIA_DECODE_THREADS 2
 
-#define DIA_CACHE_SIZE	10
+    /// magic of stored thumbnails ("uwT1")
+#define DIA_THUMBNAIL_MAGIC 0x31547775
+    /// maximal disk space used by stored thumbnails
+#define DIA_THUMBNAIL_STORE_SIZE (256 * 1024 * 1024)
+    /// stored thumbnails not used for this many seconds are removed
+#define DIA_THUMBNAIL_STORE_AGE (90 * 24 * 60 * 60)
 
 /**
-**	Thumbnail image cache.
+**	Decoded image cache entry.
 */
 typedef struct _dia_cache_
 {
-    const char *Name;			///< image file name
-    Icon *Icon;				///< icon image
+    char *Name;				///< image file name
+    time_t MTime;			///< modification time of file
+    uint32_t Used;			///< last use of entry (LRU)
+
+    uint16_t Width;			///< requested width of image
+    uint16_t Height;			///< requested height of image
+    uint16_t PixmapWidth;		///< width of scaled image
+    uint16_t PixmapHeight;		///< height of scaled image
+    unsigned Thumbnail:1;		///< fast decoded thumbnail
+
+    Image *Image;			///< decoded image (or NULL)
+    xcb_pixmap_t Pixmap;		///< scaled image
 } DiaCache;
 
-#endif
+/**
+**	Stored thumbnail file header.
+**
+**	Followed by the source file name and the raw image data.
+*/
+typedef struct _dia_thumbnail_header_
+{
+    uint32_t Magic;			///< DIA_THUMBNAIL_MAGIC
+    uint32_t PathLength;		///< length of source file name
+    int64_t MTime;			///< modification time of source file
+    uint16_t Width;			///< width of thumbnail
+    uint16_t Height;			///< height of thumbnail
+} DiaThumbnailHeader;
+
+/**
+**	Dia decode job state.
+*/
+typedef enum _dia_job_state_
+{
+    DIA_JOB_QUEUED,			///< waiting for decoder thread
+    DIA_JOB_RUNNING,			///< decoder thread works on it
+    DIA_JOB_DONE,			///< decoded, waits for main thread
+} DiaJobState;
+
+/**
+**	Dia background decode job.
+*/
+typedef struct _dia_job_
+{
+    TAILQ_ENTRY(_dia_job_) Next;	///< job queue
+
+    char *Name;				///< image file name (cache key)
+    char *File;				///< full file name
+    time_t MTime;			///< modification time of file
+    uint16_t Width;			///< requested width of image
+    uint16_t Height;			///< requested height of image
+    // no bitfields, prefetch is changed while a decoder thread runs
+    uint8_t Thumbnail;			///< fast decoded thumbnail
+    uint8_t Prefetch;			///< image isn't visible yet
+    DiaJobState State;			///< job state
+    unsigned Serial;			///< dia-show generation of job
+
+    Image *Image;			///< decoded image (or NULL)
+    Image *Scaled;			///< image scaled to requested size
+} DiaJob;
+
+/**
+**	Dia background decoder.
+*/
+typedef struct _dia_decoder_
+{
+    pthread_mutex_t Mutex;		///< protects job queue
+    pthread_cond_t Cond;		///< signals new jobs
+    TAILQ_HEAD(_dia_job_head_, _dia_job_) Jobs;	///< job queue
+    pthread_t Threads[DIA_DECODE_THREADS];	///< decoder threads
+    int EventFd;			///< signals finished jobs
+    int Started;			///< number of started threads
+    int Quit;				///< request threads to quit
+    unsigned Serial;			///< current dia-show generation
+} DiaDecode;
 
 /**
 **	Dia display layout mode.
@@ -187,11 +274,21 @@ struct _dia_
     size_t FirstIndex;			///< first index of film-strip/index
     // Array *DirTree;			///< directory tree
 
-    // DiaCache Cache[DIA_CACHE_SIZE];	///< image cache
+    xcb_coloritem_t Background;		///< background color for alpha
+
+    char *ThumbnailDir;			///< thumbnail store directory
+
+    uint32_t CacheUsed;			///< cache use counter
+    DiaCache Cache[DIA_CACHE_SIZE];	///< decoded image cache
 };
 
 static Dia DiaVars[1];			///< dia-show globals
 
+    /// background image decoder
+static DiaDecode DiaDecoder[1] = {
+    {.EventFd = -1}
+};
+
 // ------------------------------------------------------------------------ //
 
 /**
@@ -291,10 +388,32 @@ static void DiaScaledIconSize(const Icon * icon, unsigned max_width,
 }
 #endif
 
+/**
+**	Get pixel of an image color blended with the dia background.
+**
+**	@param argb	premultiplied ARGB color
+**
+**	@returns x11 pixel value.
+*/
+static uint32_t DiaImagePixel(const uint8_t * argb)
+{
+    xcb_coloritem_t color;
+    unsigned alpha;
+
+    alpha = 255 - argb[0];
+    color.red = 257 * argb[1] + (DiaVars->Background.red * alpha) / 255;
+    color.green = 257 * argb[2] + (DiaVars->Background.green * alpha) / 255;
+    color.blue = 257 * argb[3] + (DiaVars->Background.blue * alpha) / 255;
+    ColorGetPixel(&color);
+
+    return color.pixel;
+}
+
 /**
 **	Draw image.
 **
 **	@param image	image to render
+**	@param drawable	drawable on which to place the image
 **	@param x	x-offset on drawable to render image
 **	@param y	y-offset on drawable to render image
 **	@param width	width of image to display
@@ -302,10 +421,10 @@ static void DiaScaledIconSize(const Icon * icon, unsigned max_width,
 **
 **	@see IconDraw
 **
-**	@todo use shared memory, cache image
+**	@todo use shared memory
 */
-static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
-    unsigned height)
+static void DiaDrawImage(const Image * image, xcb_drawable_t drawable, int x,
+    int y, unsigned width, unsigned height)
 {
     xcb_image_t *xcb_image;
     unsigned scale_x;
@@ -314,6 +433,7 @@ static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
     unsigned src_y;
     unsigned dst_x;
     unsigned dst_y;
+    unsigned rows_per_req;
     const uint8_t *argb;
 
     // create a temporary xcb_image for scaling
@@ -340,17 +460,10 @@ static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
 		src_x = 0;
 		for (dst_x = 0; dst_x < width; dst_x++) {
 		    int i;
-		    xcb_coloritem_t color;
 
 		    i = 4 * (n + (src_x / 65536));
-
-		    color.red = (65535 * (argb[i + 1]) / 255);
-		    color.green = (65535 * (argb[i + 2]) / 255);
-		    color.blue = (65535 * (argb[i + 3]) / 255);
-		    ColorGetPixel(&color);
-
 		    xcb_image_put_pixel_Z32L(xcb_image, dst_x, dst_y,
-			color.pixel);
+			DiaImagePixel(argb + i));
 
 		    src_x += scale_x;
 		}
@@ -365,17 +478,10 @@ static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
 		src_x = 0;
 		for (dst_x = 0; dst_x < width; dst_x++) {
 		    int i;
-		    xcb_coloritem_t color;
 
 		    i = 4 * (n + (src_x / 65536));
-
-		    color.red = (65535 * (argb[i + 1]) / 255);
-		    color.green = (65535 * (argb[i + 2]) / 255);
-		    color.blue = (65535 * (argb[i + 3]) / 255);
-		    ColorGetPixel(&color);
-
 		    xcb_image_put_pixel_Z32M(xcb_image, dst_x, dst_y,
-			color.pixel);
+			DiaImagePixel(argb + i));
 
 		    src_x += scale_x;
 		}
@@ -392,27 +498,23 @@ static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
 	    src_x = 0;
 	    for (dst_x = 0; dst_x < width; dst_x++) {
 		int i;
-		xcb_coloritem_t color;
+		uint32_t pixel;
 		uint8_t *row;
 
 		i = 4 * (n + (src_x / 65536));
-
-		color.red = (65535 * (argb[i + 1]) / 255);
-		color.green = (65535 * (argb[i + 2]) / 255);
-		color.blue = (65535 * (argb[i + 3]) / 255);
-		ColorGetPixel(&color);
+		pixel = DiaImagePixel(argb + i);
 
 		row = xcb_image->data + (dst_y * xcb_image->stride);
 		switch (xcb_image->byte_order) {
 		    case XCB_IMAGE_ORDER_LSB_FIRST:
-			row[dst_x * 3] = color.pixel;
-			row[dst_x * 3 + 1] = color.pixel >> 8;
-			row[dst_x * 3 + 2] = color.pixel >> 16;
+			row[dst_x * 3] = pixel;
+			row[dst_x * 3 + 1] = pixel >> 8;
+			row[dst_x * 3 + 2] = pixel >> 16;
 			break;
 		    case XCB_IMAGE_ORDER_MSB_FIRST:
-			row[dst_x * 3] = color.pixel >> 16;
-			row[dst_x * 3 + 1] = color.pixel >> 8;
-			row[dst_x * 3 + 2] = color.pixel;
+			row[dst_x * 3] = pixel >> 16;
+			row[dst_x * 3 + 1] = pixel >> 8;
+			row[dst_x * 3 + 2] = pixel;
 			break;
 		}
 
@@ -429,16 +531,10 @@ static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
 	    src_x = 0;
 	    for (dst_x = 0; dst_x < width; dst_x++) {
 		int i;
-		xcb_coloritem_t color;
 
 		i = 4 * (n + (src_x / 65536));
-
-		color.red = (65535 * (argb[i + 1]) / 255);
-		color.green = (65535 * (argb[i + 2]) / 255);
-		color.blue = (65535 * (argb[i + 3]) / 255);
-		ColorGetPixel(&color);
-
-		xcb_image_put_pixel(xcb_image, dst_x, dst_y, color.pixel);
+		xcb_image_put_pixel(xcb_image, dst_x, dst_y,
+		    DiaImagePixel(argb + i));
 
 		src_x += scale_x;
 	    }
@@ -447,8 +543,26 @@ static void DiaDrawImage(const Image * image, int x, int y, unsigned width,
 	}
     }
 
-    // render xcb_image to window
-    xcb_image_put(Connection, DiaVars->Working, RootGC, xcb_image, x, y, 0);
+    // render xcb_image to drawable, must split into request size slices
+    rows_per_req = xcb_get_maximum_request_length(Connection) * 4
+	- sizeof(xcb_put_image_request_t);
+    rows_per_req /= xcb_image->stride;
+    if (rows_per_req >= height) {
+	xcb_image_put(Connection, drawable, RootGC, xcb_image, x, y, 0);
+    } else if (rows_per_req) {
+	for (dst_y = 0; dst_y < height; dst_y += rows_per_req) {
+	    xcb_image_t *subimage;
+
+	    subimage =
+		xcb_image_subimage(xcb_image, 0, dst_y, width,
+		MIN(rows_per_req, height - dst_y), NULL, 0, NULL);
+	    xcb_image_put(Connection, drawable, RootGC, subimage, x,
+		y + dst_y, 0);
+	    xcb_image_destroy(subimage);
+	}
+    } else {
+	Debug(1, "dia image %dx%d too big\n", width, height);
+    }
     // release xcb_image
     xcb_image_destroy(xcb_image);
 }
@@ -468,74 +582,946 @@ void DiaDrawIcon(Icon * icon, int x, int y, unsigned width, unsigned height)
     IconDraw(icon, DiaVars->Working, x, y, width, height);
 }
 
+// ------------------------------------------------------------------------ //
+// Cache
+
+/**
+**	Get the scaled size of an image, which keeps its aspect ratio.
+**
+**	@param image		image to scale
+**	@param width		maximal width
+**	@param height		maximal height
+**	@param[out] pw		scaled width of image
+**	@param[out] ph		scaled height of image
+*/
+static void DiaScaledImageSize(const Image * image, unsigned width,
+    unsigned height, unsigned *pw, unsigned *ph)
+{
+    int i;
+    unsigned w;
+    unsigned h;
+
+    // keep image aspect ratio
+    i = (image->Width * 65536) / image->Height;
+    w = MIN(width * 65536, height * i);
+    h = MIN(height, w / i);
+    w = (h * i) / 65536;
+    if (w < 1) {
+	w = 1;
+    }
+    if (h < 1) {
+	h = 1;
+    }
+    *pw = w;
+    *ph = h;
+}
+
+/**
+**	Drop a cache entry.
+**
+**	@param cache	cache entry to free
+*/
+static void DiaCacheDrop(DiaCache * cache)
+{
+    free(cache->Name);
+    ImageDel(cache->Image);
+    if (cache->Pixmap) {
+	xcb_free_pixmap(Connection, cache->Pixmap);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+/**
+**	Flush the image cache.
+*/
+static void DiaCacheFlush(void)
+{
+    int i;
+
+    for (i = 0; i < DIA_CACHE_SIZE; ++i) {
+	if (DiaVars->Cache[i].Name) {
+	    DiaCacheDrop(&DiaVars->Cache[i]);
+	}
+    }
+}
+
+/**
+**	Shrink image cache to its memory limit.
+**
+**	Least recently used entries are dropped first.
+**
+**	@param keep	cache entry, which must be kept
+*/
+static void DiaCacheShrink(const DiaCache * keep)
+{
+    for (;;) {
+	DiaCache *lru;
+	size_t memory;
+	int i;
+
+	lru = NULL;
+	memory = 0;
+	for (i = 0; i < DIA_CACHE_SIZE; ++i) {
+	    DiaCache *cache;
+
+	    cache = &DiaVars->Cache[i];
+	    if (!cache->Name) {
+		continue;
+	    }
+	    memory += cache->PixmapWidth * cache->PixmapHeight * 4;
+	    if (cache->Image) {
+		memory += cache->Image->Width * cache->Image->Height * 4;
+	    }
+	    if (cache != keep && (!lru || cache->Used < lru->Used)) {
+		lru = cache;
+	    }
+	}
+	if (memory <= DIA_CACHE_MEMORY || !lru) {
+	    break;
+	}
+	Debug(3, "dia: cache drop '%s'\n", lru->Name);
+	DiaCacheDrop(lru);
+    }
+}
+
+/**
+**	Find image in cache.
+**
+**	@param name		file name of image in current directory
+**	@param mtime		modification time of image file
+**	@param width		maximal width of image
+**	@param height		maximal height of image
+**	@param thumbnail	true fast scaled thumbnail
+**	@param[out] donor	entry with decoded image of other size
+**
+**	@returns cache entry, NULL if image isn't cached.
+*/
+static DiaCache *DiaCacheLookup(const char *name, time_t mtime,
+    unsigned width, unsigned height, int thumbnail, DiaCache ** donor)
+{
+    int i;
+
+    for (i = 0; i < DIA_CACHE_SIZE; ++i) {
+	DiaCache *cache;
+
+	cache = &DiaVars->Cache[i];
+	if (!cache->Name || strcmp(cache->Name, name)) {
+	    continue;
+	}
+	if (cache->MTime != mtime) {	// file changed
+	    DiaCacheDrop(cache);
+	    continue;
+	}
+	if (cache->Thumbnail == thumbnail) {
+	    if (cache->Width == width && cache->Height == height) {
+		cache->Used = ++DiaVars->CacheUsed;
+		return cache;
+	    }
+	    // can be scaled again, without upscaling a reduced image
+	    if (donor && cache->Image && (cache->Image->Width >= width
+		    || cache->Image->Height >= height)) {
+		*donor = cache;
+	    }
+	}
+    }
+    return NULL;
+}
+
+/**
+**	Create a new cache entry.
+**
+**	Free entries are used first, otherwise the least recently used
+**	entry is dropped.
+**
+**	@param name		file name of image in current directory
+**	@param mtime		modification time of image file
+**	@param width		maximal width of image
+**	@param height		maximal height of image
+**	@param thumbnail	true fast scaled thumbnail
+**
+**	@returns new empty cache entry.
+*/
+static DiaCache *DiaCacheNew(const char *name, time_t mtime, unsigned width,
+    unsigned height, int thumbnail)
+{
+    DiaCache *victim;
+    int i;
+
+    victim = DiaVars->Cache;
+    for (i = 0; i < DIA_CACHE_SIZE && victim->Name; ++i) {
+	DiaCache *cache;
+
+	cache = &DiaVars->Cache[i];
+	if (!cache->Name || cache->Used < victim->Used) {
+	    victim = cache;
+	}
+    }
+    if (victim->Name) {
+	DiaCacheDrop(victim);
+    }
+
+    victim->Name = strdup(name);
+    victim->MTime = mtime;
+    victim->Width = width;
+    victim->Height = height;
+    victim->Thumbnail = thumbnail;
+    victim->Used = ++DiaVars->CacheUsed;
+
+    return victim;
+}
+
+/**
+**	Set image of a cache entry.
+**
+**	The scaled image is uploaded to the server and freed.
+**
+**	@param cache	cache entry
+**	@param image	decoded image (freed or kept in cache) or NULL
+**	@param scaled	image scaled to fit into requested size (freed)
+*/
+static void DiaCacheSetImage(DiaCache * cache, Image * image, Image * scaled)
+{
+    cache->PixmapWidth = scaled->Width;
+    cache->PixmapHeight = scaled->Height;
+    cache->Pixmap = xcb_generate_id(Connection);
+    xcb_create_pixmap(Connection, XcbScreen->root_depth, cache->Pixmap,
+	XcbScreen->root, scaled->Width, scaled->Height);
+    DiaDrawImage(scaled, cache->Pixmap, 0, 0, scaled->Width, scaled->Height);
+    ImageDel(scaled);
+
+    // keep only decoded images, which didn't flood the cache
+    if (image && image->Width * image->Height * 4 <= DIA_CACHE_MEMORY / 4) {
+	cache->Image = image;
+    } else {
+	ImageDel(image);
+    }
+    DiaCacheShrink(cache);
+}
+
+// ------------------------------------------------------------------------ //
+// Thumbnail store
+
+/**
+**	Stored thumbnail file, used to prune the thumbnail store.
+*/
+typedef struct _dia_thumbnail_file_
+{
+    char *Name;				///< file name in thumbnail store
+    time_t Used;			///< last access of file
+    off_t Size;				///< disk usage of file
+} DiaThumbnailFile;
+
+/**
+**	Compare stored thumbnail files by last access, oldest first.
+**
+**	@param a	first stored thumbnail file
+**	@param b	second stored thumbnail file
+**
+**	@returns <0, 0, >0 like strcmp.
+*/
+static int DiaThumbnailCompare(const void *a, const void *b)
+{
+    const DiaThumbnailFile *file_a;
+    const DiaThumbnailFile *file_b;
+
+    file_a = a;
+    file_b = b;
+    return (file_a->Used > file_b->Used) - (file_a->Used < file_b->Used);
+}
+
+/**
+**	Prune the on-disk thumbnail store.
+**
+**	Thumbnails not used for #DIA_THUMBNAIL_STORE_AGE are removed, then
+**	the least recently used thumbnails are removed, until the store
+**	fits into #DIA_THUMBNAIL_STORE_SIZE.  With noatime mounts the
+**	modification time is used.
+**
+**	@param dir	thumbnail store directory
+*/
+static void DiaThumbnailPrune(const char *dir)
+{
+    DIR *dirp;
+    const struct dirent *dirent;
+    DiaThumbnailFile *files;
+    int n;
+    int max;
+    int i;
+    off_t total;
+    time_t now;
+
+    if (!(dirp = opendir(dir))) {
+	return;
+    }
+    now = time(NULL);
+    files = NULL;
+    n = 0;
+    max = 0;
+    total = 0;
+    while ((dirent = readdir(dirp))) {
+	struct stat st;
+
+	if (dirent->d_name[0] == '.'
+	    || fstatat(dirfd(dirp), dirent->d_name, &st, AT_SYMLINK_NOFOLLOW)
+	    || !S_ISREG(st.st_mode)) {
+	    continue;
+	}
+	if (n == max) {
+	    max = max ? max * 2 : 256;
+	    files = realloc(files, max * sizeof(*files));
+	}
+	files[n].Used = MAX(st.st_atime, st.st_mtime);
+	files[n].Size = st.st_blocks * 512;
+	// unused too long, remove now
+	if (files[n].Used + DIA_THUMBNAIL_STORE_AGE < now) {
+	    unlinkat(dirfd(dirp), dirent->d_name, 0);
+	    continue;
+	}
+	files[n].Name = strdup(dirent->d_name);
+	total += files[n].Size;
+	++n;
+    }
+
+    if (total > DIA_THUMBNAIL_STORE_SIZE) {
+	qsort(files, n, sizeof(*files), DiaThumbnailCompare);
+	for (i = 0; i < n && total > DIA_THUMBNAIL_STORE_SIZE; ++i) {
+	    if (!unlinkat(dirfd(dirp), files[i].Name, 0)) {
+		total -= files[i].Size;
+	    }
+	}
+	Debug(2, "dia: thumbnail store pruned to %jd bytes\n",
+	    (intmax_t) total);
+    }
+    for (i = 0; i < n; ++i) {
+	free(files[i].Name);
+    }
+    free(files);
+    closedir(dirp);
+}
+
+/**
+**	Initialize the on-disk thumbnail store.
+**
+**	Thumbnails are stored in $XDG_CACHE_HOME/uwm/thumbnails or
+**	~/.cache/uwm/thumbnails.  The store is pruned, when initialized.
+*/
+static void DiaThumbnailInit(void)
+{
+    const char *cache_home;
+    char *dir;
+    char *s;
+
+    if (DiaVars->ThumbnailDir) {	// already initialized
+	return;
+    }
+    if (!(cache_home = getenv("XDG_CACHE_HOME"))) {
+	cache_home = "~/.cache";
+    }
+    s = ExpandPath(cache_home);
+    dir = malloc(strlen(s) + sizeof("/uwm/thumbnails"));
+    stpcpy(stpcpy(dir, s), "/uwm/thumbnails");
+    free(s);
+
+    // create all missing parent directories
+    for (s = dir + 1; (s = strchr(s, '/')); ++s) {
+	*s = '\0';
+	mkdir(dir, 0700);
+	*s = '/';
+    }
+    if (mkdir(dir, 0700) && errno != EEXIST) {
+	Warning("dia: can't create thumbnail directory '%s': %s\n", dir,
+	    strerror(errno));
+	free(dir);
+	return;
+    }
+    DiaThumbnailPrune(dir);
+    DiaVars->ThumbnailDir = dir;
+}
+
+/**
+**	Get file name of stored thumbnail.
+**
+**	The file name is a FNV-1a hash of the image file name and the
+**	requested size.  Hash collisions are detected by the stored
+**	source file name.
+**
+**	@param file	full file name of image
+**	@param width	maximal width of thumbnail
+**	@param height	maximal height of thumbnail
+**
+**	@returns malloced file name, NULL if there is no thumbnail store.
+*/
+static char *DiaThumbnailName(const char *file, unsigned width,
+    unsigned height)
+{
+    uint64_t hash;
+    const char *s;
+    char *name;
+
+    if (!DiaVars->ThumbnailDir) {
+	return NULL;
+    }
+    hash = 0xCBF29CE484222325ULL;
+    for (s = file; *s; ++s) {
+	hash = (hash ^ (uint8_t) * s) * 0x100000001B3ULL;
+    }
+    name = malloc(strlen(DiaVars->ThumbnailDir) + 40);
+    sprintf(name, "%s/%016" PRIx64 "-%ux%u", DiaVars->ThumbnailDir, hash,
+	width, height);
+
+    return name;
+}
+
+/**
+**	Load stored thumbnail.
+**
+**	Only a header and the raw image data is read, no image decoding
+**	is needed.
+**
+**	@param file	full file name of image
+**	@param mtime	modification time of image file
+**	@param width	maximal width of thumbnail
+**	@param height	maximal height of thumbnail
+**
+**	@returns thumbnail image, NULL if not stored or outdated.
+*/
+static Image *DiaThumbnailLoad(const char *file, time_t mtime,
+    unsigned width, unsigned height)
+{
+    char *name;
+    int fd;
+    DiaThumbnailHeader header;
+    size_t length;
+    char *buf;
+    Image *image;
+
+    if (!(name = DiaThumbnailName(file, width, height))) {
+	return NULL;
+    }
+    fd = open(name, O_RDONLY | O_CLOEXEC);
+    free(name);
+    if (fd < 0) {
+	return NULL;
+    }
+
+    image = NULL;
+    length = strlen(file);
+    if (read(fd, &header, sizeof(header)) != sizeof(header)
+	|| header.Magic != DIA_THUMBNAIL_MAGIC || header.MTime != mtime
+	|| header.PathLength != length || header.Width > width
+	|| header.Height > height || !header.Width || !header.Height) {
+	goto out;
+    }
+    buf = alloca(length);
+    if (read(fd, buf, length) != (ssize_t) length
+	|| memcmp(buf, file, length)) {
+	goto out;
+    }
+    if ((image = ImageNew(header.Width, header.Height))) {
+	length = header.Width * header.Height * 4;
+	if (read(fd, image->Data, length) != (ssize_t) length) {
+	    ImageDel(image);
+	    image = NULL;
+	}
+    }
+
+  out:
+    close(fd);
+    return image;
+}
+
+/**
+**	Store thumbnail.
+**
+**	Written to a temporary file and renamed, concurrent readers see
+**	only complete thumbnails.
+**
+**	@param file	full file name of image
+**	@param mtime	modification time of image file
+**	@param width	maximal width of thumbnail
+**	@param height	maximal height of thumbnail
+**	@param image	thumbnail image
+*/
+static void DiaThumbnailSave(const char *file, time_t mtime, unsigned width,
+    unsigned height, const Image * image)
+{
+    char *name;
+    char *temp;
+    int fd;
+    DiaThumbnailHeader header;
+    struct iovec iov[3];
+    ssize_t length;
+
+    if (!(name = DiaThumbnailName(file, width, height))) {
+	return;
+    }
+    temp = alloca(strlen(name) + sizeof(".XXXXXX"));
+    stpcpy(stpcpy(temp, name), ".XXXXXX");
+    if ((fd = mkstemp(temp)) < 0) {
+	free(name);
+	return;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.Magic = DIA_THUMBNAIL_MAGIC;
+    header.PathLength = strlen(file);
+    header.MTime = mtime;
+    header.Width = image->Width;
+    header.Height = image->Height;
+
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void *)file;
+    iov[1].iov_len = header.PathLength;
+    iov[2].iov_base = (void *)image->Data;
+    iov[2].iov_len = image->Width * image->Height * 4;
+    length = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+
+    if (writev(fd, iov, 3) != length || close(fd) || rename(temp, name)) {
+	Debug(2, "dia: can't store thumbnail of '%s'\n", file);
+	unlink(temp);
+    }
+    free(name);
+}
+
+// ------------------------------------------------------------------------ //
+// Decoder
+
+/**
+**	Decode an image.
+**
+**	Thumbnails are loaded from the thumbnail store, if possible and
+**	stored after decoding.  Decoder threads can only decode JPEG and
+**	PNG images, other formats (XPM) need the X connection and fail.
+**
+**	@param file		full file name of image
+**	@param mtime		modification time of image file
+**	@param width		maximal width of image
+**	@param height		maximal height of image
+**	@param thumbnail	true fast scaled thumbnail
+**	@param threaded		true called from decoder thread
+**	@param[out] scaled	image scaled to fit into requested size
+**
+**	@returns decoded image, NULL if loaded from store or failure.
+*/
+static Image *DiaDecodeImage(const char *file, time_t mtime, unsigned width,
+    unsigned height, int thumbnail, int threaded, Image ** scaled)
+{
+    Image *image;
+    unsigned w;
+    unsigned h;
+
+    if (thumbnail
+	&& (*scaled = DiaThumbnailLoad(file, mtime, width, height))) {
+	return NULL;
+    }
+    *scaled = NULL;
+    if ((image = threaded ? ImageLoadRasterSized(file, width, height)
+	    : ImageLoadFileSized(file, width, height))) {
+	DiaScaledImageSize(image, width, height, &w, &h);
+	if (!(*scaled = ImageScale(image, w, h))) {
+	    ImageDel(image);
+	    return NULL;
+	}
+	if (thumbnail) {
+	    DiaThumbnailSave(file, mtime, width, height, *scaled);
+	}
+    }
+    return image;
+}
+
+/**
+**	Decode an image job.
+**
+**	Runs in a decoder thread, only the job is used.
+**
+**	@param job	decode job
+*/
+static void DiaDecodeJob(DiaJob * job)
+{
+    job->Image =
+	DiaDecodeImage(job->File, job->MTime, job->Width, job->Height,
+	job->Thumbnail, 1, &job->Scaled);
+}
+
+/**
+**	Decoder thread.
+**
+**	Takes queued jobs, decodes them and signals the main thread with
+**	the eventfd.
+**
+**	@param arg	unused
+**
+**	@returns NULL.
+*/
+static void *DiaDecoderThread(void __attribute__((unused)) * arg)
+{
+    DiaJob *job;
+    uint64_t value;
+
+    pthread_mutex_lock(&DiaDecoder->Mutex);
+    while (!DiaDecoder->Quit) {
+	TAILQ_FOREACH(job, &DiaDecoder->Jobs, Next) {
+	    if (job->State == DIA_JOB_QUEUED) {
+		break;
+	    }
+	}
+	if (!job) {
+	    pthread_cond_wait(&DiaDecoder->Cond, &DiaDecoder->Mutex);
+	    continue;
+	}
+	job->State = DIA_JOB_RUNNING;
+	pthread_mutex_unlock(&DiaDecoder->Mutex);
+
+	DiaDecodeJob(job);
+
+	pthread_mutex_lock(&DiaDecoder->Mutex);
+	job->State = DIA_JOB_DONE;
+	value = 1;
+	if (write(DiaDecoder->EventFd, &value, sizeof(value)) < 0) {
+	    Debug(2, "dia: can't signal decoded image\n");
+	}
+    }
+    pthread_mutex_unlock(&DiaDecoder->Mutex);
+
+    return NULL;
+}
+
+/**
+**	Free a decode job.
+**
+**	@param job	decode job
+*/
+static void DiaJobDel(DiaJob * job)
+{
+    free(job->Name);
+    free(job->File);
+    ImageDel(job->Image);
+    ImageDel(job->Scaled);
+    free(job);
+}
+
+/**
+**	Start the decoder threads.
+*/
+static void DiaDecoderStart(void)
+{
+    int i;
+
+    if (DiaDecoder->Started) {
+	return;
+    }
+    if ((DiaDecoder->EventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+	Error("dia: can't create eventfd: %s\n", strerror(errno));
+	return;
+    }
+    pthread_mutex_init(&DiaDecoder->Mutex, NULL);
+    pthread_cond_init(&DiaDecoder->Cond, NULL);
+    TAILQ_INIT(&DiaDecoder->Jobs);
+    DiaDecoder->Quit = 0;
+
+    for (i = 0; i < DIA_DECODE_THREADS; ++i) {
+	if (pthread_create(&DiaDecoder->Threads[i], NULL, DiaDecoderThread,
+		NULL)) {
+	    Error("dia: can't create decoder thread\n");
+	    break;
+	}
+    }
+    DiaDecoder->Started = i;
+    if (!i) {
+	close(DiaDecoder->EventFd);
+	DiaDecoder->EventFd = -1;
+    }
+}
+
+/**
+**	Cancel all queued decode jobs.
+**
+**	Running jobs are finished, but their results are dropped.
+*/
+static void DiaDecoderCancel(void)
+{
+    DiaJob *job;
+    DiaJob *temp;
+
+    if (!DiaDecoder->Started) {
+	return;
+    }
+    pthread_mutex_lock(&DiaDecoder->Mutex);
+    ++DiaDecoder->Serial;
+    TAILQ_FOREACH_SAFE(job, &DiaDecoder->Jobs, Next, temp) {
+	if (job->State == DIA_JOB_QUEUED) {
+	    TAILQ_REMOVE(&DiaDecoder->Jobs, job, Next);
+	    DiaJobDel(job);
+	}
+    }
+    pthread_mutex_unlock(&DiaDecoder->Mutex);
+}
+
+/**
+**	Queue a decode job.
+**
+**	Visible images are queued in request order before prefetched
+**	images.  Must be called with decoder mutex locked.
+**
+**	@param job	decode job
+*/
+static void DiaDecoderQueue(DiaJob * job)
+{
+    DiaJob *prefetch;
+
+    if (!job->Prefetch) {
+	TAILQ_FOREACH(prefetch, &DiaDecoder->Jobs, Next) {
+	    if (prefetch->Prefetch && prefetch->State == DIA_JOB_QUEUED) {
+		TAILQ_INSERT_BEFORE(prefetch, job, Next);
+		return;
+	    }
+	}
+    }
+    TAILQ_INSERT_TAIL(&DiaDecoder->Jobs, job, Next);
+}
+
+/**
+**	Drop all queued decode jobs.
+**
+**	Used when the visible images change, the new images are requested
+**	again.  Running jobs are finished and cached.
+*/
+static void DiaDecoderDrop(void)
+{
+    DiaJob *job;
+    DiaJob *temp;
+
+    if (!DiaDecoder->Started) {
+	return;
+    }
+    pthread_mutex_lock(&DiaDecoder->Mutex);
+    TAILQ_FOREACH_SAFE(job, &DiaDecoder->Jobs, Next, temp) {
+	if (job->State == DIA_JOB_QUEUED) {
+	    TAILQ_REMOVE(&DiaDecoder->Jobs, job, Next);
+	    DiaJobDel(job);
+	}
+    }
+    pthread_mutex_unlock(&DiaDecoder->Mutex);
+}
+
+/**
+**	Request decoding of an image.
+**
+**	@param name		file name of image in current directory
+**	@param file		full file name of image
+**	@param mtime		modification time of image file
+**	@param width		maximal width of image
+**	@param height		maximal height of image
+**	@param thumbnail	true fast scaled thumbnail
+**	@param prefetch		true image isn't visible yet
+**
+**	@returns false if no decoder is available.
+*/
+static int DiaDecoderRequest(const char *name, const char *file,
+    time_t mtime, unsigned width, unsigned height, int thumbnail,
+    int prefetch)
+{
+    DiaJob *job;
+
+    if (!DiaDecoder->Started) {
+	return 0;
+    }
+    pthread_mutex_lock(&DiaDecoder->Mutex);
+    TAILQ_FOREACH(job, &DiaDecoder->Jobs, Next) {
+	if (job->Width == width && job->Height == height
+	    && job->Thumbnail == thumbnail && job->MTime == mtime
+	    && job->Serial == DiaDecoder->Serial && !strcmp(job->Name, name)) {
+	    break;
+	}
+    }
+    if (job) {				// already requested
+	if (!prefetch && job->Prefetch) {
+	    job->Prefetch = 0;
+	    if (job->State == DIA_JOB_QUEUED) {
+		TAILQ_REMOVE(&DiaDecoder->Jobs, job, Next);
+		DiaDecoderQueue(job);
+	    }
+	}
+    } else {
+	job = calloc(1, sizeof(*job));
+	job->Name = strdup(name);
+	job->File = strdup(file);
+	job->MTime = mtime;
+	job->Width = width;
+	job->Height = height;
+	job->Thumbnail = thumbnail;
+	job->Prefetch = prefetch;
+	job->Serial = DiaDecoder->Serial;
+	DiaDecoderQueue(job);
+	pthread_cond_signal(&DiaDecoder->Cond);
+    }
+    pthread_mutex_unlock(&DiaDecoder->Mutex);
+
+    return 1;
+}
+
+// ------------------------------------------------------------------------ //
+
+/**
+**	Get image from cache.
+**
+**	Images are cached decoded and scaled as server pixmap, keyed by
+**	file name, modification time and requested size.  A decoded image
+**	is also kept, to scale it again without decoding.  Images not in
+**	cache are decoded in the background.
+**
+**	@param name		file name of image in current directory
+**	@param width		maximal width of image
+**	@param height		maximal height of image
+**	@param thumbnail	true load fast scaled thumbnail
+**	@param prefetch		true only prefetch image
+**
+**	@returns cache entry, NULL if image isn't available yet.
+*/
+static const DiaCache *DiaCacheGet(const char *name, unsigned width,
+    unsigned height, int thumbnail, int prefetch)
+{
+    char *buf;
+    struct stat st;
+    DiaCache *cache;
+    DiaCache *donor;
+    Image *image;
+    Image *scaled;
+
+    buf = alloca(strlen(name) + strlen(DiaVars->Path) + 2);
+    stpcpy(stpcpy(stpcpy(buf, DiaVars->Path), "/"), name);
+    if (stat(buf, &st)) {
+	return NULL;
+    }
+
+    donor = NULL;
+    if ((cache =
+	    DiaCacheLookup(name, st.st_mtime, width, height, thumbnail,
+		&donor))) {
+	return cache;
+    }
+
+    if (donor) {			// take over decoded image
+	image = donor->Image;
+	donor->Image = NULL;
+    } else {
+	if (DiaDecoderRequest(name, buf, st.st_mtime, width, height,
+		thumbnail, prefetch) || prefetch) {
+	    return NULL;
+	}
+	// no decoder threads, decode self
+	image =
+	    DiaDecodeImage(buf, st.st_mtime, width, height, thumbnail, 0,
+	    &scaled);
+	cache = DiaCacheNew(name, st.st_mtime, width, height, thumbnail);
+	if (scaled) {
+	    DiaCacheSetImage(cache, image, scaled);
+	}
+	return cache;
+    }
+    cache = DiaCacheNew(name, st.st_mtime, width, height, thumbnail);
+    if (image) {
+	unsigned w;
+	unsigned h;
+
+	DiaScaledImageSize(image, width, height, &w, &h);
+	if ((scaled = ImageScale(image, w, h))) {
+	    DiaCacheSetImage(cache, image, scaled);
+	} else {
+	    ImageDel(image);
+	}
+    }
+    return cache;
+}
+
+/**
+**	Draw cached image centered in an area.
+**
+**	@param cache	cache entry of image
+**	@param drawable	draw image on this drawable
+**	@param x	x-offset of area on drawable
+**	@param y	y-offset of area on drawable
+**	@param width	width of area
+**	@param height	height of area
+*/
+static void DiaCacheDraw(const DiaCache * cache, xcb_drawable_t drawable,
+    int x, int y, unsigned width, unsigned height)
+{
+    if (!cache->Pixmap) {		// image can't be loaded
+	return;
+    }
+    xcb_copy_area(Connection, cache->Pixmap, drawable, RootGC, 0, 0,
+	x + (width - cache->PixmapWidth) / 2,
+	y + (height - cache->PixmapHeight) / 2, cache->PixmapWidth,
+	cache->PixmapHeight);
+}
+
 /**
 **	Show image.
 **
+**	Nothing is drawn, while the image is decoded.
+**
 **	@param name	file name of image to draw
 **	@param x	x-offset on drawable to render image
 **	@param y	y-offset on drawable to render image
 **	@param width	width of image to display
 **	@param height	height of image to display
-**
-**	@todo cache images, can use icon cache
 */
 void DiaShowImage(const char *name, int x, int y, unsigned width,
     unsigned height)
 {
-    Icon *icon;
+    const DiaCache *cache;
 
-    // load icon
-    if (!(icon = IconLoadSuffixed(DiaVars->Path, name, ""))) {
-	Warning("dia image not found: \"%s\"", name);
-	return;
+    if ((cache = DiaCacheGet(name, width, height, 0, 0))) {
+	DiaCacheDraw(cache, DiaVars->Working, x, y, width, height);
     }
-    DiaDrawIcon(icon, x, y, width, height);
+}
+
+/**
+**	Draw placeholder for a thumbnail, which is still decoded.
+**
+**	@param drawable	draw placeholder on this drawable
+**	@param x	x-offset of thumbnail on drawable
+**	@param y	y-offset of thumbnail on drawable
+**	@param width	width of thumbnail
+**	@param height	height of thumbnail
+*/
+static void DiaDrawPlaceholder(xcb_drawable_t drawable, int x, int y,
+    unsigned width, unsigned height)
+{
+    xcb_rectangle_t rectangle;
 
-    // we don't need icon anymore
-    IconDel(icon);
+    rectangle.x = x + width / 8;
+    rectangle.y = y + height / 8;
+    rectangle.width = (width * 3) / 4;
+    rectangle.height = (height * 3) / 4;
+    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	&Colors.PanelFG.Pixel);
+    xcb_poly_rectangle(Connection, drawable, RootGC, 1, &rectangle);
 }
 
 /**
 **	Show thumbnail.
 **
-**	Short cut for thumbnails
+**	Short cut for thumbnails.  A placeholder is drawn, while the
+**	thumbnail is decoded.
 **
 **	@param name	file name of thumnail to draw
 **	@param x	x-offset on drawable to thumnail image
 **	@param y	y-offset on drawable to thumnail image
 **	@param width	width of thumnail to display
 **	@param height	height of thumnail to display
-**
-**	@todo cache thumbnails
 */
 void DiaShowThumbnail(const char *name, int x, int y, unsigned width,
     unsigned height)
 {
-    Image *image;
-    char *buf;
-
-    buf = alloca(strlen(name) + strlen(DiaVars->Path) + 2);
-    stpcpy(stpcpy(stpcpy(buf, DiaVars->Path), "/"), name);
-    if ((image = ImageLoadJPEG0(buf, width, height))) {
-	int i;
-	unsigned w;
-	unsigned h;
+    const DiaCache *cache;
 
-	// keep image aspect ratio
-	i = (image->Width * 65536) / image->Height;
-	w = MIN(width * 65536, height * i);
-	h = MIN(height, w / i);
-	w = (h * i) / 65536;
-	if (w < 1) {
-	    w = 1;
-	}
-	if (h < 1) {
-	    h = 1;
-	}
-	DiaDrawImage(image, x + (width - w) / 2, y + (height - h) / 2, w, h);
-	ImageDel(image);
+    if ((cache = DiaCacheGet(name, width, height, 1, 0))) {
+	DiaCacheDraw(cache, DiaVars->Working, x, y, width, height);
     } else {
-	DiaShowImage(name, x, y, width, height);
+	DiaDrawPlaceholder(DiaVars->Working, x, y, width, height);
     }
 }
 
@@ -603,6 +1589,8 @@ static void DiaDrawSingle(void)
     int x;
     int y;
     const char *file;
+    size_t index;
+    size_t *value;
 
     x = 0;
     y = 0;
@@ -625,11 +1613,69 @@ static void DiaDrawSingle(void)
 	ox = DiaVars->OffsetX;
 	oy = DiaVars->OffsetY;
 	DiaShowImage(file, x + ox, y + oy, w, h);
+
+	// prefetch neighbours, with slide show wrap around
+	index = DiaVars->CurrentIndex;
+	if ((value = ArrayPrev(DiaVars->FilesInDir, &index))) {
+	    DiaCacheGet((const char *)*value, w, h, 0, 1);
+	}
+	index = DiaVars->CurrentIndex;
+	if ((value = ArrayNext(DiaVars->FilesInDir, &index))
+	    || (DiaVars->SlideShow
+		&& (value = ArrayFirst(DiaVars->FilesInDir, &index)))) {
+	    DiaCacheGet((const char *)*value, w, h, 0, 1);
+	}
+    }
+}
+
+/**
+**	Draw one tile of the index page.
+**
+**	@param drawable	draw tile on this drawable
+**	@param file	file name of image
+**	@param index	index of image in directory
+**	@param x	x-offset of tile on drawable
+**	@param y	y-offset of tile on drawable
+*/
+static void DiaDrawIndexTile(xcb_drawable_t drawable, const char *file,
+    size_t index, int x, int y)
+{
+    xcb_rectangle_t rectangle;
+    const DiaCache *cache;
+
+    // clear background, highlight current file
+    rectangle.x = x;
+    rectangle.y = y;
+    rectangle.width = DiaVars->IndexWidth;
+    rectangle.height = DiaVars->IndexHeight;
+    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	index == DiaVars->CurrentIndex ? &Colors.PanelFG.Pixel :
+	&Colors.PanelBG.Pixel);
+    xcb_poly_fill_rectangle(Connection, drawable, RootGC, 1, &rectangle);
+
+    if ((cache =
+	    DiaCacheGet(file, DiaVars->IndexWidth - 2,
+		DiaVars->IndexHeight - 2, 1, 0))) {
+	DiaCacheDraw(cache, drawable, x + 1, y + 1, DiaVars->IndexWidth - 2,
+	    DiaVars->IndexHeight - 2);
+    } else {
+	DiaDrawPlaceholder(drawable, x + 1, y + 1, DiaVars->IndexWidth - 2,
+	    DiaVars->IndexHeight - 2);
+    }
+
+    if (DiaVars->IndexLabel) {
+	FontDrawString(drawable, &Fonts.Panel, 0UL, x + 2, y + 2,
+	    DiaVars->IndexWidth - 3, NULL, file);
+	FontDrawString(drawable, &Fonts.Panel, Colors.PanelFG.Pixel, x + 1,
+	    y + 1, DiaVars->IndexWidth - 4, NULL, file);
     }
 }
 
 /**
 **	Draw index page.
+**
+**	Cached thumbnails are drawn at once, missing thumbnails are drawn
+**	as placeholder and updated by DiaRedrawIndexTile after decoding.
 */
 static void DiaDrawIndex(void)
 {
@@ -638,6 +1684,9 @@ static void DiaDrawIndex(void)
     size_t index;
     size_t *value;
 
+    // only the visible thumbnails are needed, cancel scrolled away
+    DiaDecoderDrop();
+
     index = DiaVars->FirstIndex;
     value = ArrayFirst(DiaVars->FilesInDir, &index);
     // center index
@@ -652,29 +1701,7 @@ static void DiaDrawIndex(void)
 		if (!file) {
 		    break;
 		}
-		// highlight current file
-		if (index == DiaVars->CurrentIndex) {
-		    xcb_rectangle_t rectangle;
-
-		    rectangle.x = x;
-		    rectangle.y = y;
-		    rectangle.width = DiaVars->IndexWidth;
-		    rectangle.height = DiaVars->IndexHeight;
-		    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
-			&Colors.PanelFG.Pixel);
-		    xcb_poly_fill_rectangle(Connection, DiaVars->Working,
-			RootGC, 1, &rectangle);
-		}
-		DiaShowThumbnail(file, x + 1, y + 1, DiaVars->IndexWidth - 2,
-		    DiaVars->IndexHeight - 2);
-
-		if (DiaVars->IndexLabel) {
-		    FontDrawString(DiaVars->Working, &Fonts.Panel, 0UL, x + 2,
-			y + 2, DiaVars->IndexWidth - 3, NULL, file);
-		    FontDrawString(DiaVars->Working, &Fonts.Panel,
-			Colors.PanelFG.Pixel, x + 1, y + 1,
-			DiaVars->IndexWidth - 4, NULL, file);
-		}
+		DiaDrawIndexTile(DiaVars->Working, file, index, x, y);
 
 		value = ArrayNext(DiaVars->FilesInDir, &index);
 	    }
@@ -684,6 +1711,52 @@ static void DiaDrawIndex(void)
     } while (y <= DiaVars->Height - DiaVars->IndexHeight);
 }
 
+/**
+**	Redraw a decoded thumbnail of the index page.
+**
+**	The tile is drawn on the displayed pixmap and only its area is
+**	exposed.
+**
+**	@param name	file name of decoded image
+*/
+static void DiaRedrawIndexTile(const char *name)
+{
+    int columns;
+    int rows;
+    int i;
+    size_t index;
+    size_t *value;
+
+    if (!(columns = DiaVars->Width / DiaVars->IndexWidth)) {
+	columns = 1;
+    }
+    if (!(rows = DiaVars->Height / DiaVars->IndexHeight)) {
+	rows = 1;
+    }
+
+    index = DiaVars->FirstIndex;
+    value = ArrayFirst(DiaVars->FilesInDir, &index);
+    for (i = 0; value && i < columns * rows; ++i) {
+	const char *file;
+
+	file = (const char *)*value;
+	if (!strcmp(file, name)) {
+	    int x;
+	    int y;
+
+	    x = (DiaVars->Width % DiaVars->IndexWidth) / 2 +
+		(i % columns) * DiaVars->IndexWidth;
+	    y = (DiaVars->Height % DiaVars->IndexHeight) / 2 +
+		(i / columns) * DiaVars->IndexHeight;
+	    DiaDrawIndexTile(DiaVars->Pixmap, file, index, x, y);
+	    xcb_clear_area(Connection, 0, DiaVars->Window, x, y,
+		DiaVars->IndexWidth, DiaVars->IndexHeight);
+	    return;
+	}
+	value = ArrayNext(DiaVars->FilesInDir, &index);
+    }
+}
+
 /**
 **	Draw dia.
 **
@@ -751,6 +1824,9 @@ static void DiaDestroy(void)
     free(DiaVars->Path);
     DiaVars->Path = NULL;
 
+    DiaDecoderCancel();
+    DiaCacheFlush();
+
     DiaDirDel(DiaVars->FilesInDir);
     DiaVars->FilesInDir = NULL;
 
@@ -778,6 +1854,7 @@ void DiaCreate(const char *name)
     int width;
     int height;
     Client *self;
+    char *path;
 
     if (DiaVars->Window) {		// already running
 	DiaDestroy();
@@ -785,11 +1862,23 @@ void DiaCreate(const char *name)
     }
 
     DiaVars->Path = ExpandPath(name);
+    // absolute path, thumbnails are stored by file name
+    if ((path = realpath(DiaVars->Path, NULL))) {
+	free(DiaVars->Path);
+	DiaVars->Path = path;
+    }
     DiaVars->FilesInDir = DiaDirNew(DiaVars->Path);
     DiaVars->CurrentIndex = DiaVars->FirstIndex = 0;
     DiaVars->NeedRedraw = 0;
     DiaVars->State = 0;
 
+    // images are blended with the background color
+    DiaVars->Background.pixel = Colors.PanelBG.Pixel;
+    ColorGetFromPixel(&DiaVars->Background);
+
+    DiaThumbnailInit();
+    DiaDecoderStart();
+
     if (DiaVars->Fullscreen) {		// fullscreen mode
 	x = 0;
 	y = 0;
@@ -1502,6 +2591,127 @@ void DiaTimeout(uint32_t tick, int __attribute__((unused)) x, int
     }
 }
 
+/**
+**	Get file descriptor signaling decoded images.
+**
+**	@returns eventfd of background decoder, -1 if not running.
+*/
+int DiaDecodeFd(void)
+{
+    return DiaDecoder->EventFd;
+}
+
+/**
+**	Handle decoded images.
+**
+**	Called from event loop, when the decoder eventfd is readable.
+**	Finished jobs are moved into the image cache and the window is
+**	redrawn, if a visible image was decoded.
+*/
+void DiaDecodeHandle(void)
+{
+    uint64_t value;
+    DiaJob *job;
+    DiaJob *temp;
+    struct _dia_job_head_ done;
+    unsigned serial;
+    int redraw;
+
+    if (read(DiaDecoder->EventFd, &value, sizeof(value)) < 0) {
+	return;
+    }
+
+    TAILQ_INIT(&done);
+    pthread_mutex_lock(&DiaDecoder->Mutex);
+    TAILQ_FOREACH_SAFE(job, &DiaDecoder->Jobs, Next, temp) {
+	if (job->State == DIA_JOB_DONE) {
+	    TAILQ_REMOVE(&DiaDecoder->Jobs, job, Next);
+	    TAILQ_INSERT_TAIL(&done, job, Next);
+	}
+    }
+    serial = DiaDecoder->Serial;
+    pthread_mutex_unlock(&DiaDecoder->Mutex);
+
+    redraw = 0;
+    TAILQ_FOREACH_SAFE(job, &done, Next, temp) {
+	// dia-show closed or reopened, while decoding
+	if (job->Serial == serial && DiaVars->Window
+	    && !DiaCacheLookup(job->Name, job->MTime, job->Width,
+		job->Height, job->Thumbnail, NULL)) {
+	    DiaCache *cache;
+
+	    // failures (also not JPEG/PNG) are cached without image
+	    cache =
+		DiaCacheNew(job->Name, job->MTime, job->Width, job->Height,
+		job->Thumbnail);
+	    if (job->Scaled) {
+		DiaCacheSetImage(cache, job->Image, job->Scaled);
+		job->Image = NULL;
+		job->Scaled = NULL;
+	    } else {
+		Warning("dia: can't load image '%s'\n", job->File);
+	    }
+	    if (!job->Prefetch) {
+		// index page: update only the decoded tile
+		if (DiaVars->Layout == DIA_LAYOUT_INDEX && job->Thumbnail
+		    && !DiaVars->NeedRedraw) {
+		    DiaRedrawIndexTile(job->Name);
+		} else {
+		    redraw = 1;
+		}
+	    }
+	}
+	DiaJobDel(job);
+    }
+
+    if (redraw) {
+	DiaDrawWindow(0);
+    }
+}
+
+/**
+**	Stop the decoder threads.
+*/
+static void DiaDecoderStop(void)
+{
+    DiaJob *job;
+    int i;
+
+    if (!DiaDecoder->Started) {
+	return;
+    }
+    pthread_mutex_lock(&DiaDecoder->Mutex);
+    DiaDecoder->Quit = 1;
+    pthread_cond_broadcast(&DiaDecoder->Cond);
+    pthread_mutex_unlock(&DiaDecoder->Mutex);
+
+    for (i = 0; i < DiaDecoder->Started; ++i) {
+	pthread_join(DiaDecoder->Threads[i], NULL);
+    }
+    DiaDecoder->Started = 0;
+
+    while ((job = TAILQ_FIRST(&DiaDecoder->Jobs))) {
+	TAILQ_REMOVE(&DiaDecoder->Jobs, job, Next);
+	DiaJobDel(job);
+    }
+    pthread_cond_destroy(&DiaDecoder->Cond);
+    pthread_mutex_destroy(&DiaDecoder->Mutex);
+
+    close(DiaDecoder->EventFd);
+    DiaDecoder->EventFd = -1;
+}
+
+/**
+**	Cleanup dia-show module.
+*/
+void DiaExit(void)
+{
+    DiaDecoderStop();
+
+    free(DiaVars->ThumbnailDir);
+    DiaVars->ThumbnailDir = NULL;
+}
+
 #ifdef USE_RC				// {
 
 /**
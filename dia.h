@@ -45,10 +45,16 @@ extern int DiaHandleMotionNotify(const xcb_motion_notify_event_t *);
     /// Timeout for dia-show.
 extern void DiaTimeout(uint32_t, int, int);
 
+    /// Get file descriptor signaling decoded images.
+extern int DiaDecodeFd(void);
+
+    /// Handle decoded images.
+extern void DiaDecodeHandle(void);
+
     // Initialize dia-show module.
 //extern void DiaInit(void);
-    // Cleanup dia-show module.
-//extern void DiaExit(void);
+    /// Cleanup dia-show module.
+extern void DiaExit(void);
 
     /// Parse dia-show configuration.
 extern void DiaConfig(const Config *);
@@ -70,6 +76,14 @@ extern void DiaConfig(const Config *);
     /// Dummy for timeout for dia-show.
 #define DiaTimeout(x, y, z);
 
+    /// Dummy for get file descriptor signaling decoded images.
+#define DiaDecodeFd()	-1
+    /// Dummy for handle decoded images.
+#define DiaDecodeHandle()
+
+    /// Dummy for cleanup dia-show module.
+#define DiaExit()
+
     /// Dummy for parse dia-show configuration.
 #define DiaConfig(config)
 
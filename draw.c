@@ -39,6 +39,7 @@
 #include "core-array/core-array.h"
 #include "core-rc/core-rc.h"
 #include "draw.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 // XCB
@@ -416,7 +417,7 @@ int ColorGetByName(const char *color_name, xcb_coloritem_t * c)
     cookie =
 	xcb_lookup_color_unchecked(Connection, XcbScreen->default_colormap,
 	strlen(color_name), color_name);
-    reply = xcb_lookup_color_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_lookup_color_reply, cookie, NULL);
     if (reply) {
 	c->red = reply->exact_red;
 	c->green = reply->exact_green;
@@ -659,7 +660,7 @@ void ColorInit(void)
 	    for (i = 0; i < 256; i++) {
 		xcb_alloc_color_reply_t *reply;
 
-		reply = xcb_alloc_color_reply(Connection, cookies[i], NULL);
+		reply = StatsReply(xcb_alloc_color_reply, cookies[i], NULL);
 		if (reply) {
 		    ColorRgb8Map[i] = reply->pixel;
 		    c.red = reply->red;
@@ -953,7 +954,7 @@ int FontTextWidthReply(xcb_query_text_extents_cookie_t cookie)
     int width;
     xcb_query_text_extents_reply_t *reply;
 
-    if (!(reply = xcb_query_text_extents_reply(Connection, cookie, NULL))) {
+    if (!(reply = StatsReply(xcb_query_text_extents_reply, cookie, NULL))) {
 	Error("query text extents failed\n");
 	return 0;
     }
@@ -1072,7 +1073,7 @@ static void FontCheck1(Font * font)
     xcb_generic_error_t *error;
 
     if (font->FontName) {
-	if (!(error = xcb_request_check(Connection, font->Cookie))) {
+	if (!(error = StatsReply(xcb_request_check, font->Cookie))) {
 	    font->QCookie = xcb_query_font_unchecked(Connection, font->Font);
 	    return;
 	}
@@ -1102,7 +1103,7 @@ static void FontCheck2(Font * font)
 
     // only good fonts, send request
     if (font->Font != Fonts.Fallback.Font || font == &Fonts.Fallback) {
-	reply = xcb_query_font_reply(Connection, font->QCookie, NULL);
+	reply = StatsReply(xcb_query_font_reply, font->QCookie, NULL);
 	if (reply) {
 	    font->Ascent = reply->font_ascent;
 	    font->Height = reply->font_ascent + reply->font_descent;
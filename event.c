@@ -78,12 +78,16 @@
 #include "plugin/task.h"
 
 #include "dia.h"
+#include "stats.h"
 #include "td.h"
 
 //////////////////////////////////////////////////////////////////////////////
 
 static xcb_generic_event_t *PushedEvent;	///< one event look ahead
 
+    /// reload of configuration requested, done by main event loop
+static char EventReloadPending;
+
     /// maximal movement to detect double click
 int DoubleClickDelta;
 
@@ -142,6 +146,23 @@ static inline int HandleKeyRelease(const xcb_key_release_event_t * event)
     return 1;
 }
 
+/**
+**	Handle mapping notify event.
+**
+**	@param event	mapping notify event
+**
+**	@returns true if event was handled, false otherwise.
+*/
+static inline int HandleMappingNotify(xcb_mapping_notify_event_t * event)
+{
+    Debug(3, "mapping notify request=%d, first=%d, count=%d\n",
+	event->request, event->first_keycode, event->count);
+
+    KeyboardHandleMappingNotify(event);
+
+    return 1;
+}
+
 /**
 **	Handle button press event.
 **
@@ -426,6 +447,22 @@ static inline int HandleEnterNotify(const xcb_enter_notify_event_t * event)
     return 0;
 }
 
+/**
+**	Handle leave notify.
+**
+**	@param event	leave notify event
+**
+**	@returns true if event was handled, false otherwise.
+*/
+static inline int HandleLeaveNotify(const xcb_leave_notify_event_t * event)
+{
+    Debug(3, "leave notify - event %x child %x\n", event->event, event->child);
+
+    PointerSetPosition(event->root_x, event->root_y);
+
+    return PanelHandleLeaveNotify(event);
+}
+
 /**
 **	Handle an expose.
 **
@@ -577,6 +614,7 @@ static inline int HandleMapNotify(const xcb_map_notify_event_t * event)
 		Debug(2, "\tmap full screen window\n");
 	    }
 	    xcb_map_window(Connection, client->Parent);
+	    PagerUpdateThumbnails();
 	    // FIXME: refocus / restack?
 	    //ClientRaise(client);
 	    //ClientFocus(client);
@@ -620,6 +658,7 @@ static inline int HandleMapRequest(const xcb_map_request_event_t * event)
 		Debug(2, "\tmap full screen window\n");
 	    }
 	    xcb_map_window(Connection, client->Parent);
+	    PagerUpdateThumbnails();
 	    ClientRaise(client);
 	    ClientFocus(client);
 	    // Done by focus: TaskUpdate();
@@ -678,6 +717,9 @@ static inline int HandleConfigureNotify(const xcb_configure_notify_event_t *
     if (SwallowHandleConfigureNotify(event)) {
 	return 1;
     }
+    if (SystrayHandleConfigureNotify(event)) {
+	return 1;
+    }
 
     return 0;
 }
@@ -871,7 +913,7 @@ static void DebugAtomName(uint32_t atom)
     int n;
 
     cookie = xcb_get_atom_name_unchecked(Connection, atom);
-    reply = xcb_get_atom_name_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_atom_name_reply, cookie, NULL);
     if (reply) {
 	n = xcb_get_atom_name_name_length(reply);
 	name = xcb_get_atom_name_name(reply);
@@ -906,6 +948,11 @@ static inline int HandleClientMessage(const xcb_client_message_event_t * event)
 	if (event->type == Atoms.UWM_RESTART.Atom) {
 	    KeepRunning = 1;
 	    KeepLooping = 0;
+	} else if (event->type == Atoms.UWM_RELOAD.Atom) {
+	    // can be inside menu or move/resize loop, reload later
+	    EventReloadPending = 1;
+	} else if (event->type == Atoms.UWM_STATISTICS.Atom) {
+	    StatsUpdateProperty();
 	} else if (event->type == Atoms.UWM_EXIT.Atom) {
 	    KeepLooping = 0;
 	} else if (event->type == Atoms.NET_CURRENT_DESKTOP.Atom) {
@@ -1053,6 +1100,8 @@ static void HandleTimeout(void)
     PointerGetPosition(&x, &y);
     PanelTimeout(tick, x, y);
     TooltipTimeout(tick, x, y);
+    KeyboardTimeout(tick, x, y);
+    RootMenuTimeout(tick, x, y);
     DiaTimeout(tick, x, y);
 #ifdef USE_TD
     TdTimeout(tick, x, y);
@@ -1064,7 +1113,7 @@ static void HandleTimeout(void)
 */
 void WaitForEvent(void)
 {
-    struct pollfd fds[1];
+    struct pollfd fds[2];
     int n;
 
     if (PushedEvent) {			// pushed event?
@@ -1073,6 +1122,8 @@ void WaitForEvent(void)
 
     fds[0].fd = xcb_get_file_descriptor(Connection);
     fds[0].events = POLLIN | POLLPRI;
+    // decoded dia-show images, poll ignores -1
+    fds[1].events = POLLIN;
 
     while (KeepLooping) {
 	HandleTimeout();
@@ -1087,7 +1138,8 @@ void WaitForEvent(void)
 	    return;
 	}
 	// FIXME: need to configure the timeout base
-	n = poll(fds, 1, 50);
+	fds[1].fd = DiaDecodeFd();
+	n = poll(fds, 2, 50);
 	if (n < 0) {
 	    Error("error poll %s\n", strerror(errno));
 	    return;
@@ -1101,6 +1153,9 @@ void WaitForEvent(void)
 	    if (fds[0].revents & POLLPRI) {
 		Debug(2, "%d: error\n", fds[0].fd);
 	    }
+	    if (fds[1].revents & POLLIN) {
+		DiaDecodeHandle();
+	    }
 	    if (fds[0].revents & POLLIN) {
 		break;
 	    }
@@ -1205,6 +1260,12 @@ void DiscardMotionEvents(xcb_motion_notify_event_t ** event,
 */
 void EventHandleEvent(xcb_generic_event_t * event)
 {
+#ifdef USE_STATS
+    uint64_t start;
+
+    start = StatsEventStart();
+#endif
+
     switch (XCB_EVENT_RESPONSE_TYPE(event)) {
 	case 0:			// error code
 	    HandleDebugEvent(event);
@@ -1227,6 +1288,9 @@ void EventHandleEvent(xcb_generic_event_t * event)
 	case XCB_ENTER_NOTIFY:		// pointer enter notify
 	    HandleEnterNotify((xcb_enter_notify_event_t *) event);
 	    break;
+	case XCB_LEAVE_NOTIFY:		// pointer leave notify
+	    HandleLeaveNotify((xcb_leave_notify_event_t *) event);
+	    break;
 	case XCB_EXPOSE:		// window redraw
 	    HandleExpose((xcb_expose_event_t *) event);
 	    break;
@@ -1263,6 +1327,9 @@ void EventHandleEvent(xcb_generic_event_t * event)
 	case XCB_CLIENT_MESSAGE:	// client message
 	    HandleClientMessage((xcb_client_message_event_t *) event);
 	    break;
+	case XCB_MAPPING_NOTIFY:	// keyboard/pointer mapping changed
+	    HandleMappingNotify((xcb_mapping_notify_event_t *) event);
+	    break;
 	default:
 #ifdef USE_SHAPE
 	    if (XCB_EVENT_RESPONSE_TYPE(event)
@@ -1270,10 +1337,16 @@ void EventHandleEvent(xcb_generic_event_t * event)
 		HandleShapeNotify((xcb_shape_notify_event_t *) event);
 		break;
 	    }
+#endif
+#ifdef USE_PAGER_THUMBNAIL
+	    if (PagerHandleDamageNotify(event)) {
+		break;
+	    }
 #endif
 	    HandleDebugEvent(event);
 	    break;
     }
+    StatsEvent(XCB_EVENT_RESPONSE_TYPE(event), start);
 }
 
 /**
@@ -1289,6 +1362,12 @@ void EventLoop(void)
 	    EventHandleEvent(event);
 	    free(event);
 	}
+	// reload frees menus and panels, not while they are used
+	if (EventReloadPending && !MenuShown && !ClientControlled) {
+	    EventReloadPending = 0;
+	    ReloadConfig();
+	}
+	StatsLoop();
 	WaitForEvent();
     } while (KeepLooping);
 
@@ -65,6 +65,7 @@
 #include "menu.h"
 #include "desktop.h"
 #include "border.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 // Atom
@@ -172,6 +173,8 @@ AtomTable Atoms = {
 #endif
 
     .UWM_RESTART = {.Name = "_UWM_RESTART"},
+    .UWM_RELOAD = {.Name = "_UWM_RELOAD"},
+    .UWM_STATISTICS = {.Name = "_UWM_STATISTICS"},
     .UWM_EXIT = {.Name = "_UWM_EXIT"}
     // DON'T add here see warnings in AtomInit()
 // *INDENT-ON*
@@ -228,7 +231,7 @@ int AtomGetCardinal(xcb_get_property_cookie_t cookie, uint32_t * value)
 {
     xcb_get_property_reply_t *reply;
 
-    reply = xcb_get_property_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_property_reply, cookie, NULL);
     if (reply) {
 	if (xcb_get_property_value_length(reply) == sizeof(uint32_t)) {
 	    *value = *(uint32_t *) xcb_get_property_value(reply);
@@ -322,7 +325,7 @@ void AtomInit(void)
     for (atom = &Atoms.COMPOUND_TEXT; atom <= &Atoms.UWM_EXIT; ++atom) {
 	xcb_intern_atom_reply_t *reply;
 
-	if ((reply = xcb_intern_atom_reply(Connection, atom->Cookie, NULL))) {
+	if ((reply = StatsReply(xcb_intern_atom_reply, atom->Cookie, NULL))) {
 	    atom->Atom = reply->atom;
 	    free(reply);
 	}
@@ -509,7 +512,7 @@ void HintGetWMName(Client * client)
     free(client->Name);
     client->Name = NULL;
 
-    reply = xcb_get_property_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_property_reply, cookie, NULL);
     if (reply) {
 	if ((n = xcb_get_property_value_length(reply))) {
 	    client->Name = malloc(n + 1);
@@ -525,7 +528,7 @@ void HintGetWMName(Client * client)
     Debug(3, "NET_WM_NAME failed\n");
 
     cookie = xcb_icccm_get_wm_name_unchecked(Connection, client->Window);
-    if (xcb_icccm_get_wm_name_reply(Connection, cookie, &prop, NULL)) {
+    if (StatsReply(xcb_icccm_get_wm_name_reply, cookie, &prop, NULL)) {
 	client->Name = malloc(prop.name_len + 1);
 	memcpy(client->Name, prop.name, prop.name_len);
 	client->Name[prop.name_len] = '\0';
@@ -550,7 +553,7 @@ static void HintGetWMClass(Client * client)
     xcb_icccm_get_wm_class_reply_t prop;
 
     cookie = xcb_icccm_get_wm_class_unchecked(Connection, client->Window);
-    if (xcb_icccm_get_wm_class_reply(Connection, cookie, &prop, NULL)) {
+    if (StatsReply(xcb_icccm_get_wm_class_reply, cookie, &prop, NULL)) {
 	client->InstanceName = strdup(prop.instance_name);
 	client->ClassName = strdup(prop.class_name);
 	xcb_icccm_get_wm_class_reply_wipe(&prop);
@@ -582,7 +585,7 @@ static xcb_get_property_cookie_t HintRequestWMNormal(Client * client)
 */
 static void HintGetWMNormal(xcb_get_property_cookie_t cookie, Client * client)
 {
-    if (!xcb_icccm_get_wm_normal_hints_reply(Connection, cookie,
+    if (!StatsReply(xcb_icccm_get_wm_normal_hints_reply, cookie,
 	    &client->SizeHints, NULL)) {
 	Debug(3, "no normal size hints\n");
 	client->SizeHints.flags = 0;
@@ -685,7 +688,7 @@ static void HintGetWMHints(xcb_get_property_cookie_t cookie, Client * client)
 {
     xcb_icccm_wm_hints_t wm_hints;
 
-    if (xcb_icccm_get_wm_hints_reply(Connection, cookie, &wm_hints, NULL)
+    if (StatsReply(xcb_icccm_get_wm_hints_reply, cookie, &wm_hints, NULL)
 	&& wm_hints.flags & XCB_ICCCM_WM_HINT_STATE) {
 	switch (wm_hints.initial_state) {
 	    case XCB_ICCCM_WM_STATE_WITHDRAWN:
@@ -716,7 +719,7 @@ static void HintGetWMTransientFor(Client * client)
 
     cookie =
 	xcb_icccm_get_wm_transient_for_unchecked(Connection, client->Window);
-    if (xcb_icccm_get_wm_transient_for_reply(Connection, cookie,
+    if (StatsReply(xcb_icccm_get_wm_transient_for_reply, cookie,
 	    &client->Owner, NULL)) {
 	return;
     }
@@ -746,7 +749,7 @@ static void HintGetMotifHints(Client * client)
 	Atoms.MOTIF_WM_HINTS.Atom, Atoms.MOTIF_WM_HINTS.Atom, 0,
 	sizeof(*motif_hints));
 
-    reply = xcb_get_property_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_property_reply, cookie, NULL);
     if (!reply) {
 	return;
     }
@@ -810,7 +813,7 @@ static void HintGetNetWmState(xcb_get_property_cookie_t cookie,
 {
     xcb_get_property_reply_t *reply;
 
-    if ((reply = xcb_get_property_reply(Connection, cookie, NULL))) {
+    if ((reply = StatsReply(xcb_get_property_reply, cookie, NULL))) {
 	// check if reply is valid
 	if (reply->value_len && reply->format == 32) {
 	    xcb_atom_t *atoms;
@@ -889,7 +892,7 @@ static void HintGetNetWmWindowType(xcb_get_property_cookie_t cookie,
 {
     xcb_get_property_reply_t *reply;
 
-    if ((reply = xcb_get_property_reply(Connection, cookie, NULL))) {
+    if ((reply = StatsReply(xcb_get_property_reply, cookie, NULL))) {
 	// check if reply is valid
 	if (reply->value_len && reply->format == 32) {
 	    xcb_atom_t *atoms;
@@ -154,6 +154,8 @@ struct _atoms_
 
     // WM-specific atoms
     Atom UWM_RESTART;			///< private, restart window manager
+    Atom UWM_RELOAD;			///< private, reload configuration
+    Atom UWM_STATISTICS;		///< private, runtime statistics
     Atom UWM_EXIT;			///< private, exit window manager
 };
 
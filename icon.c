@@ -61,6 +61,7 @@
 
 #include "image.h"
 #include "icon.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 
@@ -998,6 +999,34 @@ Icon *IconLoadNamed(const char *name)
     return NULL;
 }
 
+/**
+**	Load an uncached icon from a file, reduced to a size.
+**
+**	Used for big images like backgrounds, the image is reduced while
+**	decoding and never hold in full resolution.  Names which aren't
+**	files are searched in the icon path.
+**
+**	@param name	file name of icon to load
+**	@param width	requested size of icon
+**	@param height	requested size of icon
+**
+**	@returns icon structure, NULL if not found.
+*/
+Icon *IconLoadSized(const char *name, unsigned width, unsigned height)
+{
+    Image *image;
+    Icon *icon;
+
+    if (!(image = ImageLoadFileSized(name, width, height))) {
+	return IconLoadNamed(name);
+    }
+    // no name, icon isn't shared and freed by IconDel
+    icon = IconNew();
+    icon->Image = image;
+
+    return icon;
+}
+
 /**
 **	Create an icon from binary data (as specified via window properties).
 **
@@ -1064,7 +1093,7 @@ static void IconReadNetWMIcon(Client * client)
 
     cookie = AtomCardinalRequest(client->Window, &Atoms.NET_WM_ICON);
 
-    reply = xcb_get_property_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_property_reply, cookie, NULL);
     if (reply) {
 	count = xcb_get_property_value_length(reply) / sizeof(uint32_t);
 	data = xcb_get_property_value(reply);
@@ -80,6 +80,9 @@ extern Icon *IconLoadSuffixed(const char *, const char *, const char *);
     /// Load an icon from a file.
 extern Icon *IconLoadNamed(const char *);
 
+    /// Load an uncached icon from a file, reduced to a size.
+extern Icon *IconLoadSized(const char *, unsigned, unsigned);
+
     /// Load an icon for a client.
 extern void IconLoadClient(Client *);
 
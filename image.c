@@ -34,6 +34,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 
 #include <xcb/xcb_aux.h>
 
@@ -68,7 +69,7 @@ extern int ColorGetByName(const char *, xcb_coloritem_t *);
 **
 **	@returns allocated image structure, NULL on failures.
 */
-static Image *ImageNew(unsigned width, unsigned height)
+Image *ImageNew(unsigned width, unsigned height)
 {
     Image *image;
 
@@ -95,6 +96,56 @@ void ImageDel(Image * image)
     }
 }
 
+#if defined(USE_JPEG) || defined(USE_PNG)	// {
+
+/**
+**	Read an image file into memory.
+**
+**	The file is read into a buffer and not mapped, a mapped file
+**	truncated while decoding would raise SIGBUS.
+**
+**	@param name		file name of image
+**	@param[out] size	size of read file
+**
+**	@returns malloc'ed file contents, NULL if failure.
+*/
+static const uint8_t *ImageReadFile(const char *name, size_t * size)
+{
+    int fd;
+    struct stat st;
+    uint8_t *data;
+    size_t length;
+    ssize_t n;
+
+    if ((fd = open(name, O_RDONLY | O_CLOEXEC)) < 0) {
+	Debug(3, "%s: can't open %s: %s\n", __FUNCTION__, name,
+	    strerror(errno));
+	return NULL;
+    }
+    if (fstat(fd, &st) || !st.st_size || !(data = malloc(st.st_size))) {
+	close(fd);
+	return NULL;
+    }
+    // file could shrink while reading, use what was read
+    length = 0;
+    while (length < (size_t) st.st_size
+	&& (n = pread(fd, data + length, st.st_size - length, length)) > 0) {
+	length += n;
+    }
+    close(fd);
+    if (!length) {
+	Debug(3, "%s: can't read %s: %s\n", __FUNCTION__, name,
+	    strerror(errno));
+	free(data);
+	return NULL;
+    }
+
+    *size = length;
+    return data;
+}
+
+#endif // } USE_JPEG || USE_PNG
+
 #ifdef USE_JPEG				// {
 
 #include <jpeglib.h>
@@ -115,6 +166,9 @@ static void ImageJPEGErrorExit(j_common_ptr cinfo)
 /**
 **	Load a JPEG image from given file name.
 **
+**	The image is downscaled by the DCT while decoding, to the smallest
+**	size which covers the requested output size.
+**
 **	@param name	file name to open JPEG file
 **	@param width	requested output size (or 0)
 **	@param height	requested output size (or 0)
@@ -126,7 +180,12 @@ static void ImageJPEGErrorExit(j_common_ptr cinfo)
 */
 Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
 {
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+    const uint8_t *data;
+    size_t size;
+#else
     FILE *fd;
+#endif
     Image *image;
     jmp_buf jmpbuf;
     struct jpeg_decompress_struct cinfo;
@@ -135,11 +194,17 @@ Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
     uint8_t *argb;
 
     // open the file
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+    if (!(data = ImageReadFile(name, &size))) {
+	return NULL;
+    }
+#else
     if (!(fd = fopen(name, "rb"))) {
 	Debug(3, "%s: can't open %s: %s\n", __FUNCTION__, name,
 	    strerror(errno));
 	return NULL;
     }
+#endif
 
     image = NULL;
     if (setjmp(jmpbuf)) {		// return here, if any errors
@@ -148,7 +213,11 @@ Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
 	}
 
 	jpeg_destroy_decompress(&cinfo);
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+	free((void *)data);
+#else
 	fclose(fd);
+#endif
 
 	return NULL;
     }
@@ -159,7 +228,11 @@ Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
     // prepare to load the file
     jpeg_create_decompress(&cinfo);
     cinfo.client_data = jmpbuf;
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+    jpeg_mem_src(&cinfo, (unsigned char *)data, size);
+#else
     jpeg_stdio_src(&cinfo, fd);
+#endif
 
     // check the header
     jpeg_read_header(&cinfo, TRUE);
@@ -178,15 +251,23 @@ Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
 	int scale_h;
 
 	// jpeg docs says: n 1/8 .. 16/8 are supported
-	scale_w = (width * cinfo.scale_denom) / cinfo.image_width;
-	scale_h = (height * cinfo.scale_denom) / cinfo.image_height;
+	// libjpeg 6b and turbo 62 default to 1/1, set denominator
+	cinfo.scale_denom = 8;
+	// round up, output must cover the requested size
+	scale_w =
+	    (width * cinfo.scale_denom + cinfo.image_width -
+	    1) / cinfo.image_width;
+	scale_h =
+	    (height * cinfo.scale_denom + cinfo.image_height -
+	    1) / cinfo.image_height;
 
 	cinfo.scale_num = scale_w;
 	if (scale_h > scale_w) {
 	    cinfo.scale_num = scale_h;
 	}
-	if (cinfo.scale_num >= 16) {
-	    cinfo.scale_num = 16;
+	// upscaling is done better by the caller
+	if (cinfo.scale_num > 8) {
+	    cinfo.scale_num = 8;
 	} else if (cinfo.scale_num < 1) {
 	    cinfo.scale_num = 1;
 	}
@@ -226,7 +307,11 @@ Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
 	cinfo.output_width * cinfo.output_components, cinfo.rec_outbuf_height);
     if (!(image = ImageNew(cinfo.output_width, cinfo.output_height))) {
 	jpeg_destroy_decompress(&cinfo);
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+	free((void *)data);
+#else
 	fclose(fd);
+#endif
 	return NULL;
     }
     argb = image->Data;
@@ -265,27 +350,19 @@ Image *ImageLoadJPEG0(const char *name, unsigned width, unsigned height)
 
     // clean up
     jpeg_destroy_decompress(&cinfo);
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+    free((void *)data);
+#else
     fclose(fd);
+#endif
 
     return image;
 }
 
-/**
-**	Load a JPEG image from given file name.
-**
-**	@param name	file name to open JPEG file
-**
-**	@returns loaded ARGB image, NULL if failure.
-*/
-static Image *ImageLoadJPEG(const char *name)
-{
-    return ImageLoadJPEG0(name, 0, 0);
-}
-
 #else // }{ USE_JPEG
 
     /// Dummy for load a JPEG image from given file name.
-#define ImageLoadJPEG(name)	NULL
+#define ImageLoadJPEG0(name, width, height)	NULL
 
 #endif // } USE_JPEG
 
@@ -295,59 +372,97 @@ static Image *ImageLoadJPEG(const char *name)
 #define PNG_SKIP_SETJMP_CHECK
 #include <png.h>
 
+/**
+**	PNG memory reader state.
+*/
+typedef struct _image_png_reader_
+{
+    const uint8_t *Data;		///< file contents
+    size_t Size;			///< size of file contents
+    size_t Offset;			///< current read offset
+} ImagePNGReader;
+
+/**
+**	Called from png to read data from the file contents.
+**
+**	@param png_ptr	PNG read structure
+**	@param data	read data into this buffer
+**	@param length	number of bytes to read
+*/
+static void ImagePNGRead(png_structp png_ptr, png_bytep data,
+    png_size_t length)
+{
+    ImagePNGReader *reader;
+
+    reader = png_get_io_ptr(png_ptr);
+    if (length > reader->Size - reader->Offset) {
+	png_error(png_ptr, "read past end of file");
+    }
+    memcpy(data, reader->Data + reader->Offset, length);
+    reader->Offset += length;
+}
+
 /**
 **	Load a PNG image from given file name.
 **
+**	If an output size is requested, the image is reduced row by row
+**	with a box filter to the smallest size which covers the requested
+**	size.  Only one input row is kept in memory.
+**
 **	@param name	file name to open PNG file.
+**	@param width	requested output size (or 0)
+**	@param height	requested output size (or 0)
 **
 **	@returns loaded ARGB image, NULL if failure.
 **
 **	@see http://libpng.org/pub/png/libpng-manual.html
 */
-static Image *ImageLoadPNG(const char *name)
+static Image *ImageLoadPNG0(const char *name, unsigned width,
+    unsigned height)
 {
-    FILE *fd;
+    ImagePNGReader reader;
     Image *image;
-    uint8_t header[8];
-    int n;
     png_structp png_ptr;
     png_infop info_ptr;
     png_infop end_info;
     uint8_t **rows;
+    uint8_t *row;
+    uint32_t *sums;
     int bit_depth;
     int color_type;
     unsigned u;
-    png_uint_32 width;
-    png_uint_32 height;
+    unsigned n;
+    unsigned factor;
+    png_uint_32 png_width;
+    png_uint_32 png_height;
     int has_alpha;
 
-    // open the file
-    if (!(fd = fopen(name, "rb"))) {
-	Debug(3, "can't open %s: %s\n", name, strerror(errno));
+    // read the file
+    if (!(reader.Data = ImageReadFile(name, &reader.Size))) {
 	return NULL;
     }
-    n = fread(header, 1, sizeof(header), fd);
-    if (n != sizeof(header) || png_sig_cmp(header, 0, sizeof(header))) {
-	fclose(fd);
+    if (reader.Size < 8 || png_sig_cmp((png_bytep) reader.Data, 0, 8)) {
+	free((void *)reader.Data);
 	return NULL;
     }
+    reader.Offset = 8;
 
     if (!(png_ptr =
 	    png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL))) {
 	Warning("couldn't create read struct for PNG %s\n", name);
-	fclose(fd);
+	free((void *)reader.Data);
 	return NULL;
     }
     if (!(info_ptr = png_create_info_struct(png_ptr))) {
 	Warning("couldn't create info struct for PNG %s\n", name);
 	png_destroy_read_struct(&png_ptr, NULL, NULL);
-	fclose(fd);
+	free((void *)reader.Data);
 	return NULL;
     }
     if (!(end_info = png_create_info_struct(png_ptr))) {
 	Warning("couldn't create end info struct for PNG %s\n", name);
 	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-	fclose(fd);
+	free((void *)reader.Data);
 	return NULL;
     }
 
@@ -358,19 +473,17 @@ static Image *ImageLoadPNG(const char *name)
 	    ImageDel(image);
 	}
 	png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-	if (fd) {
-	    fclose(fd);
-	}
+	free((void *)reader.Data);
 	return NULL;
     }
 
-    png_init_io(png_ptr, fd);
-    png_set_sig_bytes(png_ptr, sizeof(header));
+    png_set_read_fn(png_ptr, &reader, ImagePNGRead);
+    png_set_sig_bytes(png_ptr, 8);
 
     png_read_info(png_ptr, info_ptr);
 
-    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
-	NULL, NULL, NULL);
+    png_get_IHDR(png_ptr, info_ptr, &png_width, &png_height, &bit_depth,
+	&color_type, NULL, NULL, NULL);
 
     // check alpha
     has_alpha = 0;
@@ -414,46 +527,91 @@ static Image *ImageLoadPNG(const char *name)
     }
 #endif
 
+    // interlaced images need the full image, no row by row reduce
+    factor = 1;
+    if (png_set_interlace_handling(png_ptr) == 1 && width && height) {
+	factor = MIN(png_width / width, png_height / height);
+	if (!factor) {
+	    factor = 1;
+	}
+    }
+
     png_read_update_info(png_ptr, info_ptr);
 
-    if (png_get_rowbytes(png_ptr, info_ptr) != 4 * width) {
+    if (png_get_rowbytes(png_ptr, info_ptr) != 4 * png_width) {
 	Warning("png image result must be 4 bytes / pixel\n");
 	png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-	if (fd) {
-	    fclose(fd);
-	}
+	free((void *)reader.Data);
 	return NULL;
     }
-    if (!(image = ImageNew(width, height))) {
+    if (!(image = ImageNew(png_width / factor, png_height / factor))) {
 	png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-	if (fd) {
-	    fclose(fd);
-	}
+	free((void *)reader.Data);
 	return NULL;
     }
-    //
-    //	Prepare rows for png_read_image
-    //
-    rows = alloca(height * sizeof(*rows));
-    for (n = 0, u = 0; u < height; n += width * 4, u++) {
-	rows[u] = &image->Data[n];
-    }
 
-    png_read_image(png_ptr, rows);
+    if (factor == 1) {
+	//
+	//	Prepare rows for png_read_image
+	//
+	rows = alloca(png_height * sizeof(*rows));
+	for (n = 0, u = 0; u < png_height; n += png_width * 4, u++) {
+	    rows[u] = &image->Data[n];
+	}
+
+	png_read_image(png_ptr, rows);
+
+	// alpha premultiply
+	for (u = 0; u < png_width * png_height * 4; u += 4) {
+	    image->Data[u + 1] =
+		(image->Data[u + 1] * (image->Data[u + 0] + 1)) >> 8;
+	    image->Data[u + 2] =
+		(image->Data[u + 2] * (image->Data[u + 0] + 1)) >> 8;
+	    image->Data[u + 3] =
+		(image->Data[u + 3] * (image->Data[u + 0] + 1)) >> 8;
+	}
 
-    // alpha premultiply
-    for (u = 0; u < width * height * 4; u += 4) {
-	image->Data[u + 1] =
-	    (image->Data[u + 1] * (image->Data[u + 0] + 1)) >> 8;
-	image->Data[u + 2] =
-	    (image->Data[u + 2] * (image->Data[u + 0] + 1)) >> 8;
-	image->Data[u + 3] =
-	    (image->Data[u + 3] * (image->Data[u + 0] + 1)) >> 8;
+	png_read_end(png_ptr, info_ptr);
+    } else {
+	uint8_t *argb;
+
+	//
+	//	Box filter: sum factor x factor premultiplied pixels
+	//
+	row = alloca(png_width * 4);
+	sums = alloca(image->Width * 4 * sizeof(*sums));
+	memset(sums, 0, image->Width * 4 * sizeof(*sums));
+	argb = image->Data;
+
+	for (u = 0; u < png_height; ++u) {
+	    png_read_row(png_ptr, row, NULL);
+	    if (u >= image->Height * factor) {	// skip remaining rows
+		continue;
+	    }
+	    for (n = 0; n < image->Width * factor * 4; n += 4) {
+		uint32_t *sum;
+
+		sum = sums + (n / 4 / factor) * 4;
+		sum[0] += row[n + 0];
+		sum[1] += (row[n + 1] * (row[n + 0] + 1)) >> 8;
+		sum[2] += (row[n + 2] * (row[n + 0] + 1)) >> 8;
+		sum[3] += (row[n + 3] * (row[n + 0] + 1)) >> 8;
+	    }
+	    if ((u + 1) % factor) {
+		continue;
+	    }
+	    // output row complete
+	    for (n = 0; n < image->Width * 4u; ++n) {
+		*argb++ = sums[n] / (factor * factor);
+	    }
+	    memset(sums, 0, image->Width * 4 * sizeof(*sums));
+	}
+
+	png_read_end(png_ptr, info_ptr);
     }
 
-    png_read_end(png_ptr, info_ptr);
     png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-    fclose(fd);
+    free((void *)reader.Data);
 
     return image;
 }
@@ -461,7 +619,7 @@ static Image *ImageLoadPNG(const char *name)
 #else // }{ USE_PNG
 
     /// Dummy for load a PNG image from given file name.
-#define ImageLoadPNG(name)	NULL
+#define ImageLoadPNG0(name, width, height)	NULL
 
 #endif // } !USE_PNG
 
@@ -779,13 +937,68 @@ Image *ImageFromARGB(unsigned width, unsigned height, const uint32_t * data)
 }
 
 /**
-**	Load an image from the specified file.
+**	Scale an image.
+**
+**	Nearest neighbor scaling, like the scaled icons.
+**
+**	@param image	image to scale
+**	@param width	width of scaled image
+**	@param height	height of scaled image
+**
+**	@returns new scaled image, NULL on failures.
+*/
+Image *ImageScale(const Image * image, unsigned width, unsigned height)
+{
+    Image *scaled;
+    unsigned scale_x;
+    unsigned scale_y;
+    unsigned src_y;
+    unsigned y;
+    uint8_t *argb;
+
+    if (!(scaled = ImageNew(width, height))) {
+	return NULL;
+    }
+    // determine scale factor
+    scale_x = (65536 * image->Width) / width;
+    scale_y = (65536 * image->Height) / height;
+
+    argb = scaled->Data;
+    src_y = 0;
+    for (y = 0; y < height; y++) {
+	const uint8_t *row;
+	unsigned src_x;
+	unsigned x;
+
+	row = image->Data + (src_y / 65536) * image->Width * 4;
+	src_x = 0;
+	for (x = 0; x < width; x++) {
+	    memcpy(argb, row + (src_x / 65536) * 4, 4);
+	    argb += 4;
+	    src_x += scale_x;
+	}
+	src_y += scale_y;
+    }
+
+    return scaled;
+}
+
+/**
+**	Load a JPEG or PNG image from the specified file, reduced to a size.
+**
+**	JPEG and PNG images are reduced while decoding to the smallest
+**	size covering the requested size, they never need memory for the
+**	full resolution image.  No X requests are made, can be called from
+**	any thread.
 **
 **	@param name	file containing the image.
+**	@param width	requested output size (or 0 for full size)
+**	@param height	requested output size (or 0 for full size)
 **
 **	@return A new image node (NULL if the image could not be loaded).
 */
-Image *ImageLoadFile(const char *name)
+Image *ImageLoadRasterSized(const char *name, unsigned width,
+    unsigned height)
 {
     Image *image;
 
@@ -793,11 +1006,37 @@ Image *ImageLoadFile(const char *name)
 	return NULL;
     }
     // attempt to load the file as a JPEG image
-    if ((image = ImageLoadJPEG(name))) {
+    if ((image = ImageLoadJPEG0(name, width, height))) {
 	return image;
     }
     // attempt to load the file as a PNG image
-    if ((image = ImageLoadPNG(name))) {
+    if ((image = ImageLoadPNG0(name, width, height))) {
+	return image;
+    }
+
+    return NULL;
+}
+
+/**
+**	Load an image from the specified file, reduced to a size.
+**
+**	JPEG and PNG images are reduced while decoding, see
+**	ImageLoadRasterSized().  Other images are loaded unscaled.
+**
+**	@param name	file containing the image.
+**	@param width	requested output size (or 0 for full size)
+**	@param height	requested output size (or 0 for full size)
+**
+**	@return A new image node (NULL if the image could not be loaded).
+*/
+Image *ImageLoadFileSized(const char *name, unsigned width, unsigned height)
+{
+    Image *image;
+
+    if (!name) {
+	return NULL;
+    }
+    if ((image = ImageLoadRasterSized(name, width, height))) {
 	return image;
     }
     // attempt to load the file as an XPM image
@@ -808,6 +1047,18 @@ Image *ImageLoadFile(const char *name)
     return NULL;
 }
 
+/**
+**	Load an image from the specified file.
+**
+**	@param name	file containing the image.
+**
+**	@return A new image node (NULL if the image could not be loaded).
+*/
+Image *ImageLoadFile(const char *name)
+{
+    return ImageLoadFileSized(name, 0, 0);
+}
+
 /// @}
 
 #endif // } USE_ICON
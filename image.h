@@ -58,9 +58,21 @@ extern Image *ImageLoadJPEG0(const char *name, unsigned, unsigned);
 extern Image *ImageFromData(const char *const *);
 #endif
 
+    /// Create a new random filled image.
+extern Image *ImageNew(unsigned, unsigned);
+
     /// Create an image from ARGB data.
 extern Image *ImageFromARGB(unsigned, unsigned, const uint32_t *);
 
+    /// Scale an image.
+extern Image *ImageScale(const Image *, unsigned, unsigned);
+
+    /// Load a JPEG or PNG image from the specified file, reduced to a size.
+extern Image *ImageLoadRasterSized(const char *, unsigned, unsigned);
+
+    /// Load an image from the specified file, reduced to a size.
+extern Image *ImageLoadFileSized(const char *, unsigned, unsigned);
+
     /// Load an image from the specified file.
 extern Image *ImageLoadFile(const char *);
 
@@ -25,7 +25,17 @@
 ///
 ///	This module handles keyboard input.
 ///
-///	@todo parse keyboard config, grab keys.
+///	The key bindings are resolved once into a trie of (keycode, modifier)
+///	maps, when the module is initialized and when the keyboard mapping
+///	changes.  Dispatching a key press is then a single lookup.
+///	Lock modifiers (caps-lock, shift-lock, num-lock) are ignored for
+///	bindings, they are grabbed with every lock combination.
+///
+///	A binding can be a sequence of keys (f.e. mod4+w h).  Only the
+///	first key of a sequence is grabbed on the client windows, after it
+///	is pressed the keyboard is grabbed until the sequence is complete,
+///	an unbound key is pressed or the sequence times out.  Modal
+///	bindings keep their sequence prefix active after execution.
 ///
 ///< @{
 
@@ -44,6 +54,7 @@
 #include "core-array/core-array.h"
 #include "core-rc/core-rc.h"
 
+#include "misc.h"
 #include "draw.h"
 #include "image.h"
 #include "pointer.h"
@@ -51,6 +62,7 @@
 #include "keyboard.h"
 #include "icon.h"
 #include "menu.h"
+#include "stats.h"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -63,15 +75,31 @@ typedef struct _keyboard_key_
     xcb_keysym_t KeySym;		///< keyboard symbol
 } KeyboardKey;
 
+    /// maximal number of keys in a key sequence
+#define KEYBOARD_SEQUENCE_MAX	4
+
 /**
 **	Keyboard binding.
 */
 typedef struct _keyboard_binding_
 {
-    KeyboardKey Key;			///< key sequence for command
+    KeyboardKey Keys[KEYBOARD_SEQUENCE_MAX];	///< key sequence for command
+    uint8_t KeyN;			///< number of keys in sequence
+    uint8_t Modal;			///< keep sequence prefix active
     MenuCommand Command;		///< command to execute
 } KeyboardBinding;
 
+/**
+**	Keyboard key sequence trie node.
+**
+**	Inner nodes have a map, leaf nodes a binding.
+*/
+typedef struct _keyboard_node_
+{
+    Array *Map;				///< (keycode, modifier) -> next node
+    const KeyboardBinding *Binding;	///< command at end of sequence
+} KeyboardNode;
+
 static xcb_key_symbols_t *XcbKeySymbols;	///< Keyboard symbols
 static uint16_t NumLockMask;		///< mod mask for num-lock
 static uint16_t ShiftLockMask;		///< mod mask for shift-lock
@@ -84,6 +112,28 @@ static KeyboardBinding *KeyboardBindings;
     /// number of keyboard bindings in table
 static int KeyboardBindingN;
 
+    /// lock modifiers ignored by key bindings
+static uint16_t KeyboardIgnoreMask;
+
+    /// root of the key sequence trie
+static KeyboardNode KeyboardRoot;
+
+    /// current node of an active key sequence, NULL if none
+static const KeyboardNode *KeyboardState;
+
+    /// tick of last key of active key sequence
+static uint32_t KeyboardStateTick;
+
+    /// timeout in ms of key sequences
+static int KeyboardSequenceTimeout = KEYBOARD_DEFAULT_TIMEOUT;
+
+    /// modifiers which can be used in key bindings
+#define KEYBOARD_MODIFIER_MASK	0xFF
+
+    /// build key of keycode map
+#define KEYBOARD_MAP_KEY(keycode, modifier) \
+    (((size_t)(keycode) << 16) | (modifier))
+
 /**
 **	Grab keyboard, send request.
 **
@@ -108,7 +158,7 @@ int KeyboardGrabReply(xcb_grab_keyboard_cookie_t cookie)
 {
     xcb_grab_keyboard_reply_t *reply;
 
-    if ((reply = xcb_grab_keyboard_reply(Connection, cookie, NULL))) {
+    if ((reply = StatsReply(xcb_grab_keyboard_reply, cookie, NULL))) {
 	int status;
 
 	Debug(3, "  grab keyboard %d\n", reply->status);
@@ -174,56 +224,208 @@ xcb_keysym_t KeyboardGet(xcb_keycode_t keycode, unsigned modifier)
 /**
 **	Grab a key on client window.
 **
+**	The key is grabbed with all combinations of the lock modifiers,
+**	which are ignored by KeyboardHandler().
+**
 **	@param client		window client
 **	@param modifiers	X11 modifiers
-**	@param keysym		X11 keycode
+**	@param keycode		X11 keycode
 */
 static void KeyboardGrabKey(Client * client, unsigned modifiers,
-    unsigned keysym)
+    xcb_keycode_t keycode)
 {
-    xcb_keycode_t *keycodes;
+    unsigned lock;
 
+    Debug(3, "grab keycode %x %x\n", modifiers, keycode);
+
+    // all subsets of the lock modifiers
+    lock = KeyboardIgnoreMask;
+    for (;;) {
+	xcb_grab_key(Connection, 1, client->Window, modifiers | lock, keycode,
+	    XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
+	if (!lock) {
+	    break;
+	}
+	lock = (lock - 1) & KeyboardIgnoreMask;
+    }
+}
+
+/**
+**	Grab our key bindings on client window.
+**
+**	Only the first key of each key sequence is grabbed, the rest of
+**	a sequence is read with an active keyboard grab.
+**
+**	@param client	window client
+*/
+void KeyboardGrabBindings(Client * client)
+{
+    size_t index;
+    size_t *value;
+
+    if (!KeyboardRoot.Map) {
+	return;
+    }
     //
-    //	FIXME: grab key with all lock modifiers
+    //	go through all first keys
     //
+    index = 0;
+    value = ArrayFirst(KeyboardRoot.Map, &index);
+    while (value) {
+	KeyboardGrabKey(client, index & 0xFFFF, index >> 16);
+	value = ArrayNext(KeyboardRoot.Map, &index);
+    }
+}
 
-    keycodes = xcb_key_symbols_get_keycode(XcbKeySymbols, keysym);
-    if (keycodes) {
-	xcb_keycode_t *key_code;
-	xcb_keycode_t last;
+/**
+**	Free the children of a key sequence trie node.
+**
+**	@param node	trie node
+*/
+static void KeyboardNodeFree(KeyboardNode * node)
+{
+    size_t index;
+    size_t *value;
 
-	last = 0;
-	for (key_code = keycodes; *key_code; key_code++) {
-	    Debug(3, "grab keycode %x %x\n", modifiers, *key_code);
-	    if (*key_code == last) {	// ignore simple duplicates
-		Debug(3, "double keycodes\n");
+    if (node->Map) {
+	index = 0;
+	value = ArrayFirst(node->Map, &index);
+	while (value) {
+	    KeyboardNodeFree((KeyboardNode *) * value);
+	    free((KeyboardNode *) * value);
+	    value = ArrayNext(node->Map, &index);
+	}
+	ArrayFree(node->Map);
+	node->Map = NULL;
+    }
+    node->Binding = NULL;
+}
+
+/**
+**	Insert keyboard binding into key sequence trie.
+**
+**	@param node	trie node of key sequence prefix
+**	@param binding	keyboard binding to insert
+**	@param depth	index of key in sequence
+*/
+static void KeyboardNodeInsert(KeyboardNode * node,
+    const KeyboardBinding * binding, int depth)
+{
+    xcb_keycode_t *keycodes;
+    xcb_keycode_t *key_code;
+    uint16_t modifier;
+
+    keycodes =
+	xcb_key_symbols_get_keycode(XcbKeySymbols,
+	binding->Keys[depth].KeySym);
+    if (!keycodes) {			// checked by caller
+	return;
+    }
+    modifier =
+	binding->Keys[depth].Modifier & KEYBOARD_MODIFIER_MASK &
+	~KeyboardIgnoreMask;
+    if (!node->Map) {
+	node->Map = ArrayNew();
+    }
+    for (key_code = keycodes; *key_code; key_code++) {
+	KeyboardNode *child;
+	size_t key;
+
+	key = KEYBOARD_MAP_KEY(*key_code, modifier);
+	if (!(child = (KeyboardNode *) ArrayGet(node->Map, key))) {
+	    child = calloc(1, sizeof(*child));
+	    ArrayIns(&node->Map, key, (size_t)child);
+	}
+	if (child->Binding) {		// first binding wins
+	    if (depth + 1 == binding->KeyN) {
+		Warning("duplicate key binding ignored\n");
+	    } else {
+		Warning("key binding hidden by shorter key sequence\n");
+	    }
+	    continue;
+	}
+	if (depth + 1 == binding->KeyN) {
+	    if (child->Map) {
+		Warning("key binding is prefix of key sequence, ignored\n");
 		continue;
 	    }
-	    last = *key_code;
-	    xcb_grab_key(Connection, 1, client->Window, modifiers, *key_code,
-		XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
+	    child->Binding = binding;
+	} else {
+	    KeyboardNodeInsert(child, binding, depth + 1);
 	}
-	free(keycodes);
     }
+    free(keycodes);
 }
 
 /**
-**	Grab our key bindings on client window.
+**	Build the key sequence trie of (keycode, modifier) -> node maps.
 **
-**	@param client	window client
+**	Must be called again, if the keyboard mapping changes.
 */
-void KeyboardGrabBindings(Client * client)
+static void KeyboardBuildKeycodeMap(void)
 {
     int i;
 
-    //
-    //	go through all bindings
-    //
+    KeyboardState = NULL;
+    KeyboardNodeFree(&KeyboardRoot);
+    KeyboardRoot.Map = ArrayNew();
+
     for (i = 0; i < KeyboardBindingN; ++i) {
-	Debug(3, "grab-bindings: %x %x\n", KeyboardBindings[i].Key.Modifier,
-	    KeyboardBindings[i].Key.KeySym);
-	KeyboardGrabKey(client, KeyboardBindings[i].Key.Modifier,
-	    KeyboardBindings[i].Key.KeySym);
+	const KeyboardBinding *binding;
+	int j;
+
+	binding = &KeyboardBindings[i];
+	if (!binding->KeyN) {
+	    continue;
+	}
+	// all keys need a keycode, or the trie gets nodes without binding
+	for (j = 0; j < binding->KeyN; ++j) {
+	    xcb_keycode_t *keycodes;
+
+	    keycodes =
+		xcb_key_symbols_get_keycode(XcbKeySymbols,
+		binding->Keys[j].KeySym);
+	    if (!keycodes) {
+		Debug(3, "no keycode for keysym %#010x\n",
+		    binding->Keys[j].KeySym);
+		break;
+	    }
+	    free(keycodes);
+	}
+	if (j == binding->KeyN) {
+	    KeyboardNodeInsert(&KeyboardRoot, binding, 0);
+	}
+    }
+}
+
+/**
+**	Enter or continue key sequence.
+**
+**	@param node	trie node of key sequence prefix
+**
+**	@returns true if the key sequence is active, false otherwise.
+*/
+static int KeyboardSequenceEnter(const KeyboardNode * node)
+{
+    if (!KeyboardState) {		// need all keys until sequence end
+	if (!KeyboardGrabReply(KeyboardGrabRequest(XcbScreen->root))) {
+	    Debug(2, "keyboard: can't grab keyboard for key sequence\n");
+	    return 0;
+	}
+    }
+    KeyboardState = node;
+    KeyboardStateTick = GetMsTicks();
+    return 1;
+}
+
+/**
+**	Leave active key sequence.
+*/
+static void KeyboardSequenceLeave(void)
+{
+    if (KeyboardState) {
+	KeyboardState = NULL;
+	xcb_ungrab_keyboard(Connection, XCB_CURRENT_TIME);
     }
 }
 
@@ -281,15 +483,15 @@ static const char *KeyboardMask2String(uint16_t mask)
 **	@param event	key press or key release event
 **
 **	@todo pressing keysym simultaneous for a command, isn't supported.
-**	@todo pressing keysym in sequence for a command, isn't supported.
-**	@todo check shift-lock num-lock
 */
 void KeyboardHandler(int pressed, const xcb_key_press_event_t * event)
 {
-    int i;
-    xcb_keysym_t keysym;
+    const KeyboardNode *node;
+    const KeyboardNode *next;
 
 #ifdef DEBUG
+    int i;
+
     Debug(4, "%s: %d, %d, %d ", __FUNCTION__, pressed, event->detail,
 	event->state);
     if (event->state) {
@@ -305,38 +507,74 @@ void KeyboardHandler(int pressed, const xcb_key_press_event_t * event)
     if (!pressed) {			// for now ignore any release
 	return;
     }
-    // convert keycode into keysym
-    keysym = KeyboardGet(event->detail, event->state);
-    Debug(3, "keysym %#010x\n", keysym);
-
+    if (!KeyboardRoot.Map) {		// keyboard module not ready
+	return;
+    }
+    node = KeyboardState ? KeyboardState : &KeyboardRoot;
     //
-    //	search mapping for the key
+    //	lookup mapping for the key, lock modifiers are ignored
     //
-    for (i = 0; i < KeyboardBindingN; ++i) {
-	if (KeyboardBindings[i].Key.Modifier == event->state
-	    && KeyboardBindings[i].Key.KeySym == keysym) {
-
-	    Debug(4, "found key with command %d\n",
-		KeyboardBindings[i].Command.Type);
-
-	    MenuCommandExecute(&KeyboardBindings[i].Command, event->root_x,
-		event->root_y, ClientGetActive());
-	    break;
+    next = (const KeyboardNode *)ArrayGet(node->Map,
+	KEYBOARD_MAP_KEY(event->detail,
+	    event->state & KEYBOARD_MODIFIER_MASK & ~KeyboardIgnoreMask));
+    if (!next) {
+	// modifiers pressed inside a sequence, belong to the next key
+	if (KeyboardState
+	    && !xcb_is_modifier_key(xcb_key_symbols_get_keysym(XcbKeySymbols,
+		    event->detail, 0))) {
+	    Debug(3, "key sequence aborted\n");
+	    KeyboardSequenceLeave();
 	}
+	return;
+    }
+    if (next->Map) {			// prefix of key sequence
+	KeyboardSequenceEnter(next);
+	return;
     }
+    if (!next->Binding) {		// node without binding
+	KeyboardSequenceLeave();
+	return;
+    }
+
+    Debug(4, "found key with command %d\n", next->Binding->Command.Type);
 
+    // command can grab the keyboard itself (menus, move, ...)
+    KeyboardSequenceLeave();
+    MenuCommandExecute(&next->Binding->Command, event->root_x,
+	event->root_y, ClientGetActive());
+    if (next->Binding->Modal && node != &KeyboardRoot) {
+	KeyboardSequenceEnter(node);
+    }
     // alert
     //xcb_bell(Connection, 100);
 }
 
+/**
+**	Timeout active key sequence.
+**
+**	@param tick	current tick in ms
+**	@param x	current mouse x-coordinate
+**	@param y	current mouse y-coordinate
+*/
+void KeyboardTimeout(uint32_t tick, int __attribute__((unused)) x, int
+    __attribute__((unused)) y)
+{
+    if (KeyboardState
+	&& (int32_t) (tick - KeyboardStateTick) >= KeyboardSequenceTimeout) {
+	Debug(3, "key sequence timeout\n");
+	KeyboardSequenceLeave();
+    }
+}
+
 // ------------------------------------------------------------------------ //
 
 /**
-**	Initialize the keyboard module.
+**	Read modifier mapping and find the lock masks.
+**
+**	@param cookie	cookie of get modifier mapping request
 */
-void KeyboardInit(void)
+static void KeyboardModifierMapping(xcb_get_modifier_mapping_cookie_t cookie)
 {
-    xcb_get_modifier_mapping_cookie_t cookie;
     xcb_get_modifier_mapping_reply_t *reply;
     xcb_keycode_t *modmap;
     xcb_keycode_t *num_lock;
@@ -344,13 +582,6 @@ void KeyboardInit(void)
     xcb_keycode_t *caps_lock;
     xcb_keycode_t *mode_switch;
 
-    cookie = xcb_get_modifier_mapping_unchecked(Connection);
-
-    XcbKeySymbols = xcb_key_symbols_alloc(Connection);
-    if (!XcbKeySymbols) {
-	Error("Can't read key symbols\n");
-	return;
-    }
     //
     //	find lock mask for NUM-LOCK, SHIFT-LOCK, CAPS-LOCK, MODE-SWITCH
     //
@@ -361,7 +592,7 @@ void KeyboardInit(void)
 
     NumLockMask = ShiftLockMask = CapsLockMask = ModeSwitchMask = 0;
 
-    reply = xcb_get_modifier_mapping_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_modifier_mapping_reply, cookie, NULL);
     if (reply) {
 	int i;
 	int j;
@@ -419,12 +650,65 @@ void KeyboardInit(void)
     }
     Debug(3, "xcb mod mask lock: %d\n", XCB_MOD_MASK_LOCK);
 
+    // mode-switch selects the keysym group, it isn't a lock
+    KeyboardIgnoreMask =
+	(XCB_MOD_MASK_LOCK | NumLockMask | ShiftLockMask | CapsLockMask)
+	& KEYBOARD_MODIFIER_MASK;
+
     free(num_lock);
     free(shift_lock);
     free(caps_lock);
     free(mode_switch);
 }
 
+/**
+**	Handle keyboard mapping change.
+**
+**	Refresh keyboard symbols, rebuild keycode map and regrab the key
+**	bindings on all managed clients.
+**
+**	@param event	mapping notify event
+*/
+void KeyboardHandleMappingNotify(xcb_mapping_notify_event_t * event)
+{
+    Client *client;
+
+    if (!XcbKeySymbols || event->request == XCB_MAPPING_POINTER) {
+	return;
+    }
+    Debug(3, "keyboard mapping changed %d\n", event->request);
+
+    KeyboardSequenceLeave();
+    xcb_refresh_keyboard_mapping(XcbKeySymbols, event);
+    KeyboardModifierMapping(xcb_get_modifier_mapping_unchecked(Connection));
+    KeyboardBuildKeycodeMap();
+
+    SLIST_FOREACH(client, &ClientNetList, NetClient) {
+	xcb_ungrab_key(Connection, XCB_GRAB_ANY, client->Window,
+	    XCB_MOD_MASK_ANY);
+	KeyboardGrabBindings(client);
+    }
+}
+
+/**
+**	Initialize the keyboard module.
+*/
+void KeyboardInit(void)
+{
+    xcb_get_modifier_mapping_cookie_t cookie;
+
+    cookie = xcb_get_modifier_mapping_unchecked(Connection);
+
+    XcbKeySymbols = xcb_key_symbols_alloc(Connection);
+    if (!XcbKeySymbols) {
+	Error("Can't read key symbols\n");
+	return;
+    }
+
+    KeyboardModifierMapping(cookie);
+    KeyboardBuildKeycodeMap();
+}
+
 /**
 **	Cleanup the keyboard module.
 */
@@ -435,6 +719,9 @@ void KeyboardExit(void)
     xcb_key_symbols_free(XcbKeySymbols);
     XcbKeySymbols = NULL;
 
+    KeyboardSequenceLeave();
+    KeyboardNodeFree(&KeyboardRoot);
+
     //
     //	free memory used by keyboard bindings
     //
@@ -514,14 +801,13 @@ static void KeyboardBindingConfig(const ConfigObject * binding)
     const ConfigObject *index;
     const ConfigObject *value;
     int keyn;
-    KeyboardKey key;
+    KeyboardKey keys[KEYBOARD_SEQUENCE_MAX];
     MenuCommand command;
 
-    NO_WARNING(key);
     keyn = 0;
 
     //
-    //	array of keys
+    //	array of keys, multiple key lists are a key sequence
     //
     index = NULL;
     value = ConfigArrayFirstFixedKey(binding, &index);
@@ -529,8 +815,11 @@ static void KeyboardBindingConfig(const ConfigObject * binding)
 	const ConfigObject *aval;
 
 	if (ConfigCheckArray(value, &aval)) {
-	    KeyboardKeylistConfig(aval, &key);
-	    ++keyn;
+	    if (keyn < KEYBOARD_SEQUENCE_MAX) {
+		KeyboardKeylistConfig(aval, &keys[keyn++]);
+	    } else {
+		Warning("key sequence too long, key list ignored\n");
+	    }
 	} else {
 	    Warning("value in key-binding ignored\n");
 	}
@@ -538,8 +827,6 @@ static void KeyboardBindingConfig(const ConfigObject * binding)
     }
     if (!keyn) {
 	Warning("no key list given\n");
-    } else if (keyn != 1) {
-	Warning("only single key list support\n");
     }
     //
     //	parse command of key list
@@ -552,7 +839,11 @@ static void KeyboardBindingConfig(const ConfigObject * binding)
     KeyboardBindings =
 	realloc(KeyboardBindings,
 	(KeyboardBindingN + 1) * sizeof(*KeyboardBindings));
-    KeyboardBindings[KeyboardBindingN].Key = key;
+    memcpy(KeyboardBindings[KeyboardBindingN].Keys, keys,
+	keyn * sizeof(*keys));
+    KeyboardBindings[KeyboardBindingN].KeyN = keyn;
+    KeyboardBindings[KeyboardBindingN].Modal =
+	ConfigStringsGetBoolean(binding, "modal", NULL) > 0;
     KeyboardBindings[KeyboardBindingN].Command = command;
     ++KeyboardBindingN;
 }
@@ -565,6 +856,18 @@ static void KeyboardBindingConfig(const ConfigObject * binding)
 void KeyboardConfig(const Config * config)
 {
     const ConfigObject *array;
+    ssize_t ival;
+
+    KeyboardSequenceTimeout = KEYBOARD_DEFAULT_TIMEOUT;
+    if (ConfigStringsGetInteger(ConfigDict(config), &ival, "key-sequence",
+	    "timeout", NULL)) {
+	if (KEYBOARD_MINIMAL_TIMEOUT <= ival
+	    && ival <= KEYBOARD_MAXIMAL_TIMEOUT) {
+	    KeyboardSequenceTimeout = ival;
+	} else {
+	    Warning("key-sequence timeout %zd out of range\n", ival);
+	}
+    }
 
     if (ConfigStringsGetArray(ConfigDict(config), &array, "key-binding", NULL)) {
 	const ConfigObject *index;
@@ -47,9 +47,15 @@ extern xcb_keysym_t KeyboardGet(xcb_keycode_t, unsigned);
     /// Grab our key bindings on client window.
 extern void KeyboardGrabBindings(Client *);
 
+    /// Handle keyboard mapping change.
+extern void KeyboardHandleMappingNotify(xcb_mapping_notify_event_t *);
+
     /// Key pressed or released.
 extern void KeyboardHandler(int, const xcb_key_press_event_t *);
 
+    /// Timeout active key sequence.
+extern void KeyboardTimeout(uint32_t, int, int);
+
     /// Initialize the keyboard module.
 extern void KeyboardInit(void);
 
@@ -42,8 +42,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <dirent.h>
+#ifdef USE_MENU_DIR
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#endif
 
 #include <xcb/xcb_event.h>
 #include <xcb/xcb_icccm.h>
@@ -985,18 +991,34 @@ struct _runtime_
     Menu *Menu;				///< static menu data
 
     xcb_window_t Window;		///< menu window
+    xcb_drawable_t Drawable;		///< destination of menu drawing
+    xcb_pixmap_t Pixmap;		///< pre-rendered menu (or none)
+    unsigned InUse:1;			///< runtime is prepared for show
     Runtime *Parent;			///< the parent menu (NULL for none)
     int16_t ParentOffset;		///< y-offset of this menu wrt parent
     int16_t X;				///< x-coordinate of the menu
     int16_t Y;				///< y-coordinate of the menu
     uint16_t Width;			///< width of the menu
-    uint16_t Height;			///< height of the menu
+    uint16_t Height;			///< height of the menu window
+    int32_t TotalHeight;		///< height of all menu items
+    int32_t ScrollY;			///< y-offset of visible menu part
     int16_t TextOffset;			///< x-offset of text in the menu
     uint8_t ItemHeight;			///< menu item height
 
     int16_t CurrentIndex;		///< current menu selection
     int16_t LastIndex;			///< last menu selection
 
+#ifdef USE_MENU_FILTER
+    Menu *Unfiltered;			///< original menu while filtering
+    xcb_pixmap_t UnfilteredPixmap;	///< original pre-rendered menu
+    uint16_t UnfilteredHeight;		///< original height of menu window
+    int32_t UnfilteredTotalHeight;	///< original height of all items
+    int *Matches;			///< index entries matching filter
+    int MatchN;				///< number of matching entries
+    uint8_t FilterLen;			///< length of filter text
+    char Filter[MENU_FILTER_MAX + 1];	///< lower case filter text
+#endif
+
     // FIXME: int16_t OffsetY[1];	///< y-offset of menu item
 };
 
@@ -1013,6 +1035,9 @@ struct _menu_
 
     int16_t ItemCount;			///< number of menu items in table
     MenuItem **ItemTable;		///< menu item table
+
+    uint8_t Cached;			///< keep layout and pre-rendered menu
+    Runtime *Runtime;			///< cached layout of menu
 };
 
 int MenuShown;				///< flag menu is shown
@@ -1050,10 +1075,18 @@ static const uint8_t MenuSubmenuArrowBitmap[SUB_MENU_ARROW_HEIGHT] = {
 
 static int WindowMenuUserHeight;
 
+static void MenuDraw(const Runtime *);
 static Runtime *MenuPrepareRuntime(Menu *);
 static void MenuCleanupRuntime(Runtime *);
 static int MenuExecuteRuntime(Runtime *, Runtime *, int, int);
 
+#ifdef USE_MENU_FILTER
+static int MenuFilterHandleKey(Runtime *, const xcb_key_press_event_t *,
+    xcb_keysym_t);
+static void MenuFilterReset(Runtime *);
+static void MenuFilterIndexDel(void);
+#endif
+
 static void MenuCommandPrepare(MenuCommand *);
 static void MenuCommandCleanup(MenuCommand *);
 static void MenuCommandCopy(MenuCommand *, const MenuCommand *);
@@ -1175,30 +1208,67 @@ static int MenuGetNextIndex(const Runtime * runtime)
 /**
 **	Get the item in the menu given a y-coordinate.
 **
+**	Item y-offsets are ascending, a binary search is used.
+**
 **	@param runtime	menu runtime
-**	@param y	y-coordinate to find index
+**	@param y	y-coordinate (in menu window) to find index
 **
 **	@returns the menu index under y, -1 if label, 0 if out of range.
 */
 static int MenuGetIndexByY(const Runtime * runtime, int y)
 {
-    int i;
+    const Menu *menu;
+    int lo;
+    int hi;
 
-    if (runtime->Menu->ItemCount) {	// none empty menu
-	if (y < runtime->Menu->ItemTable[0]->OffsetY) {
+    menu = runtime->Menu;
+    if (menu->ItemCount) {		// none empty menu
+	y += runtime->ScrollY;
+	if (y < menu->ItemTable[0]->OffsetY) {
 	    return -1;			// label
 	}
-	for (i = 0; i < runtime->Menu->ItemCount - 1; i++) {
-	    if (y >= runtime->Menu->ItemTable[i]->OffsetY
-		&& y < runtime->Menu->ItemTable[i + 1]->OffsetY) {
-		return i;
+	lo = 0;
+	hi = menu->ItemCount - 1;
+	while (lo < hi) {
+	    int i;
+
+	    i = (lo + hi + 1) / 2;
+	    if (y < menu->ItemTable[i]->OffsetY) {
+		hi = i - 1;
+	    } else {
+		lo = i;
 	    }
 	}
-	return i;			// last entry
+	return lo;
     }
     return 0;
 }
 
+/**
+**	Get the index of the item one page above or below in the menu.
+**
+**	@param runtime	menu runtime
+**	@param direction	-1 page up, 1 page down
+**
+**	@returns index of item one menu window height away, -1 if empty.
+*/
+static int MenuGetPageIndex(const Runtime * runtime, int direction)
+{
+    int i;
+    int y;
+
+    if (!runtime->Menu->ItemCount) {
+	return -1;
+    }
+    i = runtime->CurrentIndex >= 0 ? runtime->CurrentIndex : 0;
+    y = runtime->Menu->ItemTable[i]->OffsetY - runtime->ScrollY;
+    y += direction * (runtime->Height - runtime->ItemHeight);
+    if ((i = MenuGetIndexByY(runtime, y)) < 0) {
+	i = 0;
+    }
+    return i;
+}
+
 /**
 **	Set the active menu item.
 **
@@ -1208,36 +1278,41 @@ static int MenuGetIndexByY(const Runtime * runtime, int y)
 static void MenuSetPosition(Runtime * runtime, int index)
 {
     int y;
-    int updated;
 
-    // middle of menu item
-    y = runtime->Menu->ItemTable[index]->OffsetY + runtime->ItemHeight / 2;
+    // top of menu item
+    y = runtime->Menu->ItemTable[index]->OffsetY;
 
     //
     //	Menu bigger than screen, must scroll.
     //
-    if (runtime->Height >= XcbScreen->height_in_pixels) {
-	updated = 0;
-	while (runtime->Y + y < runtime->ItemHeight / 2) {
-	    runtime->Y += runtime->ItemHeight;
-	    updated = 1;
+    if (runtime->TotalHeight > runtime->Height) {
+	int scroll_y;
+
+	scroll_y = runtime->ScrollY;
+	if (y < scroll_y) {
+	    scroll_y = y;
 	}
-	while (runtime->Y + y > (int)XcbScreen->height_in_pixels) {
-	    runtime->Y -= runtime->ItemHeight;
-	    updated = -1;
+	if (y + runtime->ItemHeight > scroll_y + runtime->Height) {
+	    scroll_y = y + runtime->ItemHeight - runtime->Height;
 	}
-
-	// move window to have selected item visible
-	if (updated) {
-	    uint32_t values[1];
-
-	    values[0] = runtime->Y;
-	    xcb_configure_window(Connection, runtime->Window,
-		XCB_CONFIG_WINDOW_Y, values);
-	    // move out of scroll area
-	    y += updated;
+	if (scroll_y > runtime->TotalHeight - runtime->Height) {
+	    scroll_y = runtime->TotalHeight - runtime->Height;
+	}
+	if (scroll_y < 0) {
+	    scroll_y = 0;
+	}
+	// redraw visible page to have selected item visible
+	if (scroll_y != runtime->ScrollY) {
+	    runtime->ScrollY = scroll_y;
+	    runtime->CurrentIndex = index;
+	    runtime->LastIndex = index;
+	    xcb_clear_area(Connection, 0, runtime->Window, 0, 0, 0, 0);
+	    MenuDraw(runtime);
 	}
     }
+    // middle of menu item
+    y += runtime->ItemHeight / 2;
+    y -= runtime->ScrollY;
     // we need to do this twice so the event gets registered on the submenu,
     // if one exists.
     // FIXME: don't wrap x
@@ -1254,8 +1329,6 @@ static void MenuSetPosition(Runtime * runtime, int index)
 **	@param runtime	menu runtime to draw
 **	@param x	x-coordinate of menu
 **	@param y	y-coordinate of menu
-**
-**	@todo don't create window for all entries, if bigger than screen-size.
 */
 static void MenuCreateWindow(Runtime * runtime, int x, int y)
 {
@@ -1263,6 +1336,7 @@ static void MenuCreateWindow(Runtime * runtime, int x, int y)
 
     runtime->LastIndex = -1;
     runtime->CurrentIndex = -1;
+    runtime->ScrollY = 0;
 
     //
     //	 Check if menu fits on screen
@@ -1286,6 +1360,7 @@ static void MenuCreateWindow(Runtime * runtime, int x, int y)
     runtime->ParentOffset -= y;
 
     runtime->Window = xcb_generate_id(Connection);
+    runtime->Drawable = runtime->Window;
 
     values[0] = Colors.MenuBG.Pixel;
     values[1] = 1;
@@ -1327,13 +1402,13 @@ static void MenuDrawLabel(const Runtime * runtime)
     Label label;
 
     if (runtime->Menu->Label) {
-	LabelReset(&label, runtime->Window, RootGC);
+	LabelReset(&label, runtime->Drawable, RootGC);
 
 	label.Type = LABEL_MENU_LABEL;
 	label.Alignment = LABEL_ALIGN_CENTER;
 
 	label.X = MENU_INNER_SPACE;
-	label.Y = MENU_INNER_SPACE;
+	label.Y = MENU_INNER_SPACE - runtime->ScrollY;
 	label.Width = runtime->Width - MENU_INNER_SPACE * 2 - 1;
 	label.Height = runtime->ItemHeight - MENU_INNER_SPACE;
 
@@ -1359,18 +1434,18 @@ static void MenuDrawArrow(const Runtime * runtime, const MenuItem * item,
     values[0] = pixel;
     values[1] = runtime->Width - SUB_MENU_ARROW_WIDTH - MENU_INNER_SPACE * 2;
     values[2] =
-	item->OffsetY + runtime->ItemHeight / 2 - SUB_MENU_ARROW_HEIGHT / 2;
+	item->OffsetY - runtime->ScrollY + runtime->ItemHeight / 2 -
+	SUB_MENU_ARROW_HEIGHT / 2;
     values[3] = MenuArrowPixmap;
     xcb_change_gc(Connection, RootGC,
 	XCB_GC_FOREGROUND | XCB_GC_CLIP_ORIGIN_X | XCB_GC_CLIP_ORIGIN_Y |
 	XCB_GC_CLIP_MASK, values);
 
     rectangle.x = runtime->Width - SUB_MENU_ARROW_WIDTH - MENU_INNER_SPACE * 2;
-    rectangle.y =
-	item->OffsetY + runtime->ItemHeight / 2 - SUB_MENU_ARROW_HEIGHT / 2;
+    rectangle.y = values[2];
     rectangle.width = SUB_MENU_ARROW_WIDTH;
     rectangle.height = SUB_MENU_ARROW_HEIGHT;
-    xcb_poly_fill_rectangle(Connection, runtime->Window, RootGC, 1,
+    xcb_poly_fill_rectangle(Connection, runtime->Drawable, RootGC, 1,
 	&rectangle);
 
     values[0] = XCB_NONE;
@@ -1389,13 +1464,13 @@ static void MenuDrawItemLabel(const Runtime * runtime, const MenuItem * item,
 {
     Label label;
 
-    LabelReset(&label, runtime->Window, RootGC);
+    LabelReset(&label, runtime->Drawable, RootGC);
 
     label.Type = type;
 
     label.TextOffset = runtime->TextOffset;
     label.X = MENU_INNER_SPACE;
-    label.Y = item->OffsetY;
+    label.Y = item->OffsetY - runtime->ScrollY;
     label.Width = runtime->Width - MENU_INNER_SPACE * 2 - 1;
     label.Height = runtime->ItemHeight;
 
@@ -1433,21 +1508,23 @@ static void MenuDrawItem(const Runtime * runtime, const MenuItem * item)
 	}
     } else {				// separator
 	xcb_point_t points[2];
+	int y;
 
+	y = item->OffsetY - runtime->ScrollY + MENU_INNER_SPACE;
 	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
 	    &Colors.MenuDown.Pixel);
 	points[0].x = MENU_INNER_SPACE * 2;
 	points[1].x = runtime->Width - MENU_INNER_SPACE * 4;
-	points[0].y = item->OffsetY + MENU_INNER_SPACE;
-	points[1].y = item->OffsetY + MENU_INNER_SPACE;
-	xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Window,
+	points[0].y = y;
+	points[1].y = y;
+	xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Drawable,
 	    RootGC, 2, points);
 
 	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
 	    &Colors.MenuUp.Pixel);
-	points[0].y = item->OffsetY + MENU_INNER_SPACE + 1;
-	points[1].y = item->OffsetY + MENU_INNER_SPACE + 1;
-	xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Window,
+	points[0].y = y + 1;
+	points[1].y = y + 1;
+	xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Drawable,
 	    RootGC, 2, points);
     }
 }
@@ -1488,28 +1565,42 @@ static void MenuUpdate(const Runtime * runtime)
 {
     // clear the old selection
     if (runtime->LastIndex >= 0) {
-	MenuDrawItem(runtime, MenuGetItem(runtime, runtime->LastIndex));
+	if (runtime->Pixmap) {		// restore pre-rendered item
+	    const MenuItem *item;
+
+	    item = MenuGetItem(runtime, runtime->LastIndex);
+	    xcb_copy_area(Connection, runtime->Pixmap, runtime->Window,
+		RootGC, 0, item->OffsetY, 0, item->OffsetY, runtime->Width,
+		runtime->ItemHeight);
+	} else {
+	    MenuDrawItem(runtime, MenuGetItem(runtime, runtime->LastIndex));
+	}
     }
     // highlight the new selection
     MenuDrawSelectedItem(runtime, MenuGetItem(runtime, runtime->CurrentIndex));
 }
 
 /**
-**	Draw a menu.
+**	Render a menu to its current drawable.
 **
-**	@param runtime	menu runtime to draw
+**	Only the items in the visible page of the menu window are drawn.
+**
+**	@param runtime	menu runtime to render
 */
-static void MenuDraw(const Runtime * runtime)
+static void MenuRender(const Runtime * runtime)
 {
     int i;
     xcb_point_t points[3];
     const Menu *menu;
 
     menu = runtime->Menu;
-    if (menu->Label) {
+    if (menu->Label && runtime->ScrollY < runtime->ItemHeight) {
 	MenuDrawLabel(runtime);
     }
-    for (i = 0; i < menu->ItemCount; ++i) {
+    for (i = runtime->ScrollY ? MenuGetIndexByY(runtime, 0) : 0;
+	i >= 0 && i < menu->ItemCount
+	&& menu->ItemTable[i]->OffsetY < runtime->ScrollY + runtime->Height;
+	++i) {
 	if (i == runtime->CurrentIndex) {
 	    MenuDrawSelectedItem(runtime, menu->ItemTable[i]);
 	} else {
@@ -1527,7 +1618,7 @@ static void MenuDraw(const Runtime * runtime)
     points[1].y = 0;
     points[2].x = runtime->Width - 1;
     points[2].y = 0;
-    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Window, RootGC,
+    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Drawable, RootGC,
 	3, points);
     // FIXME: poly_segments better?
     points[0].x = 1;
@@ -1536,7 +1627,7 @@ static void MenuDraw(const Runtime * runtime)
     points[1].y = 1;
     points[2].x = runtime->Width - 2;
     points[2].y = 1;
-    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Window, RootGC,
+    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Drawable, RootGC,
 	3, points);
 
     xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
@@ -1547,7 +1638,7 @@ static void MenuDraw(const Runtime * runtime)
     points[1].y = runtime->Height - 1;
     points[2].x = runtime->Width - 1;
     points[2].y = 1;
-    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Window, RootGC,
+    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Drawable, RootGC,
 	3, points);
     points[0].x = 2;
     points[0].y = runtime->Height - 2;
@@ -1555,10 +1646,29 @@ static void MenuDraw(const Runtime * runtime)
     points[1].y = runtime->Height - 2;
     points[2].x = runtime->Width - 2;
     points[2].y = 2;
-    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Window, RootGC,
+    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, runtime->Drawable, RootGC,
 	3, points);
 }
 
+/**
+**	Draw a menu.
+**
+**	A pre-rendered menu is only copied and the selection drawn on top.
+**
+**	@param runtime	menu runtime to draw
+*/
+static void MenuDraw(const Runtime * runtime)
+{
+    if (runtime->Pixmap) {
+	xcb_copy_area(Connection, runtime->Pixmap, runtime->Window, RootGC, 0,
+	    0, 0, 0, runtime->Width, runtime->Height);
+	MenuDrawSelectedItem(runtime, MenuGetItem(runtime,
+		runtime->CurrentIndex));
+	return;
+    }
+    MenuRender(runtime);
+}
+
 /**
 **	Draw a menu and all its parents.
 **
@@ -1591,6 +1701,14 @@ static int MenuHandleKey(Runtime * runtime,
 {
     int i;
     Runtime *parent;
+    xcb_keysym_t keysym;
+
+    keysym = KeyboardGet(event->detail, event->state);
+#ifdef USE_MENU_FILTER
+    if (MenuFilterHandleKey(runtime, event, keysym)) {
+	return 0;
+    }
+#endif
 
     if (runtime->CurrentIndex >= 0 || !runtime->Parent) {
 	parent = runtime;
@@ -1599,7 +1717,7 @@ static int MenuHandleKey(Runtime * runtime,
     }
 
     i = -1;
-    switch (KeyboardGet(event->detail, event->state)) {
+    switch (keysym) {
 	case XK_Up:			// select previous menu item
 	    i = MenuGetPreviousIndex(parent);
 	    break;
@@ -1620,6 +1738,18 @@ static int MenuHandleKey(Runtime * runtime,
 		}
 	    }
 	    break;
+	case XK_Prior:			// select item one page up
+	    i = MenuGetPageIndex(parent, -1);
+	    break;
+	case XK_Next:			// select item one page down
+	    i = MenuGetPageIndex(parent, 1);
+	    break;
+	case XK_Home:			// select first menu item
+	    i = 0;
+	    break;
+	case XK_End:			// select last menu item
+	    i = parent->Menu->ItemCount - 1;
+	    break;
 	case XK_Escape:		// leave menu without selection
 	    return -1;
 	case XK_Return:		// select menu item
@@ -1729,17 +1859,16 @@ int MenuHandleMotionNotify(Runtime * runtime,
 	runtime->CurrentIndex = -1;
     }
     // scroll the menu if needed
-    if (runtime->Height > XcbScreen->height_in_pixels
+    if (runtime->TotalHeight > runtime->Height
 	&& runtime->CurrentIndex >= 0) {
 	// if near the top, shift down
-	if (runtime->Y + y < runtime->ItemHeight / 2) {
+	if (y < runtime->ItemHeight / 2) {
 	    if (runtime->CurrentIndex > 0) {
 		MenuSetPosition(runtime, --runtime->CurrentIndex);
 	    }
 	}
 	// if near the bottom, shift up
-	if (runtime->Y + y + runtime->ItemHeight / 2 >
-	    (int)XcbScreen->height_in_pixels) {
+	if (y + runtime->ItemHeight / 2 > runtime->Height) {
 	    if (runtime->CurrentIndex + 1 < runtime->Menu->ItemCount) {
 		MenuSetPosition(runtime, ++runtime->CurrentIndex);
 	    }
@@ -1763,7 +1892,7 @@ int MenuHandleMotionNotify(Runtime * runtime,
 	    status =
 		MenuExecuteRuntime(submenu, runtime,
 		runtime->X + runtime->Width,
-		runtime->Y +
+		runtime->Y - runtime->ScrollY +
 		runtime->Menu->ItemTable[runtime->CurrentIndex]->OffsetY);
 	    MenuCleanupRuntime(submenu);
 	    MenuCommandCleanup(&item->Command);
@@ -1911,9 +2040,57 @@ static int MenuLoop(Runtime * runtime)
 // ------------------------------------------------------------------------ //
 // Runtime
 
+/**
+**	Pre-render menu into pixmap.
+**
+**	Only menus which fit on the screen are pre-rendered, scrolled menus
+**	are drawn directly.
+**
+**	@param runtime	menu runtime with calculated layout
+*/
+static void MenuPrerender(Runtime * runtime)
+{
+    xcb_rectangle_t rectangle;
+
+    runtime->Pixmap = xcb_generate_id(Connection);
+    xcb_create_pixmap(Connection, XcbScreen->root_depth, runtime->Pixmap,
+	XcbScreen->root, runtime->Width, runtime->Height);
+
+    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	&Colors.MenuBG.Pixel);
+    rectangle.x = 0;
+    rectangle.y = 0;
+    rectangle.width = runtime->Width;
+    rectangle.height = runtime->Height;
+    xcb_poly_fill_rectangle(Connection, runtime->Pixmap, RootGC, 1,
+	&rectangle);
+
+    runtime->CurrentIndex = -1;
+    runtime->Drawable = runtime->Pixmap;
+    MenuRender(runtime);
+}
+
+/**
+**	Delete menu runtime.
+**
+**	@param runtime	menu runtime to free
+*/
+static void MenuRuntimeDel(Runtime * runtime)
+{
+    if (runtime->Pixmap) {
+	xcb_free_pixmap(Connection, runtime->Pixmap);
+    }
+    free(runtime);
+}
+
 /**
 **	Prepare menu to be shown.
 **
+**	For cached menus (config and directory menus), the calculated layout
+**	and pre-rendered pixmap are kept in the menu, until the menu is
+**	deleted.  Menus are recreated on config or font changes.  One-shot
+**	menus are drawn directly.
+**
 **	@param menu	static menu data
 **
 **	@returns runtime structure for menu.
@@ -1935,8 +2112,18 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
     }
 #endif
 
+    // use cached layout, if not already shown
+    if ((runtime = menu->Runtime) && !runtime->InUse) {
+	runtime->InUse = 1;
+	return runtime;
+    }
+
     runtime = calloc(1, sizeof(*runtime));
     runtime->Menu = menu;
+    runtime->InUse = 1;
+    if (menu->Cached && !menu->Runtime) {
+	menu->Runtime = runtime;
+    }
     // FIXME: y-offsets
 
     // send label size request
@@ -2013,7 +2200,7 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
     //
     //	Calculate menu size
     //
-    runtime->Height = LABEL_BORDER;
+    runtime->TotalHeight = LABEL_BORDER;
     runtime->Width = LABEL_BORDER + SUB_MENU_ARROW_WIDTH;
     if (menu->Label) {
 	unsigned width;
@@ -2022,10 +2209,14 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
 	if (width > runtime->Width) {
 	    runtime->Width = width;
 	}
-	runtime->Height += runtime->ItemHeight;
+	runtime->TotalHeight += runtime->ItemHeight;
     }
     // nothing else to do, if there is nothing in the menu.
     if (!menu->ItemCount) {
+	runtime->Height = runtime->TotalHeight;
+	if (runtime == menu->Runtime) {
+	    MenuPrerender(runtime);
+	}
 	return runtime;
     }
     //
@@ -2036,7 +2227,7 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
 	MenuItem *item;
 
 	item = menu->ItemTable[i];
-	item->OffsetY = runtime->Height;
+	item->OffsetY = runtime->TotalHeight;
 	if (item->Text && (!item->IconOrText || !item->Icon)) {
 	    unsigned width;
 
@@ -2044,13 +2235,13 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
 	    if (width > runtime->Width) {
 		runtime->Width = width;
 	    }
-	    runtime->Height += runtime->ItemHeight;
+	    runtime->TotalHeight += runtime->ItemHeight;
 #ifdef USE_ICON
 	} else if (item->Icon) {
-	    runtime->Height += runtime->ItemHeight;
+	    runtime->TotalHeight += runtime->ItemHeight;
 #endif
 	} else {			// separator
-	    runtime->Height += MENU_SEPARATOR_HEIGHT;
+	    runtime->TotalHeight += MENU_SEPARATOR_HEIGHT;
 	}
 
 	if (item->Command.Type >= MENU_ACTION_SUBMENU) {
@@ -2066,7 +2257,15 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
     runtime->Width +=
 	MENU_INNER_SPACE * 2 + LABEL_BORDER * 2 + LABEL_INNER_SPACE * 2 +
 	submenu_offset;
-    runtime->Height += MENU_INNER_SPACE * 2;
+    runtime->TotalHeight += MENU_INNER_SPACE * 2;
+
+    // window is never bigger than the screen, rest is scrolled in
+    runtime->Height = runtime->TotalHeight;
+    if (runtime->TotalHeight > XcbScreen->height_in_pixels) {
+	runtime->Height = XcbScreen->height_in_pixels;
+    } else if (runtime == menu->Runtime) {	// only reused runtimes
+	MenuPrerender(runtime);
+    }
 
     return runtime;
 }
@@ -2078,7 +2277,11 @@ static Runtime *MenuPrepareRuntime(Menu * menu)
 */
 static void MenuCleanupRuntime(Runtime * runtime)
 {
-    free(runtime);
+    if (runtime == runtime->Menu->Runtime) {	// keep cached layout
+	runtime->InUse = 0;
+	return;
+    }
+    MenuRuntimeDel(runtime);
 }
 
 /**
@@ -2102,6 +2305,9 @@ static int MenuExecuteRuntime(Runtime * runtime, Runtime * parent, int x,
 
     ++MenuShown;
     status = MenuLoop(runtime);
+#ifdef USE_MENU_FILTER
+    MenuFilterReset(runtime);
+#endif
     --MenuShown;
 
     MenuDestroyWindow(runtime);
@@ -2238,8 +2444,9 @@ static void MenuCommandPrepare(MenuCommand * command)
 #ifdef USE_MENU_DIR
 	case MENU_ACTION_DIR:
 	    if ((submenu = RootMenuFromDirectory(command->String))) {
+		// path is overwritten by sub-menu, cache has its own copy
+		free(command->String);
 		command->Submenu = submenu;
-		// @warning path is overwritten by sub-menu!
 		command->Type = MENU_ACTION_DIR_PREPARED;
 	    }
 	    break;
@@ -2270,9 +2477,8 @@ static void MenuCommandCleanup(MenuCommand * command)
 	    command->Submenu = NULL;
 	    break;
 	case MENU_ACTION_DIR_PREPARED:
-	    path = command->Submenu->Label;
-	    command->Submenu->Label = NULL;
-	    MenuDel(command->Submenu);
+	    // sub-menu is owned by directory cache, restore path from label
+	    path = strdup(command->Submenu->Label);
 	    command->Type = MENU_ACTION_DIR;
 	    command->String = path;
 	    break;
@@ -2479,10 +2685,11 @@ void MenuCommandDel(MenuCommand * command)
 	case MENU_ACTION_SENDTO:
 	case MENU_ACTION_LAYER:
 	case MENU_ACTION_TILE:
-	case MENU_ACTION_DIR_PREPARED:
 	    if (command->Submenu) {
 		MenuDel(command->Submenu);
 	    }
+	    break;
+	case MENU_ACTION_DIR_PREPARED:	// owned by directory cache
 	default:
 	    break;
     }
@@ -2646,6 +2853,9 @@ void MenuDel(Menu * menu)
 	}
 	free(menu->ItemTable);
 	free(menu->Label);
+	if (menu->Runtime) {
+	    MenuRuntimeDel(menu->Runtime);
+	}
 	free(menu);
     }
 }
@@ -2980,6 +3190,7 @@ static Menu *MenuConfigMenu(const ConfigObject * array)
     const ConfigObject *value;
 
     menu = MenuNew();
+    menu->Cached = 1;
 
     if (ConfigStringsGetString(array, &sval, "label", NULL)) {
 	menu->Label = MenuStrdup(menu, sval);
@@ -3155,40 +3366,88 @@ void RootMenuHandleButtonPress(const xcb_button_press_event_t * event)
 #ifdef USE_MENU_DIR
 
 /**
-**	Build menu from directory.
-**
-**	@param path	directory path
-**
-**	@returns submenu for directory, NULL if failure.
+**	Cached directory menu.
+*/
+typedef struct _menu_dir_ MenuDir;
+
+/**
+**	Cached directory menu structure.
+*/
+struct _menu_dir_
+{
+    TAILQ_ENTRY(_menu_dir_) Next;	///< LRU list, most recent first
+
+    Menu *Menu;				///< menu, label is the path
+    time_t MTime;			///< modification time of directory
+    int Watch;				///< inotify watch descriptor
+    unsigned Dirty:1;			///< directory changed, must rescan
+};
+
+    /// directory menu cache head structure
+TAILQ_HEAD(_menu_dir_head_, _menu_dir_);
+
+    /// cached directory menus
+static struct _menu_dir_head_ MenuDirs = TAILQ_HEAD_INITIALIZER(MenuDirs);
+static int MenuDirN;			///< number of cached directory menus
+static int MenuDirInotify = -1;		///< inotify file descriptor
+
+/**
+**	(Re-)scan directory of cached directory menu.
 **
-**	@todo FIXME: disable directoy support / write documentation
+**	@param dir	cached directory menu
+**	@param name	expanded path of directory
 */
-Menu *RootMenuFromDirectory(char *path)
+static void MenuDirScan(MenuDir * dir, const char *name)
 {
     struct dirent **namelist;
+    Menu *menu;
+    const char *path;
     int n;
-    Menu *submenu;
-    char *name;
+    int i;
 
-    submenu = MenuNew();
-    submenu->Label = path;		// ugly hack save path in label
-    //submenu->UserHeight = WindowMenuUserHeight;
-    name = ExpandPath(path);
+    // replace old items, cached layout is invalid
+    menu = dir->Menu;
+#ifdef USE_MENU_FILTER
+    MenuFilterIndexDel();
+#endif
+    if (menu->Runtime) {
+	// shown layout is no longer cached and freed by cleanup
+	if (!menu->Runtime->InUse) {
+	    MenuRuntimeDel(menu->Runtime);
+	}
+	menu->Runtime = NULL;
+    }
+    for (i = 0; i < menu->ItemCount; ++i) {
+	MenuDelItem(menu->ItemTable[i]);
+    }
+    free(menu->ItemTable);
+    menu->ItemTable = NULL;
+    menu->ItemCount = 0;
+    dir->Dirty = 0;
+
+    if (MenuDirInotify >= 0 && dir->Watch < 0) {
+	dir->Watch =
+	    inotify_add_watch(MenuDirInotify, name,
+	    IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+	    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    }
+
+    path = menu->Label;
     n = scandir(name, &namelist, NULL, alphasort);
-    free(name);
     if (n > 0) {
-	int i;
 	int path_len;
 
 	path_len = strlen(path);
 	if (path[path_len - 1] == '/') {	// remove trailing slash
 	    --path_len;
 	}
+	// big directories: allocate table once, instead of item by item
+	menu->ItemTable = malloc(n * sizeof(*menu->ItemTable));
 
 	for (i = 0; i < n; ++i) {
 	    MenuItem *item;
 
-	    if (strcmp(namelist[i]->d_name, ".")
+	    if (menu->ItemCount < INT16_MAX && strcmp(namelist[i]->d_name, ".")
 		&& strcmp(namelist[i]->d_name, "..")) {
 		char *s;
 
@@ -3205,19 +3464,598 @@ Menu *RootMenuFromDirectory(char *path)
 		    s[path_len] = '/';
 		    strcpy(s + path_len + 1, item->Text);
 		}
-		MenuAppendItem(submenu, item);
+		menu->ItemTable[menu->ItemCount++] = item;
 	    }
 	    free(namelist[i]);
 	}
 	free(namelist);
     } else {
-	MenuAppendItem(submenu, MenuNewItem(NULL, "empty or can't read"));
+	MenuAppendItem(menu, MenuNewItem(NULL, "empty or can't read"));
 	Warning("Can't scan dir '%s'\n", path);
     }
-    return submenu;
 }
 
+/**
+**	Delete cached directory menu.
+**
+**	@param dir	cached directory menu, already removed from list
+*/
+static void MenuDirDel(MenuDir * dir)
+{
+    if (dir->Watch >= 0) {
+	inotify_rm_watch(MenuDirInotify, dir->Watch);
+    }
+    MenuDel(dir->Menu);
+    free(dir);
+    --MenuDirN;
+#ifdef USE_MENU_FILTER
+    MenuFilterIndexDel();
 #endif
+}
+
+/**
+**	Build menu from directory.
+**
+**	The menus are cached and owned by the cache.  A directory is only
+**	scanned again, if its modification time changed or inotify reported
+**	a change.  While a menu is shown, the rescan is left to
+**	RootMenuTimeout().
+**
+**	@param path	directory path
+**
+**	@returns submenu for directory, NULL if failure.
+*/
+Menu *RootMenuFromDirectory(const char *path)
+{
+    MenuDir *dir;
+    char *name;
+    struct stat st;
+    int scanned;
+
+    name = ExpandPath(path);
+    if (stat(name, &st) < 0) {
+	st.st_mtime = 0;
+    }
+
+    TAILQ_FOREACH(dir, &MenuDirs, Next) {
+	if (!strcmp(dir->Menu->Label, path)) {
+	    break;
+	}
+    }
+    scanned = dir != NULL;
+    if (dir) {				// move to front of LRU list
+	TAILQ_REMOVE(&MenuDirs, dir, Next);
+    } else {
+	dir = calloc(1, sizeof(*dir));
+	dir->Menu = MenuNew();
+	dir->Menu->Cached = 1;
+	dir->Menu->Label = strdup(path);	// ugly hack save path in label
+	dir->Watch = -1;
+	dir->Dirty = 1;
+	++MenuDirN;
+    }
+    TAILQ_INSERT_HEAD(&MenuDirs, dir, Next);
+
+    if (dir->Dirty || dir->MTime != st.st_mtime) {
+	// shown menus could use the items, rescanned by timeout
+	if (scanned && (MenuShown || (dir->Menu->Runtime
+		    && dir->Menu->Runtime->InUse))) {
+	    dir->Dirty = 1;
+	} else {
+	    Debug(3, "scanning dir '%s'\n", name);
+	    dir->MTime = st.st_mtime;
+	    MenuDirScan(dir, name);
+	}
+    }
+    free(name);
+
+    return dir->Menu;
+}
+
+/**
+**	Timeout for directory menu cache.
+**
+**	Collects inotify changes, drops the least recently used menus and
+**	rescans one changed directory in the background.  Nothing is changed
+**	while a menu is shown, the cached menus could be in use.
+**
+**	@param tick	current tick in ms
+**	@param x	current mouse x-coordinate
+**	@param y	current mouse y-coordinate
+*/
+void RootMenuTimeout(uint32_t __attribute__((unused)) tick,
+    int __attribute__((unused)) x, int __attribute__((unused)) y)
+{
+    MenuDir *dir;
+
+    if (MenuDirInotify >= 0) {
+	char buf[4096]
+	    __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t n;
+
+	while ((n = read(MenuDirInotify, buf, sizeof(buf))) > 0) {
+	    const char *p;
+
+	    for (p = buf; p < buf + n;) {
+		const struct inotify_event *event;
+
+		event = (const struct inotify_event *)p;
+		TAILQ_FOREACH(dir, &MenuDirs, Next) {
+		    if (dir->Watch == event->wd) {
+			dir->Dirty = 1;
+			if (event->mask & IN_IGNORED) {
+			    dir->Watch = -1;	// watch removed
+			}
+		    }
+		}
+		p += sizeof(*event) + event->len;
+	    }
+	}
+    }
+    if (MenuShown) {
+	return;
+    }
+
+    while (MenuDirN > MENU_DIR_CACHE_SIZE) {
+	dir = TAILQ_LAST(&MenuDirs, _menu_dir_head_);
+	TAILQ_REMOVE(&MenuDirs, dir, Next);
+	MenuDirDel(dir);
+    }
+
+    TAILQ_FOREACH(dir, &MenuDirs, Next) {
+	if (dir->Dirty) {
+	    char *name;
+	    struct stat st;
+
+	    name = ExpandPath(dir->Menu->Label);
+	    Debug(3, "rescanning dir '%s'\n", name);
+	    if (stat(name, &st) < 0) {
+		st.st_mtime = 0;
+	    }
+	    dir->MTime = st.st_mtime;
+	    MenuDirScan(dir, name);
+	    free(name);
+	    break;			// only one per timeout
+	}
+    }
+}
+
+#endif
+
+#ifdef USE_MENU_FILTER			// {
+
+// ------------------------------------------------------------------------ //
+// Filter
+
+/**
+**	Menu filter index entry.
+**
+**	Entries are copies, the indexed menus can change or be freed.
+*/
+typedef struct _menu_filter_entry_
+{
+    char *Text;				///< text shown for entry
+    char *Key;				///< lower case text and command
+    MenuCommand Command;		///< copy of command of menu item
+} MenuFilterEntry;
+
+/**
+**	Menu filter trigram posting list.
+*/
+typedef struct _menu_filter_posting_
+{
+    int N;				///< number of entries in list
+    int Max;				///< allocated entries of list
+    int *Entry;				///< ascending entry numbers
+} MenuFilterPosting;
+
+static MenuFilterEntry *MenuFilterEntries;	///< filter index entries
+static int MenuFilterEntryN;		///< number of filter index entries
+static Array *MenuFilterTrigrams;	///< trigram -> posting list
+
+/**
+**	Pack three characters into trigram key.
+*/
+#define MENU_FILTER_TRIGRAM(s) \
+    (((size_t)(uint8_t)(s)[0] << 16) | ((uint8_t)(s)[1] << 8) \
+	| (uint8_t)(s)[2])
+
+/**
+**	Add menu item to filter index.
+**
+**	@param text	text of menu item
+**	@param command	command of menu item
+*/
+static void MenuFilterAddEntry(const char *text, const MenuCommand * command)
+{
+    MenuFilterEntry *entry;
+    const char *string;
+    char *s;
+    int n;
+    int i;
+
+    n = MenuFilterEntryN++;
+    if (!(n & (n - 1))) {		// grow table by power of 2
+	MenuFilterEntries =
+	    realloc(MenuFilterEntries, (n ? n * 2 : 1) * sizeof(*entry));
+    }
+    entry = MenuFilterEntries + n;
+    entry->Text = strdup(text);
+    if (command->Type == MENU_ACTION_DIR_PREPARED) {
+	// sub-menu is only borrowed from directory cache
+	entry->Command.Type = MENU_ACTION_DIR;
+	entry->Command.String = strdup(command->Submenu->Label);
+    } else {
+	MenuCommandCopy(&entry->Command, command);
+    }
+
+    switch (entry->Command.Type) {
+	case MENU_ACTION_EXECUTE:
+	case MENU_ACTION_FILE:
+	case MENU_ACTION_DIR:
+	    string = entry->Command.String;
+	    break;
+	default:
+	    string = NULL;
+	    break;
+    }
+
+    //	key is "text\ncommand" in lower case
+    entry->Key = malloc(strlen(text) + (string ? strlen(string) + 1 : 0) + 1);
+    for (s = entry->Key; *text; ++text) {
+	*s++ = tolower((uint8_t) * text);
+    }
+    if (string) {
+	*s++ = '\n';
+	for (; *string; ++string) {
+	    *s++ = tolower((uint8_t) * string);
+	}
+    }
+    *s = '\0';
+
+    //	add entry to posting list of all its trigrams
+    for (i = 0; entry->Key[i] && entry->Key[i + 1] && entry->Key[i + 2];
+	++i) {
+	MenuFilterPosting *posting;
+	size_t key;
+
+	key = MENU_FILTER_TRIGRAM(entry->Key + i);
+	if (!(posting = (MenuFilterPosting *) ArrayGet(MenuFilterTrigrams,
+		    key))) {
+	    posting = calloc(1, sizeof(*posting));
+	    ArrayIns(&MenuFilterTrigrams, key, (size_t)posting);
+	}
+	if (posting->N && posting->Entry[posting->N - 1] == n) {
+	    continue;			// trigram repeated in same entry
+	}
+	if (posting->N == posting->Max) {
+	    posting->Max = posting->Max ? posting->Max * 2 : 4;
+	    posting->Entry =
+		realloc(posting->Entry, posting->Max * sizeof(int));
+	}
+	posting->Entry[posting->N++] = n;
+    }
+}
+
+/**
+**	Add all menu items of menu and its sub-menus to filter index.
+**
+**	@param menu	menu to add
+*/
+static void MenuFilterAddMenu(const Menu * menu)
+{
+    int i;
+
+    for (i = 0; i < menu->ItemCount; ++i) {
+	const MenuItem *item;
+
+	item = menu->ItemTable[i];
+	if (!item->Text) {		// separator or only icon
+	    continue;
+	}
+	if (item->Command.Type == MENU_ACTION_SUBMENU) {
+	    if (item->Command.Submenu) {
+		MenuFilterAddMenu(item->Command.Submenu);
+	    }
+	    continue;
+	}
+	MenuFilterAddEntry(item->Text, &item->Command);
+    }
+}
+
+/**
+**	Build filter index of all root menus and cached directory menus.
+*/
+static void MenuFilterIndexNew(void)
+{
+    int i;
+
+#ifdef USE_MENU_DIR
+    MenuDir *dir;
+#endif
+
+    MenuFilterTrigrams = ArrayNew();
+    for (i = 0; i < MenuN; ++i) {
+	if (Menus[i]) {
+	    MenuFilterAddMenu(Menus[i]);
+	}
+    }
+#ifdef USE_MENU_DIR
+    TAILQ_FOREACH(dir, &MenuDirs, Next) {
+	MenuFilterAddMenu(dir->Menu);
+    }
+#endif
+    Debug(3, "menu filter index with %d entries\n", MenuFilterEntryN);
+}
+
+/**
+**	Delete filter index.
+**
+**	Called if menus change, the index is rebuild on next use.
+*/
+static void MenuFilterIndexDel(void)
+{
+    size_t index;
+    size_t *value;
+    int i;
+
+    if (!MenuFilterTrigrams) {
+	return;
+    }
+    for (i = 0; i < MenuFilterEntryN; ++i) {
+	free(MenuFilterEntries[i].Text);
+	free(MenuFilterEntries[i].Key);
+	MenuCommandDel(&MenuFilterEntries[i].Command);
+    }
+    free(MenuFilterEntries);
+    MenuFilterEntries = NULL;
+    MenuFilterEntryN = 0;
+
+    index = 0;
+    value = ArrayFirst(MenuFilterTrigrams, &index);
+    while (value) {
+	MenuFilterPosting *posting;
+
+	posting = (MenuFilterPosting *) * value;
+	free(posting->Entry);
+	free(posting);
+	value = ArrayNext(MenuFilterTrigrams, &index);
+    }
+    ArrayFree(MenuFilterTrigrams);
+    MenuFilterTrigrams = NULL;
+}
+
+/**
+**	Search filter index.
+**
+**	A longer filter can only match a subset of the previous matches,
+**	these are searched incremental.  Otherwise the shortest posting list
+**	of the trigrams of the filter is searched.
+**
+**	@param runtime	menu runtime with filter text
+**	@param incremental	filter was extended, search only old matches
+*/
+static void MenuFilterSearch(Runtime * runtime, int incremental)
+{
+    const int *candidates;
+    int candidate_n;
+    int i;
+    int n;
+
+    if (!MenuFilterTrigrams) {		// build index on demand
+	MenuFilterIndexNew();
+	incremental = 0;
+    }
+
+    if (incremental) {			// only shrinks, reuse table
+	candidates = runtime->Matches;
+	candidate_n = runtime->MatchN;
+    } else {
+	free(runtime->Matches);
+	runtime->Matches = NULL;
+	runtime->MatchN = 0;
+
+	candidates = NULL;
+	candidate_n = MenuFilterEntryN;
+	for (i = 0; i + 2 < runtime->FilterLen; ++i) {
+	    const MenuFilterPosting *posting;
+
+	    posting = (const MenuFilterPosting *)
+		ArrayGet(MenuFilterTrigrams,
+		MENU_FILTER_TRIGRAM(runtime->Filter + i));
+	    if (!posting) {		// trigram unknown, nothing matches
+		candidate_n = 0;
+		break;
+	    }
+	    if (posting->N <= candidate_n) {
+		candidates = posting->Entry;
+		candidate_n = posting->N;
+	    }
+	}
+	runtime->Matches = malloc((candidate_n + 1) * sizeof(int));
+    }
+
+    for (n = i = 0; i < candidate_n; ++i) {
+	int e;
+
+	e = candidates ? candidates[i] : i;
+	if (strstr(MenuFilterEntries[e].Key, runtime->Filter)) {
+	    runtime->Matches[n++] = e;
+	}
+    }
+    runtime->MatchN = n;
+}
+
+/**
+**	Show filter matches in menu window.
+**
+**	Matches with filter as prefix are shown first.  The menu window is
+**	kept, only its height grows up to the screen.
+**
+**	@param runtime	menu runtime with filter matches
+*/
+static void MenuFilterShow(Runtime * runtime)
+{
+    Menu *menu;
+    int pass;
+    int i;
+    int y;
+    int height;
+
+    menu = MenuNew();
+    menu->Label = strdup(runtime->Filter);
+    i = runtime->MatchN < MENU_FILTER_RESULTS ? runtime->MatchN :
+	MENU_FILTER_RESULTS;
+    menu->ItemTable = malloc((i ? i : 1) * sizeof(*menu->ItemTable));
+
+    y = LABEL_BORDER + runtime->ItemHeight;
+    for (pass = 0; pass < 2; ++pass) {
+	for (i = 0; i < runtime->MatchN
+	    && menu->ItemCount < MENU_FILTER_RESULTS; ++i) {
+	    const MenuFilterEntry *entry;
+	    MenuItem *item;
+
+	    entry = MenuFilterEntries + runtime->Matches[i];
+	    // first pass prefix matches, second pass all others
+	    if (!strncmp(entry->Key, runtime->Filter,
+		    runtime->FilterLen) != !pass) {
+		continue;
+	    }
+	    item = MenuNewItem(NULL, entry->Text);
+	    MenuCommandCopy(&item->Command, &entry->Command);
+	    item->OffsetY = y;
+	    y += runtime->ItemHeight;
+	    menu->ItemTable[menu->ItemCount++] = item;
+	}
+    }
+
+    if (runtime->Unfiltered) {
+	MenuDel(runtime->Menu);
+    } else {				// save original menu
+	runtime->Unfiltered = runtime->Menu;
+	runtime->UnfilteredPixmap = runtime->Pixmap;
+	runtime->UnfilteredHeight = runtime->Height;
+	runtime->UnfilteredTotalHeight = runtime->TotalHeight;
+	runtime->Pixmap = XCB_NONE;
+    }
+    runtime->Menu = menu;
+    runtime->TotalHeight = y + MENU_INNER_SPACE * 2;
+
+    // resize window, never smaller than original menu
+    height = runtime->TotalHeight;
+    if (height < runtime->UnfilteredHeight) {
+	height = runtime->UnfilteredHeight;
+    }
+    if (height > XcbScreen->height_in_pixels - runtime->Y) {
+	height = XcbScreen->height_in_pixels - runtime->Y;
+    }
+    if (height != runtime->Height) {
+	uint32_t values[1];
+
+	runtime->Height = height;
+	values[0] = height;
+	xcb_configure_window(Connection, runtime->Window,
+	    XCB_CONFIG_WINDOW_HEIGHT, values);
+    }
+
+    runtime->ScrollY = 0;
+    runtime->CurrentIndex = menu->ItemCount ? 0 : -1;
+    runtime->LastIndex = runtime->CurrentIndex;
+    xcb_clear_area(Connection, 0, runtime->Window, 0, 0, 0, 0);
+    MenuDraw(runtime);
+}
+
+/**
+**	Leave filter mode and restore original menu.
+**
+**	@param runtime	menu runtime
+*/
+static void MenuFilterReset(Runtime * runtime)
+{
+    free(runtime->Matches);
+    runtime->Matches = NULL;
+    runtime->MatchN = 0;
+    runtime->FilterLen = 0;
+    runtime->Filter[0] = '\0';
+
+    if (!runtime->Unfiltered) {
+	return;
+    }
+    MenuDel(runtime->Menu);
+    runtime->Menu = runtime->Unfiltered;
+    runtime->Unfiltered = NULL;
+    runtime->Pixmap = runtime->UnfilteredPixmap;
+    runtime->TotalHeight = runtime->UnfilteredTotalHeight;
+    if (runtime->Height != runtime->UnfilteredHeight) {
+	uint32_t values[1];
+
+	runtime->Height = runtime->UnfilteredHeight;
+	values[0] = runtime->Height;
+	xcb_configure_window(Connection, runtime->Window,
+	    XCB_CONFIG_WINDOW_HEIGHT, values);
+    }
+    runtime->ScrollY = 0;
+    runtime->CurrentIndex = -1;
+    runtime->LastIndex = -1;
+}
+
+/**
+**	Handle key press for type-to-filter.
+**
+**	Printable characters extend the filter, backspace shortens it and
+**	escape leaves the filter mode.
+**
+**	@param runtime	menu runtime which got the key press
+**	@param event	x11 key press event
+**	@param keysym	keysym of key press
+**
+**	@returns true if key was used by filter.
+*/
+static int MenuFilterHandleKey(Runtime * runtime,
+    const xcb_key_press_event_t * event, xcb_keysym_t keysym)
+{
+    if (event->state & (XCB_MOD_MASK_CONTROL | XCB_MOD_MASK_1)) {
+	return 0;
+    }
+    switch (keysym) {
+	case XK_BackSpace:
+	    if (!runtime->FilterLen) {
+		return 0;
+	    }
+	    runtime->Filter[--runtime->FilterLen] = '\0';
+	    if (!runtime->FilterLen) {
+		break;
+	    }
+	    MenuFilterSearch(runtime, 0);
+	    MenuFilterShow(runtime);
+	    return 1;
+	case XK_Escape:
+	    if (!runtime->FilterLen) {
+		return 0;
+	    }
+	    break;
+	default:
+	    // ascii printable, space only inside of filter
+	    if (keysym < (runtime->FilterLen ? XK_space : XK_exclam)
+		|| keysym > XK_asciitilde
+		|| runtime->FilterLen == MENU_FILTER_MAX) {
+		return 0;
+	    }
+	    runtime->Filter[runtime->FilterLen++] = tolower(keysym);
+	    runtime->Filter[runtime->FilterLen] = '\0';
+	    MenuFilterSearch(runtime, runtime->FilterLen > 1);
+	    MenuFilterShow(runtime);
+	    return 1;
+    }
+
+    // leave filter mode
+    MenuFilterReset(runtime);
+    xcb_clear_area(Connection, 0, runtime->Window, 0, 0, 0, 0);
+    MenuDraw(runtime);
+    return 1;
+}
+
+#endif // } USE_MENU_FILTER
 
 // ------------------------------------------------------------------------ //
 
@@ -3230,6 +4068,12 @@ void RootMenuInit(void)
 	xcb_create_pixmap_from_bitmap_data(Connection, XcbScreen->root,
 	(uint8_t *) MenuSubmenuArrowBitmap, SUB_MENU_ARROW_WIDTH,
 	SUB_MENU_ARROW_HEIGHT, 1, 1, 0, NULL);
+#ifdef USE_MENU_DIR
+    MenuDirInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (MenuDirInotify < 0) {
+	Debug(2, "inotify not available, directory menus use mtime\n");
+    }
+#endif
 }
 
 /**
@@ -3247,8 +4091,25 @@ void RootMenuExit(void)
     MenuN = 0;
     MenuButtonDel(RootButtons);
     RootButtons = NULL;
+#ifdef USE_MENU_FILTER
+    MenuFilterIndexDel();
+#endif
     xcb_free_pixmap(Connection, MenuArrowPixmap);
     MenuArrowPixmap = XCB_NONE;
+
+#ifdef USE_MENU_DIR
+    while (!TAILQ_EMPTY(&MenuDirs)) {
+	MenuDir *dir;
+
+	dir = TAILQ_FIRST(&MenuDirs);
+	TAILQ_REMOVE(&MenuDirs, dir, Next);
+	MenuDirDel(dir);
+    }
+    if (MenuDirInotify >= 0) {
+	close(MenuDirInotify);
+	MenuDirInotify = -1;
+    }
+#endif
 }
 
 // ------------------------------------------------------------------------ //
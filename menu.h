@@ -289,7 +289,7 @@ struct _menu_item_
 #endif
     char *Text;				///< text to display (or NULL)
 
-    int16_t OffsetY;			///< y-offset of menu item
+    int32_t OffsetY;			///< y-offset of menu item
 #ifdef USE_ICON
     unsigned IconLoaded:1;		///< flag icon loaded
     unsigned IconOrText:1;		///< flag display icon or text
@@ -362,7 +362,15 @@ extern void MenuConfig(const Config *);
 extern void RootMenuHandleButtonPress(const xcb_button_press_event_t *);
 
     /// Build menu from directory.
-extern Menu *RootMenuFromDirectory(char *);
+extern Menu *RootMenuFromDirectory(const char *);
+
+#ifdef USE_MENU_DIR
+    /// Root menu directory cache timeout.
+extern void RootMenuTimeout(uint32_t, int, int);
+#else
+    /// Dummy for root menu directory cache timeout.
+#define RootMenuTimeout(tick, x, y)
+#endif
 
     /// Initialize the root menu module.
 extern void RootMenuInit(void);
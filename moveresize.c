@@ -55,6 +55,7 @@
 #include "hints.h"
 
 #include "plugin/pager.h"
+#include "stats.h"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -503,7 +504,7 @@ static xcb_gcontext_t OutlineGC;	///< outline graphic context
 static void OutlineDraw(int x, int y, unsigned width, unsigned height)
 {
     if (!OutlineDrawn) {
-	xcb_aux_sync(Connection);
+	StatsSync();
 	xcb_grab_server(Connection);
 
 	OutlineLast.x = x;
@@ -526,7 +527,7 @@ static void OutlineClear(void)
 	xcb_poly_rectangle(Connection, XcbScreen->root, OutlineGC, 1,
 	    &OutlineLast);
 
-	xcb_aux_sync(Connection);
+	StatsSync();
 	xcb_ungrab_server(Connection);
 
 	OutlineDrawn = 0;
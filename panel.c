@@ -57,6 +57,7 @@
 #include "core-array/core-array.h"
 #include "core-rc/core-rc.h"
 
+#include "misc.h"
 #include "draw.h"
 #include "tooltip.h"
 #include "screen.h"
@@ -71,10 +72,12 @@
 #include "plugin/button.h"
 #include "plugin/clock.h"
 #include "plugin/netload.h"
+#include "plugin/graph.h"
 #include "plugin/pager.h"
 #include "plugin/swallow.h"
 #include "plugin/systray.h"
 #include "plugin/task.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 
@@ -159,36 +162,92 @@ void PanelClearPluginBackground(const Plugin * plugin)
 }
 
 /**
-**	Update plugin on a panel.
+**	Update damaged area of plugin on a panel.
+**
+**	Plugins report the changed part of their pixmap, only this part is
+**	copied to the panel window.
 **
 **	@param panel	panel which owns the plugin (window)
 **	@param plugin	update content of this plugin on screen
+**	@param x	x-coordinate of damaged area (plugin relative)
+**	@param y	y-coordinate of damaged area (plugin relative)
+**	@param width	width of damaged area
+**	@param height	height of damaged area
 */
-void PanelUpdatePlugin(const Panel * panel, const Plugin * plugin)
+void PanelUpdatePluginArea(const Panel * panel, const Plugin * plugin, int x,
+    int y, int width, int height)
 {
     if (plugin->Pixmap && KeepLooping) {
-	xcb_copy_area(Connection, plugin->Pixmap, panel->Window, RootGC, 0, 0,
-	    plugin->X, plugin->Y, plugin->Width, plugin->Height);
+	// clip to plugin
+	if (x < 0) {
+	    width += x;
+	    x = 0;
+	}
+	if (y < 0) {
+	    height += y;
+	    y = 0;
+	}
+	if (x + width > plugin->Width) {
+	    width = plugin->Width - x;
+	}
+	if (y + height > plugin->Height) {
+	    height = plugin->Height - y;
+	}
+	if (width > 0 && height > 0) {
+	    xcb_copy_area(Connection, plugin->Pixmap, panel->Window, RootGC,
+		x, y, plugin->X + x, plugin->Y + y, width, height);
+	}
     }
 }
 
 /**
-**	Draw a panel.
+**	Update plugin on a panel.
+**
+**	@param panel	panel which owns the plugin (window)
+**	@param plugin	update content of this plugin on screen
+*/
+void PanelUpdatePlugin(const Panel * panel, const Plugin * plugin)
+{
+    PanelUpdatePluginArea(panel, plugin, 0, 0, plugin->Width,
+	plugin->Height);
+}
+
+/**
+**	Draw part of a panel.
+**
+**	Only plugins and border inside of the area are drawn.
 **
 **	@param panel	panel which plugins are drawn
+**	@param x	x-coordinate of area to draw (panel relative)
+**	@param y	y-coordinate of area to draw (panel relative)
+**	@param width	width of area to draw
+**	@param height	height of area to draw
 **
 **	@todo FIXME: panel hidden flickers!
 */
-static void PanelDraw(const Panel * panel)
+static void PanelDrawArea(const Panel * panel, int x, int y, int width,
+    int height)
 {
     const Plugin *plugin;
     int i;
 
-    // draw al plugins
+    StatsRedrawCount(STATS_REDRAW_PANEL);
+
+    // draw all plugins inside of area
     STAILQ_FOREACH(plugin, &panel->Plugins, Next) {
-	PanelUpdatePlugin(panel, plugin);
+	if (x < plugin->X + plugin->Width && plugin->X < x + width
+	    && y < plugin->Y + plugin->Height && plugin->Y < y + height) {
+	    PanelUpdatePluginArea(panel, plugin, x - plugin->X,
+		y - plugin->Y, width, height);
+	}
     }
 
+    // border is outside of area
+    if (x >= panel->Border && y >= panel->Border
+	&& x + width <= panel->Width - panel->Border
+	&& y + height <= panel->Height - panel->Border) {
+	return;
+    }
     // draw border around panel
     for (i = 0; i < panel->Border; i++) {
 	xcb_point_t points[3];
@@ -219,6 +278,16 @@ static void PanelDraw(const Panel * panel)
     }
 }
 
+/**
+**	Draw a panel.
+**
+**	@param panel	panel which plugins are drawn
+*/
+static void PanelDraw(const Panel * panel)
+{
+    PanelDrawArea(panel, 0, 0, panel->Width, panel->Height);
+}
+
 /**
 **	Draw all panels.
 */
@@ -235,19 +304,16 @@ void PanelsDraw(void)
 }
 
 /**
-**	Hide a panel (for autohide).
+**	Get position of a hidden panel.
 **
 **	@param panel	panel to hide
-**
-**	@todo should be swallows and docked apps be unmapped?
+**	@param[out] px	x-coordinate of hidden panel
+**	@param[out] py	y-coordinate of hidden panel
 */
-static void PanelHide(Panel * panel)
+static void PanelHiddenPosition(const Panel * panel, int *px, int *py)
 {
     int x;
     int y;
-    uint32_t values[2];
-
-    panel->Hidden = 1;
 
     x = panel->X;
     y = panel->Y;
@@ -324,13 +390,58 @@ static void PanelHide(Panel * panel)
     }
 #endif
 
-    // move it.
+    *px = x;
+    *py = y;
+}
+
+/**
+**	Move panel window to its hidden or shown position.
+**
+**	While sliding, the window is placed between both positions.  The
+**	window is only moved, its contents are kept.
+**
+**	@param panel	panel to move
+*/
+static void PanelMove(const Panel * panel)
+{
+    int x;
+    int y;
+    int shown;
+    uint32_t values[2];
+
+    PanelHiddenPosition(panel, &x, &y);
+    // steps of the slide, which are shown
+    shown = panel->Hidden ? panel->SlideStep
+	: PANEL_SLIDE_STEPS - panel->SlideStep;
+    x += ((panel->X - x) * shown) / PANEL_SLIDE_STEPS;
+    y += ((panel->Y - y) * shown) / PANEL_SLIDE_STEPS;
+
     values[0] = x;
     values[1] = y;
     xcb_configure_window(Connection, panel->Window,
 	XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
 }
 
+/**
+**	Hide a panel (for autohide).
+**
+**	@param panel	panel to hide
+**
+**	@todo should be swallows and docked apps be unmapped?
+*/
+static void PanelHide(Panel * panel)
+{
+    if (!panel->Hidden && panel->Slide) {
+	// reverse a running slide
+	panel->SlideStep = PANEL_SLIDE_STEPS - panel->SlideStep;
+    }
+    panel->Hidden = 1;
+    panel->ShowPending = 0;
+    panel->HidePending = 0;
+
+    PanelMove(panel);
+}
+
 /**
 **	Display a panel (for autohide).
 **
@@ -338,15 +449,16 @@ static void PanelHide(Panel * panel)
 */
 static void PanelShow(Panel * panel)
 {
+    panel->ShowPending = 0;
+    panel->HidePending = 0;
     if (panel->Hidden) {
-	uint32_t values[2];
-
+	if (panel->Slide) {
+	    // reverse a running slide
+	    panel->SlideStep = PANEL_SLIDE_STEPS - panel->SlideStep;
+	}
 	panel->Hidden = 0;
 
-	values[0] = panel->X;
-	values[1] = panel->Y;
-	xcb_configure_window(Connection, panel->Window,
-	    XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+	PanelMove(panel);
 
 	// FIXME: why query pointer? (can generate enter window events?)
 	// PointerQuery();
@@ -586,6 +698,9 @@ int PanelHandleMotionNotify(const xcb_motion_notify_event_t * event)
 /**
 **	Handle a panel enter notify (for autohide).
 **
+**	A pending hide is canceled, a hidden panel is shown after the
+**	show delay.
+**
 **	@param event	X11 enter notify event
 **
 **	@returns true if event is handled by any panel, false otherwise.
@@ -595,7 +710,15 @@ int PanelHandleEnterNotify(const xcb_enter_notify_event_t * event)
     Panel *panel;
 
     if ((panel = PanelByWindow(event->event))) {
-	PanelShow(panel);
+	panel->HidePending = 0;
+	if (panel->Hidden && !panel->ShowPending) {
+	    if (!panel->ShowDelay) {
+		PanelShow(panel);
+	    } else {
+		panel->ShowPending = 1;
+		panel->AutoHideTick = GetMsTicks() + panel->ShowDelay;
+	    }
+	}
 	return 1;
     }
     /*
@@ -607,6 +730,35 @@ int PanelHandleEnterNotify(const xcb_enter_notify_event_t * event)
     return 0;
 }
 
+/**
+**	Handle a panel leave notify (for autohide).
+**
+**	A pending show is canceled, an autohide panel is hidden after the
+**	hide delay.
+**
+**	@param event	X11 leave notify event
+**
+**	@returns true if event is handled by any panel, false otherwise.
+*/
+int PanelHandleLeaveNotify(const xcb_leave_notify_event_t * event)
+{
+    Panel *panel;
+
+    if ((panel = PanelByWindow(event->event))) {
+	// pointer moved into a plugin window (swallow, systray)
+	if (event->detail == XCB_NOTIFY_DETAIL_INFERIOR) {
+	    return 1;
+	}
+	panel->ShowPending = 0;
+	if (panel->AutoHide && !panel->Hidden && !panel->HidePending) {
+	    panel->HidePending = 1;
+	    panel->AutoHideTick = GetMsTicks() + panel->HideDelay;
+	}
+	return 1;
+    }
+    return 0;
+}
+
 /**
 **	Handle a panel expose event.
 **
@@ -619,21 +771,52 @@ int PanelHandleExpose(const xcb_expose_event_t * event)
     Panel *panel;
 
     if ((panel = PanelByWindow(event->window))) {
-	PanelDraw(panel);
+	// only the exposed region
+	PanelDrawArea(panel, event->x, event->y, event->width,
+	    event->height);
 	return 1;
     }
     return 0;
 }
 
+/**
+**	Handle a pending autohide show or hide of a panel.
+**
+**	@param panel	panel with pending show/hide
+**	@param x	current mouse x-coordinate
+**	@param y	current mouse y-coordinate
+*/
+static void PanelAutoHideTimeout(Panel * panel, int x, int y)
+{
+    if (panel->ShowPending) {
+	PanelShow(panel);
+	return;
+    }
+    if (MenuShown) {			// keep pending until menu is closed
+	return;
+    }
+    // leave events are also send for grabs, check the pointer
+    if (x >= panel->X && x < panel->X + panel->Width && y >= panel->Y
+	&& y < panel->Y + panel->Height) {
+	panel->HidePending = 0;
+	return;
+    }
+    PanelHide(panel);
+}
+
 /**
 **	Handle timeout for the panel (needed for autohide and tooltip).
 **
+**	Autohide is driven by enter/leave events, only pending show/hide
+**	and running slides are handled here.  Grabs (menus, move/resize)
+**	swallow the leave notify, a shown autohide panel without pointer
+**	is hidden after the grab.
+**
 **	@param tick	current tick in ms
 **	@param x	current mouse x-coordinate
 **	@param y	current mouse y-coordinate
 **
 **	@todo write more general tooltip handling
-**	@todo delay of autohide?
 */
 void PanelTimeout(uint32_t tick, int x, int y)
 {
@@ -641,13 +824,20 @@ void PanelTimeout(uint32_t tick, int x, int y)
     Plugin *plugin;
 
     SLIST_FOREACH(panel, &Panels, Next) {
-	// FIXME: delay hiding?
-	if (panel->AutoHide && !panel->Hidden && !MenuShown) {
-	    // mouse outside of the panel
-	    if (x < panel->X || x >= panel->X + panel->Width || y < panel->Y
-		|| y >= panel->Y + panel->Height) {
-		PanelHide(panel);
-	    }
+	if ((panel->ShowPending || panel->HidePending)
+	    && (int32_t) (tick - panel->AutoHideTick) >= 0) {
+	    PanelAutoHideTimeout(panel, x, y);
+	} else if (panel->AutoHide && !panel->Hidden && !panel->ShowPending
+	    && !panel->HidePending && !panel->SlideStep && !MenuShown
+	    && (x < panel->X || x >= panel->X + panel->Width || y < panel->Y
+		|| y >= panel->Y + panel->Height)) {
+	    // pointer left during a grab, no leave notify was send
+	    panel->HidePending = 1;
+	    panel->AutoHideTick = tick + panel->HideDelay;
+	}
+	if (panel->SlideStep) {
+	    --panel->SlideStep;
+	    PanelMove(panel);
 	}
 	// call timeout of each plugin
 	STAILQ_FOREACH(plugin, &panel->Plugins, Next) {
@@ -911,6 +1101,77 @@ static void PanelComputeSize(Panel * panel)
     }
 }
 
+/**
+**	Check if layout inputs of a panel have changed.
+**
+**	The requested sizes of all plugins are remembered, plugins with
+**	changed requests are marked dirty.  Plugins can force a resize by
+**	setting their dirty flag.
+**
+**	@param panel	panel to be checked
+**
+**	@returns true if the panel must be layouted again.
+*/
+static int PanelLayoutChanged(Panel * panel)
+{
+    Plugin *plugin;
+    int changed;
+
+    changed = !panel->LayoutValid;
+    STAILQ_FOREACH(plugin, &panel->Plugins, Next) {
+	changed |= plugin->LayoutDirty;
+	if (plugin->RequestedWidth != plugin->LayoutRequestedWidth
+	    || plugin->RequestedHeight != plugin->LayoutRequestedHeight) {
+	    plugin->LayoutRequestedWidth = plugin->RequestedWidth;
+	    plugin->LayoutRequestedHeight = plugin->RequestedHeight;
+	    plugin->LayoutDirty = 1;
+	    changed = 1;
+	}
+    }
+    panel->LayoutValid = 1;
+
+    return changed;
+}
+
+/**
+**	Set size of a panel plugin from prepared layout.
+**
+**	@param panel			panel containing the plugin
+**	@param plugin			plugin to be sized
+**	@param variable_size		size of a variable sized plugin
+**	@param[in,out] variable_remainder	remainding pixels for variable
+*/
+static void PanelLayoutPlugin(const Panel * panel, Plugin * plugin,
+    int variable_size, int *variable_remainder)
+{
+    unsigned width;
+    unsigned height;
+
+    if (panel->Layout == PANEL_LAYOUT_HORIZONTAL) {
+	height = panel->Height - 2 * panel->Border;
+	width = plugin->Width;
+	if (!width) {
+	    width = variable_size;
+	    if (*variable_remainder) {
+		++width;
+		--*variable_remainder;
+	    }
+	}
+    } else {
+	width = panel->Width - 2 * panel->Border;
+	height = plugin->Height;
+	if (!height) {
+	    height = variable_size;
+	    if (*variable_remainder) {
+		++height;
+		--*variable_remainder;
+	    }
+	}
+    }
+    plugin->Width = width;
+    plugin->Height = height;
+}
+
 /**
 **	Layout panel plugins on a panel.
 **
@@ -991,6 +1252,10 @@ static void PanelPrepareLayout(Panel * panel, int *variable_size,
 /**
 **	Resize a panel.
 **
+**	Nothing is done, if no plugin changed its requested size.  Only
+**	plugins which requested a new size or got a new size are resized,
+**	other plugins are only moved.
+**
 **	@param panel	a panel which must be resized
 **
 **	@todo combine Init+Resize
@@ -1004,6 +1269,10 @@ void PanelResize(Panel * panel)
     Plugin *plugin;
     uint32_t values[4];
 
+    if (!PanelLayoutChanged(panel)) {
+	Debug(3, "panel layout unchanged\n");
+	return;
+    }
     PanelPrepareLayout(panel, &variable_size, &variable_remainder);
 
     // reposition items on the panel
@@ -1011,9 +1280,9 @@ void PanelResize(Panel * panel)
     yoffset = panel->Border;
 
     STAILQ_FOREACH(plugin, &panel->Plugins, Next) {
-	unsigned width;
-	unsigned height;
+	int moved;
 
+	moved = plugin->X != xoffset || plugin->Y != yoffset;
 	plugin->X = xoffset;
 	plugin->Y = yoffset;
 	plugin->ScreenX = panel->X + xoffset;
@@ -1021,33 +1290,18 @@ void PanelResize(Panel * panel)
 
 	// is plugin resizeable?
 	if (plugin->Resize) {
-	    if (panel->Layout == PANEL_LAYOUT_HORIZONTAL) {
-		height = panel->Height - 2 * panel->Border;
-		width = plugin->Width;
-		if (!width) {
-		    width = variable_size;
-		    if (variable_remainder) {
-			++width;
-			--variable_remainder;
-		    }
-		}
-	    } else {
-		width = panel->Width - 2 * panel->Border;
-		height = plugin->Height;
-		if (!height) {
-		    height = variable_size;
-		    if (variable_remainder) {
-			++height;
-			--variable_remainder;
-		    }
-		}
+	    PanelLayoutPlugin(panel, plugin, variable_size,
+		&variable_remainder);
+	    if (plugin->LayoutDirty || plugin->Width != plugin->LayoutWidth
+		|| plugin->Height != plugin->LayoutHeight) {
+		plugin->LayoutWidth = plugin->Width;
+		plugin->LayoutHeight = plugin->Height;
+		plugin->Resize(plugin);
 	    }
-	    plugin->Width = width;
-	    plugin->Height = height;
-	    plugin->Resize(plugin);
 	}
+	plugin->LayoutDirty = 0;
 
-	if (plugin->Window) {		// move plugin window
+	if (plugin->Window && moved) {	// move plugin window
 	    // FIXME: can add move to resize?
 	    values[0] = xoffset;
 	    values[1] = yoffset;
@@ -1063,7 +1317,7 @@ void PanelResize(Panel * panel)
     }
 
     if (panel->Hidden) {		// hide moves window
-	PanelHide(panel);
+	PanelMove(panel);
 	// FIXME: should combine hide=move and resize here?
 	values[0] = panel->Width;
 	values[1] = panel->Height;
@@ -1099,6 +1353,7 @@ void PanelInit(void)
 	int yoffset;
 	Plugin *plugin;
 
+	PanelLayoutChanged(panel);	// remember requested sizes
 	PanelPrepareLayout(panel, &variable_size, &variable_remainder);
 
 	//
@@ -1111,8 +1366,9 @@ void PanelInit(void)
 	values[2] =
 	    XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
 	    XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE |
-	    XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_POINTER_MOTION |
-	    XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+	    XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW |
+	    XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_EXPOSURE |
+	    XCB_EVENT_MASK_STRUCTURE_NOTIFY;
 	values[3] = Cursors.Default;
 
 	xcb_create_window(Connection, XCB_COPY_FROM_PARENT, panel->Window,
@@ -1131,34 +1387,13 @@ void PanelInit(void)
 	// create and layout plugins of this panel
 	STAILQ_FOREACH(plugin, &panel->Plugins, Next) {
 	    if (plugin->Create) {
-		unsigned width;
-		unsigned height;
-
-		if (panel->Layout == PANEL_LAYOUT_HORIZONTAL) {
-		    height = panel->Height - 2 * panel->Border;
-		    width = plugin->Width;
-		    if (!width) {
-			width = variable_size;
-			if (variable_remainder) {
-			    ++width;
-			    --variable_remainder;
-			}
-		    }
-		} else {
-		    width = panel->Width - 2 * panel->Border;
-		    height = plugin->Height;
-		    if (!height) {
-			height = variable_size;
-			if (variable_remainder) {
-			    ++height;
-			    --variable_remainder;
-			}
-		    }
-		}
-		plugin->Width = width;
-		plugin->Height = height;
+		PanelLayoutPlugin(panel, plugin, variable_size,
+		    &variable_remainder);
 		plugin->Create(plugin);
 	    }
+	    plugin->LayoutWidth = plugin->Width;
+	    plugin->LayoutHeight = plugin->Height;
+	    plugin->LayoutDirty = 0;
 
 	    plugin->X = xoffset;
 	    plugin->Y = yoffset;
@@ -1178,6 +1413,12 @@ void PanelInit(void)
 	}
 	// show the panel
 	xcb_map_window(Connection, panel->Window);
+
+	// hide autohide panel, if the pointer isn't inside
+	if (panel->AutoHide) {
+	    panel->HidePending = 1;
+	    panel->AutoHideTick = GetMsTicks() + panel->HideDelay;
+	}
     }
 
 #if 0
@@ -1223,15 +1464,25 @@ void PanelExit(void)
 /**
 **	Default panel plugin create method.
 **
-**	Creates a pixmap of panel plugin size.
+**	Creates a pixmap of panel plugin size.  An existing pixmap of the
+**	same size is reused, the caller must redraw its contents.
 **
 **	@param plugin	new common plugin data to be be created
 */
 void PanelPluginCreatePixmap(Plugin * plugin)
 {
+    if (plugin->Pixmap != XCB_NONE) {
+	if (plugin->PixmapWidth == plugin->Width
+	    && plugin->PixmapHeight == plugin->Height) {
+	    return;
+	}
+	xcb_free_pixmap(Connection, plugin->Pixmap);
+    }
     plugin->Pixmap = xcb_generate_id(Connection);
     xcb_create_pixmap(Connection, XcbScreen->root_depth, plugin->Pixmap,
 	XcbScreen->root, plugin->Width, plugin->Height);
+    plugin->PixmapWidth = plugin->Width;
+    plugin->PixmapHeight = plugin->Height;
 }
 
 /**
@@ -1316,6 +1567,8 @@ Panel *PanelNew(void)
     panel->Y = -1;
     panel->Border = PANEL_DEFAULT_BORDER;
     panel->HiddenSize = PANEL_DEFAULT_HIDE_SIZE;
+    panel->ShowDelay = PANEL_DEFAULT_SHOW_DELAY;
+    panel->HideDelay = PANEL_DEFAULT_HIDE_DELAY;
     panel->OnLayer = LAYER_PANEL_DEFAULT;
 
     temp = SLIST_FIRST(&Panels);
@@ -1475,6 +1728,23 @@ static void PanelConfigPanel(const ConfigObject * array)
     if (ConfigStringsGetBoolean(array, "auto-hide", NULL) > 0) {
 	panel->AutoHide = 1;
     }
+    if (ConfigStringsGetInteger(array, &ival, "show-delay", NULL)) {
+	if (ival < 0 || ival > UINT16_MAX) {
+	    Warning("invalid panel show delay: %zd\n", ival);
+	} else {
+	    panel->ShowDelay = ival;
+	}
+    }
+    if (ConfigStringsGetInteger(array, &ival, "hide-delay", NULL)) {
+	if (ival < 0 || ival > UINT16_MAX) {
+	    Warning("invalid panel hide delay: %zd\n", ival);
+	} else {
+	    panel->HideDelay = ival;
+	}
+    }
+    if (ConfigStringsGetBoolean(array, "slide", NULL) > 0) {
+	panel->Slide = 1;
+    }
     //
     //	maximize-over
     //
@@ -1508,6 +1778,8 @@ static void PanelConfigPanel(const ConfigObject * array)
 		    plugin = ClockConfig(p_array);
 		} else if (!strcasecmp(sval, "netload")) {
 		    plugin = NetloadConfig(p_array);
+		} else if (!strcasecmp(sval, "graph")) {
+		    plugin = GraphConfig(p_array);
 		} else {
 		    Warning("panel plugin '%s' not supported\n", sval);
 		    plugin = NULL;
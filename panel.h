@@ -59,9 +59,18 @@ struct _panel_plugin_
     uint16_t RequestedWidth;		///< requested width
     uint16_t RequestedHeight;		///< requested height
 
+    uint16_t LayoutWidth;		///< width of last layout
+    uint16_t LayoutHeight;		///< height of last layout
+    uint16_t LayoutRequestedWidth;	///< requested width of last layout
+    uint16_t LayoutRequestedHeight;	///< requested height of last layout
+
+    uint16_t PixmapWidth;		///< width of created pixmap
+    uint16_t PixmapHeight;		///< height of created pixmap
+
     unsigned UserWidth:1;		///< user-specified width flag
     unsigned UserHeight:1;		///< user-specified width flag
     unsigned Grabbed:1;			///< mouse was grabbed by plugin
+    unsigned LayoutDirty:1;		///< plugin needs resize on next layout
 
     xcb_window_t Window;		///< content of window (plugin frees)
     xcb_pixmap_t Pixmap;		///< content of pixmap (plugin frees)
@@ -116,11 +125,20 @@ struct _panel_
     int8_t Border;			///< border size in pixels
     int8_t HiddenSize;			///< hidden size in pixels
 
+    uint16_t ShowDelay;			///< autohide show delay in ms
+    uint16_t HideDelay;			///< autohide hide delay in ms
+    uint32_t AutoHideTick;		///< tick of pending show/hide
+    uint8_t SlideStep;			///< remaining slide animation steps
+
     Layer OnLayer:8;			///< layer for panel
 
     unsigned Hidden:1;			///< true if hidden by autohide
     unsigned AutoHide:1;		///< true autohide panel
+    unsigned ShowPending:1;		///< autohide show is pending
+    unsigned HidePending:1;		///< autohide hide is pending
+    unsigned Slide:1;			///< slide panel in and out
     unsigned MaximizeOver:1;		///< true if maximized over panel
+    unsigned LayoutValid:1;		///< true if plugins are layouted
 
     PanelLayout Layout:1;		///< layout
     Gravity Gravity:4;			///< placement and alignment on screen
@@ -160,6 +178,10 @@ extern void PanelClearPluginBackgroundWithColor(const Plugin *,
     /// Clear panel plugin background.
 extern void PanelClearPluginBackground(const Plugin *);
 
+    /// Update damaged area of plugin on a panel.
+extern void PanelUpdatePluginArea(const Panel *, const Plugin *, int, int,
+    int, int);
+
     /// Update plugin on a panel.
 extern void PanelUpdatePlugin(const Panel *, const Plugin *);
 
@@ -181,6 +203,9 @@ extern int PanelHandleMotionNotify(const xcb_motion_notify_event_t *);
     /// Handle a panel enter notify.
 extern int PanelHandleEnterNotify(const xcb_enter_notify_event_t *);
 
+    /// Handle a leave notify for panels.
+extern int PanelHandleLeaveNotify(const xcb_leave_notify_event_t *);
+
     /// Handle a panel expose event.
 extern int PanelHandleExpose(const xcb_expose_event_t *);
 
@@ -260,7 +260,6 @@ static void PanelButtonSetSize(Plugin * plugin, unsigned width,
 */
 static void PanelButtonResize(Plugin * plugin)
 {
-    PanelPluginDeletePixmap(plugin);
     PanelButtonCreate(plugin);
 }
 
@@ -31,6 +31,11 @@
 ///	Commands (external or window manager) can be executed on pointer
 ///	button click.
 ///
+///	The clock is only redrawn at the next boundary of the smallest time
+///	unit used by the format (second, minute or hour) and only if the
+///	formatted text changed.  Widths of ascii characters are fetched
+///	once from the font, so no round trip is needed for plain text.
+///
 ///	@todo drawing two lines isn't the best code
 ///
 ///< @{
@@ -60,6 +65,7 @@
 
 #include "panel.h"
 #include "plugin/clock.h"
+#include "stats.h"
 
 /**
 **	Clock plugin typedef.
@@ -79,6 +85,9 @@ struct _clock_plugin_
 
     MenuButton *Buttons;		///< commands to run on click
 
+    time_t NextUpdate;			///< time of next needed update
+    unsigned Period;			///< update period of format in s
+
     char AsciiTime[80];			///< currently displayed time
 };
 
@@ -88,7 +97,175 @@ SLIST_HEAD(_clock_head_, _clock_plugin_);
     /// list of all clocks of the plugin
 static struct _clock_head_ Clocks = SLIST_HEAD_INITIALIZER(Clocks);
 
-static uint32_t ClockLastUpdateTick;	///< tick of last clock update
+    /// width of ascii characters in clock font, 0 unknown
+static int16_t ClockCharWidth[128];
+
+// ------------------------------------------------------------------------ //
+// Layout
+
+/**
+**	Get update period of a strftime format.
+**
+**	Conversions are checked for the smallest time unit used.  Unknown
+**	conversions are updated every second.
+**
+**	@param format	strftime format string
+**
+**	@returns update period in seconds (1, 60 or 3600).
+*/
+static unsigned ClockFormatPeriod(const char *format)
+{
+    unsigned period;
+
+    period = 3600;			// date changes on hour boundary
+    while ((format = strchr(format, '%'))) {
+	++format;
+	// skip flags, field width and modifiers
+	while (*format && strchr("_-0^#EO123456789", *format)) {
+	    ++format;
+	}
+	switch (*format) {
+	    case '\0':
+		return period;
+	    case '%':
+	    case 'n':
+	    case 't':
+		break;
+	    case 'M':
+	    case 'R':
+		period = 60;
+		break;
+	    case 'H':
+	    case 'I':
+	    case 'k':
+	    case 'l':
+	    case 'p':
+	    case 'P':
+	    case 'a':
+	    case 'A':
+	    case 'b':
+	    case 'B':
+	    case 'h':
+	    case 'C':
+	    case 'd':
+	    case 'D':
+	    case 'e':
+	    case 'F':
+	    case 'g':
+	    case 'G':
+	    case 'j':
+	    case 'm':
+	    case 'u':
+	    case 'U':
+	    case 'V':
+	    case 'w':
+	    case 'W':
+	    case 'x':
+	    case 'y':
+	    case 'Y':
+	    case 'z':
+	    case 'Z':
+		break;
+	    default:			// seconds or unknown
+		return 1;
+	}
+	++format;
+    }
+    return period;
+}
+
+/**
+**	Get time of next boundary of update period.
+**
+**	@param period	update period in seconds
+**	@param now	current time
+**	@param tm	current local time
+**
+**	@returns time of next period boundary.
+*/
+static time_t ClockNextUpdate(unsigned period, time_t now,
+    const struct tm *tm)
+{
+    switch (period) {
+	case 1:
+	    return now + 1;
+	case 60:
+	    return now - tm->tm_sec + 60;
+	default:
+	    return now - tm->tm_sec - tm->tm_min * 60 + 3600;
+    }
+}
+
+/**
+**	Fetch width of ascii characters of clock font.
+**
+**	Core fonts have no kerning, the width of a text is the sum of the
+**	character widths.
+*/
+static void ClockCharWidthInit(void)
+{
+    xcb_query_font_cookie_t cookie;
+    xcb_query_font_reply_t *reply;
+    const xcb_charinfo_t *infos;
+    int n;
+    int c;
+
+    memset(ClockCharWidth, 0, sizeof(ClockCharWidth));
+    cookie = xcb_query_font_unchecked(Connection, Fonts.Clock.Font);
+    if (!(reply = StatsReply(xcb_query_font_reply, cookie, NULL))) {
+	Warning("can't query clock font\n");
+	return;
+    }
+    // only fonts with ascii in the first row are supported
+    if (!reply->min_byte1) {
+	infos = xcb_query_font_char_infos(reply);
+	n = xcb_query_font_char_infos_length(reply);
+	for (c = ' '; c < 127; ++c) {
+	    int i;
+
+	    if (c < reply->min_char_or_byte2 || c > reply->max_char_or_byte2) {
+		continue;
+	    }
+	    i = c - reply->min_char_or_byte2;
+	    if (!n) {			// all characters have same metrics
+		ClockCharWidth[c] = reply->max_bounds.character_width;
+	    } else if (i < n) {
+		ClockCharWidth[c] = infos[i].character_width;
+	    }
+	}
+    }
+    free(reply);
+}
+
+/**
+**	Get width of clock text.
+**
+**	Uses the cached character widths, only text with non-ascii or
+**	unknown characters is queried from the server.
+**
+**	@param str	text of string
+**	@param len	length of string
+**
+**	@returns width of text in pixels.
+*/
+static unsigned ClockTextWidth(const char *str, size_t len)
+{
+    unsigned width;
+    size_t i;
+
+    width = 0;
+    for (i = 0; i < len; ++i) {
+	unsigned c;
+
+	c = (unsigned char)str[i];
+	if (c >= 128 || !ClockCharWidth[c]) {
+	    return FontTextWidthReply(FontQueryExtentsRequest(&Fonts.Clock,
+		    len, str));
+	}
+	width += ClockCharWidth[c];
+    }
+    return width;
+}
 
 // ------------------------------------------------------------------------ //
 // Draw
@@ -101,13 +278,12 @@ static uint32_t ClockLastUpdateTick;	///< tick of last clock update
 static void ClockDraw(ClockPlugin * clock_plugin)
 {
     time_t now;
+    struct tm *tm;
     char buf[80];
     char *s;
     int l;
     Plugin *plugin;
     Panel *panel;
-    xcb_query_text_extents_cookie_t cookie_label1;
-    xcb_query_text_extents_cookie_t cookie_label2;
     unsigned real_width;
     unsigned width1;
     unsigned width2;
@@ -119,7 +295,10 @@ static void ClockDraw(ClockPlugin * clock_plugin)
 	return;
     }
     time(&now);
-    l = strftime(buf, sizeof(buf), clock_plugin->ShortFormat, localtime(&now));
+    tm = localtime(&now);
+    l = strftime(buf, sizeof(buf), clock_plugin->ShortFormat, tm);
+    clock_plugin->NextUpdate =
+	ClockNextUpdate(clock_plugin->Period, now, tm);
 
     // draw only, if text changed
     if (!strcmp(clock_plugin->AsciiTime, buf)) {
@@ -129,14 +308,13 @@ static void ClockDraw(ClockPlugin * clock_plugin)
     s = strchr(buf, '\n');
     if (s) {
 	s++;
-	cookie_label1 =
-	    FontQueryExtentsRequest(&Fonts.Clock, (s - buf) - 1, buf);
-	cookie_label2 =
-	    FontQueryExtentsRequest(&Fonts.Clock, l - (s - buf), s);
+	width1 = ClockTextWidth(buf, (s - buf) - 1);
+	width2 = ClockTextWidth(s, l - (s - buf));
 	height = Fonts.Clock.Height * 2 + CLOCK_INNER_SPACE;
 
     } else {
-	cookie_label1 = FontQueryExtentsRequest(&Fonts.Clock, l, buf);
+	width1 = ClockTextWidth(buf, l);
+	NO_WARNING(width2);
 	height = Fonts.Clock.Height;
     }
 
@@ -145,11 +323,8 @@ static void ClockDraw(ClockPlugin * clock_plugin)
     // clear the background
     PanelClearPluginBackgroundWithColor(plugin, &Colors.ClockBG.Pixel);
 
-    width1 = FontTextWidthReply(cookie_label1);
-    NO_WARNING(width2);
     real_width = width1 + 2 * CLOCK_INNER_SPACE;
     if (s) {
-	width2 = FontTextWidthReply(cookie_label2);
 	if (width2 > width1) {
 	    real_width = width2 + 2;
 	}
@@ -209,7 +384,6 @@ static void ClockCreate(Plugin * plugin)
 */
 static void ClockResize(Plugin * plugin)
 {
-    PanelPluginDeletePixmap(plugin);
     ClockCreate(plugin);
 }
 
@@ -255,24 +429,26 @@ static void ClockTooltip(const Plugin * plugin, int x, int y)
 /**
 **	Clock panel plugin timeout method.
 **
+**	The clock is redrawn, when its next update time is reached or the
+**	system time was set backwards.
+**
 **	@param plugin	common panel plugin data of clock
 **	@param tick	current tick in ms
 **	@param x	current mouse x-coordinate
 **	@param y	current mouse y-coordinate
 */
-static void ClockTimeout(Plugin
-    __attribute__((unused)) * plugin, uint32_t tick, int
-    __attribute__((unused)) x, int __attribute__((unused)) y)
+static void ClockTimeout(Plugin * plugin, uint32_t
+    __attribute__((unused)) tick, int __attribute__((unused)) x, int
+    __attribute__((unused)) y)
 {
     ClockPlugin *clock_plugin;
+    time_t now;
 
-    // draw only every 1000ms
-    if (ClockLastUpdateTick > tick || tick >= ClockLastUpdateTick + 1000) {
-	ClockLastUpdateTick = tick;
-	// all clocks are redrawn by first plugin
-	SLIST_FOREACH(clock_plugin, &Clocks, Next) {
-	    ClockDraw(clock_plugin);
-	}
+    clock_plugin = plugin->Object;
+    time(&now);
+    if (now >= clock_plugin->NextUpdate
+	|| clock_plugin->NextUpdate - now > (time_t) clock_plugin->Period) {
+	ClockDraw(clock_plugin);
     }
 }
 
@@ -280,41 +456,41 @@ static void ClockTimeout(Plugin
 
 /**
 **	Initialize clock(s).
-**
-**	@todo FIXME: can send request for all clocks first, than handle
-**	requests.
 */
 void ClockInit(void)
 {
     ClockPlugin *clock_plugin;
     time_t now;
 
+    if (SLIST_EMPTY(&Clocks)) {
+	return;
+    }
+    ClockCharWidthInit();
+
     time(&now);
     SLIST_FOREACH(clock_plugin, &Clocks, Next) {
 	Plugin *plugin;
 	char buf[80];
 	const char *s;
 	int l;
-	xcb_query_text_extents_cookie_t cookie_label1;
-	xcb_query_text_extents_cookie_t cookie_label2;
 	unsigned width1;
 	unsigned width2;
 	unsigned height;
 
+	clock_plugin->Period = ClockFormatPeriod(clock_plugin->ShortFormat);
+
 	// FIXME: combine with draw
 	l = strftime(buf, sizeof(buf), clock_plugin->ShortFormat,
 	    localtime(&now));
 	s = strchr(buf, '\n');
 	if (s) {
 	    ++s;
-	    cookie_label1 =
-		FontQueryExtentsRequest(&Fonts.Clock, (s - buf) - 1, buf);
-	    cookie_label2 =
-		FontQueryExtentsRequest(&Fonts.Clock, l - (s - buf), s);
+	    width1 = ClockTextWidth(buf, (s - buf) - 1);
+	    width2 = ClockTextWidth(s, l - (s - buf));
 	    height = Fonts.Clock.Height * 2;
 
 	} else {
-	    cookie_label1 = FontQueryExtentsRequest(&Fonts.Clock, l, buf);
+	    width1 = ClockTextWidth(buf, l);
 	    height = Fonts.Clock.Height;	// use max height
 	}
 
@@ -322,9 +498,7 @@ void ClockInit(void)
 
 	// FIXME TWO lines clock format
 
-	width1 = FontTextWidthReply(cookie_label1);
 	if (s) {
-	    width2 = FontTextWidthReply(cookie_label2);
 	    if (width2 > width1) {
 		width1 = width2;
 	    }
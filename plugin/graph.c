@@ -0,0 +1,704 @@
+///
+///	@file graph.c @brief graph panel plugin functions.
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+///
+///	@ingroup panel
+///	@defgroup graph_plugin	The graph panel plugin
+///
+///	This module add graphs of sampled system metrics to the panel.
+///	This module is only available if compiled with #USE_GRAPH.
+///
+///	Supported sources are cpu usage (/proc/stat), memory and swap usage
+///	(/proc/meminfo), disk read/write (/proc/diskstats) and pressure
+///	stall information (/proc/pressure/).  Each source gives two values,
+///	the first is drawn from the bottom, the second from the top, with
+///	the netload colors.
+///
+///	All proc files are kept open and read only once per sample, even if
+///	many graphs use them.  The history is drawn by the shared
+///	@ref history module.
+///
+///< @{
+
+#include <xcb/xcb.h>
+#include "uwm.h"
+
+#ifdef USE_GRAPH			// {
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <xcb/xcb_icccm.h>
+
+#include "queue.h"
+#include "core-array/core-array.h"
+#include "core-rc/core-rc.h"
+
+#include "draw.h"
+#include "tooltip.h"
+#include "client.h"
+
+#include "image.h"
+#include "icon.h"
+#include "menu.h"
+
+#include "panel.h"
+#include "plugin/history.h"
+#include "plugin/graph.h"
+#define GRAPH_INTERVAL		500	///< sample interval in ms
+#define GRAPH_PERMILLE		1000	///< scale of relative sources
+
+/**
+**	Graph sources.
+*/
+typedef enum
+{
+    GRAPH_SOURCE_CPU,			///< cpu user/system
+    GRAPH_SOURCE_MEMORY,		///< memory/swap used
+    GRAPH_SOURCE_DISK,			///< disk read/write
+    GRAPH_SOURCE_PRESSURE_CPU,		///< cpu pressure some/full
+    GRAPH_SOURCE_PRESSURE_MEMORY,	///< memory pressure some/full
+    GRAPH_SOURCE_PRESSURE_IO,		///< io pressure some/full
+    GRAPH_SOURCE_MAX			///< number of sources
+} GraphSource;
+
+/**
+**	Table of graph source config names, proc files and value labels.
+*/
+static const struct
+{
+    const char *Name;			///< config name
+    const char *File;			///< proc file
+    const char *Label[2];		///< label of values
+} GraphSources[GRAPH_SOURCE_MAX] = {
+    {"cpu", "/proc/stat", {"user", "system"}},
+    {"memory", "/proc/meminfo", {"used", "swap"}},
+    {"disk", "/proc/diskstats", {"read", "write"}},
+    {"pressure-cpu", "/proc/pressure/cpu", {"some", "full"}},
+    {"pressure-memory", "/proc/pressure/memory", {"some", "full"}},
+    {"pressure-io", "/proc/pressure/io", {"some", "full"}},
+};
+
+/**
+**	Graph plugin typedef.
+*/
+typedef struct _graph_plugin_ GraphPlugin;
+
+/**
+**	Structure with graph panel plugin private data.
+*/
+struct _graph_plugin_
+{
+    SLIST_ENTRY(_graph_plugin_) Next;	///< singly-linked graph list
+    Plugin *Plugin;			///< common plugin data
+
+    unsigned Source:3;			///< #GraphSource of values
+    unsigned Relative:1;		///< values are per mille, fixed scale
+    unsigned Valid:1;			///< last counters are valid
+
+    char *Device;			///< disk device, NULL first found
+
+    uint64_t LastA;			///< last first counter
+    uint64_t LastB;			///< last second counter
+    uint64_t LastTotal;			///< last total counter
+
+    History History;			///< history of value pairs
+
+    MenuButton *Buttons;		///< commands to run on click
+};
+
+    /// Graph plugin list head structure
+SLIST_HEAD(_graph_head_, _graph_plugin_);
+
+    /// list of all graphs of the plugin
+static struct _graph_head_ Graphs = SLIST_HEAD_INITIALIZER(Graphs);
+
+static uint32_t GraphLastUpdateTick;	///< tick of last graph update
+
+// ------------------------------------------------------------------------ //
+// Proc
+
+/**
+**	Structure of a kept open proc file.
+*/
+static struct
+{
+    int Fd;				///< file descriptor, -1 closed
+    unsigned Serial;			///< serial of read buffer content
+    size_t Size;			///< size of read buffer
+    char *Buffer;			///< file content
+} GraphFiles[GRAPH_SOURCE_MAX];
+
+static unsigned GraphSerial;		///< serial of current sample
+
+/**
+**	Read proc file of a source, only once for each sample.
+**
+**	The complete file is read, the buffer grows as needed.  Real disks
+**	are listed after many loop and ram devices in /proc/diskstats.
+**
+**	@param source	graph source
+**
+**	@returns file content, NULL if unavailable.
+*/
+static const char *GraphReadSource(GraphSource source)
+{
+    size_t length;
+    ssize_t n;
+    char *s;
+
+    if (GraphFiles[source].Serial == GraphSerial) {
+	return GraphFiles[source].Buffer;
+    }
+    if (GraphFiles[source].Fd < 0) {
+	if ((GraphFiles[source].Fd =
+		open(GraphSources[source].File, O_RDONLY | O_CLOEXEC)) < 0) {
+	    return NULL;
+	}
+    }
+    length = 0;
+    for (;;) {
+	if (length + 1 >= GraphFiles[source].Size) {
+	    GraphFiles[source].Size =
+		GraphFiles[source].Size ? GraphFiles[source].Size * 2 : 4096;
+	    GraphFiles[source].Buffer =
+		realloc(GraphFiles[source].Buffer, GraphFiles[source].Size);
+	}
+	n = pread(GraphFiles[source].Fd, GraphFiles[source].Buffer + length,
+	    GraphFiles[source].Size - 1 - length, length);
+	if (n <= 0) {
+	    break;
+	}
+	length += n;
+    }
+    if (!length) {
+	return NULL;
+    }
+    GraphFiles[source].Buffer[length] = '\0';
+    // drop incomplete last line
+    if ((s = strrchr(GraphFiles[source].Buffer, '\n'))) {
+	s[1] = '\0';
+    }
+    GraphFiles[source].Serial = GraphSerial;
+
+    return GraphFiles[source].Buffer;
+}
+
+/**
+**	Parse value of a keyword.
+**
+**	@param buf	buffer to search
+**	@param key	keyword including separator
+**
+**	@returns value after keyword, 0 if not found.
+*/
+static uint64_t GraphParseKey(const char *buf, const char *key)
+{
+    uint64_t value;
+
+    if (!(buf = strstr(buf, key))) {
+	return 0;
+    }
+    HistoryParseNumber(buf + strlen(key), &value);
+    return value;
+}
+
+/**
+**	Get counters of a disk device.
+**
+**	@param graph_plugin	graph plugin private data
+**	@param buf		content of /proc/diskstats
+**	@param[out] reads	sectors read
+**	@param[out] writes	sectors written
+**
+**	@returns true if device was found.
+*/
+static int GraphParseDisk(GraphPlugin * graph_plugin, const char *buf,
+    uint64_t * reads, uint64_t * writes)
+{
+    while (*buf) {
+	const char *name;
+	uint64_t values[7];
+	size_t len;
+	int i;
+
+	// major minor name
+	buf = HistoryParseNumber(buf, values);
+	buf = HistoryParseNumber(buf, values);
+	while (*buf == ' ') {
+	    ++buf;
+	}
+	name = buf;
+	while (*buf && *buf != ' ' && *buf != '\n') {
+	    ++buf;
+	}
+	len = buf - name;
+	for (i = 0; i < 7; ++i) {
+	    buf = HistoryParseNumber(buf, values + i);
+	}
+
+	//
+	//	device not specified, use first disk with reads
+	//
+	if (!graph_plugin->Device && values[0] && strncmp(name, "loop", 4)
+	    && strncmp(name, "ram", 3)) {
+	    graph_plugin->Device = strndup(name, len);
+	    Debug(2, "graph: found default disk %s\n", graph_plugin->Device);
+	}
+	if (graph_plugin->Device && !strncmp(name, graph_plugin->Device, len)
+	    && !graph_plugin->Device[len]) {
+	    *reads = values[2];
+	    *writes = values[6];
+	    return 1;
+	}
+
+	if (!(buf = strchr(buf, '\n'))) {
+	    break;
+	}
+	++buf;
+    }
+    return 0;
+}
+
+/**
+**	Take a sample of a graph.
+**
+**	Counters are converted to deltas, relative values are scaled to
+**	per mille.
+**
+**	@param graph_plugin	graph plugin private data
+**	@param elapsed		ms since last sample
+**	@param[out] a		first value
+**	@param[out] b		second value
+**
+**	@returns true if a sample was taken.
+*/
+static int GraphSample(GraphPlugin * graph_plugin, uint32_t elapsed,
+    uint32_t * a, uint32_t * b)
+{
+    const char *buf;
+    uint64_t counter_a;
+    uint64_t counter_b;
+    uint64_t total;
+    uint64_t delta_a;
+    uint64_t delta_b;
+    uint64_t delta_total;
+    int valid;
+
+    if (!(buf = GraphReadSource(graph_plugin->Source))) {
+	return 0;
+    }
+
+    switch (graph_plugin->Source) {
+	case GRAPH_SOURCE_CPU:
+	    {
+		uint64_t values[8];
+		int i;
+
+		// "cpu  user nice system idle iowait irq softirq steal"
+		buf += 3;
+		total = 0;
+		for (i = 0; i < 8; ++i) {
+		    buf = HistoryParseNumber(buf, values + i);
+		    total += values[i];
+		}
+		counter_a = values[0] + values[1];
+		counter_b = values[2] + values[5] + values[6] + values[7];
+	    }
+	    break;
+
+	case GRAPH_SOURCE_MEMORY:
+	    {
+		uint64_t mem_total;
+		uint64_t swap_total;
+
+		// gauges: no delta needed
+		mem_total = GraphParseKey(buf, "MemTotal:");
+		swap_total = GraphParseKey(buf, "SwapTotal:");
+		*a = mem_total ? ((mem_total - GraphParseKey(buf,
+			    "MemAvailable:")) * GRAPH_PERMILLE) / mem_total
+		    : 0;
+		*b = swap_total ? ((swap_total - GraphParseKey(buf,
+			    "SwapFree:")) * GRAPH_PERMILLE) / swap_total : 0;
+	    }
+	    return 1;
+
+	case GRAPH_SOURCE_DISK:
+	    if (!GraphParseDisk(graph_plugin, buf, &counter_a, &counter_b)) {
+		graph_plugin->Valid = 0;
+		return 0;
+	    }
+	    total = 0;
+	    break;
+
+	default:			// pressure stall information
+	    // "some avg10=.. avg60=.. avg300=.. total=us"
+	    counter_a = GraphParseKey(buf, "total=");
+	    counter_b = (buf = strstr(buf, "full"))
+		? GraphParseKey(buf, "total=") : 0;
+	    total = 0;
+	    break;
+    }
+
+    valid = graph_plugin->Valid && counter_a >= graph_plugin->LastA
+	&& counter_b >= graph_plugin->LastB
+	&& total >= graph_plugin->LastTotal;
+    delta_a = counter_a - graph_plugin->LastA;
+    delta_b = counter_b - graph_plugin->LastB;
+    delta_total = total - graph_plugin->LastTotal;
+
+    // last counters for next round
+    graph_plugin->LastA = counter_a;
+    graph_plugin->LastB = counter_b;
+    graph_plugin->LastTotal = total;
+    graph_plugin->Valid = 1;
+
+    if (!valid) {			// first sample or counter reset
+	*a = 0;
+	*b = 0;
+	return 1;
+    }
+
+    switch (graph_plugin->Source) {
+	case GRAPH_SOURCE_CPU:
+	    *a = delta_total ? (delta_a * GRAPH_PERMILLE) / delta_total : 0;
+	    *b = delta_total ? (delta_b * GRAPH_PERMILLE) / delta_total : 0;
+	    break;
+	case GRAPH_SOURCE_DISK:	// KiB in interval
+	    *a = MIN(delta_a / 2, UINT32_MAX);
+	    *b = MIN(delta_b / 2, UINT32_MAX);
+	    break;
+	default:			// us stalled in interval
+	    elapsed = elapsed ? elapsed : GRAPH_INTERVAL;
+	    *a = (delta_a * GRAPH_PERMILLE) / (elapsed * 1000ULL);
+	    *b = (delta_b * GRAPH_PERMILLE) / (elapsed * 1000ULL);
+	    break;
+    }
+    return 1;
+}
+
+// ------------------------------------------------------------------------ //
+// Draw
+
+/**
+**	Draw a graph panel plugin.
+**
+**	@param graph_plugin	graph plugin private data
+*/
+static void GraphDraw(GraphPlugin * graph_plugin)
+{
+    HistoryDraw(&graph_plugin->History, graph_plugin->Plugin,
+	graph_plugin->Relative ? GRAPH_PERMILLE
+	: graph_plugin->History.Max[0] + graph_plugin->History.Max[1]);
+}
+
+// ------------------------------------------------------------------------ //
+// Callbacks
+
+/**
+**	Create/initialize a graph panel plugin.
+**
+**	@param plugin	common panel plugin data of graph
+*/
+static void GraphCreate(Plugin * plugin)
+{
+    GraphPlugin *graph_plugin;
+
+    // create pixmap
+    PanelPluginCreatePixmap(plugin);
+    // clear the background
+    PanelClearPluginBackgroundWithColor(plugin, &Colors.NetloadBG.Pixel);
+
+    graph_plugin = plugin->Object;
+
+    // reallocate history buffer
+    HistoryResize(&graph_plugin->History, plugin);
+}
+
+/**
+**	Resize a graph panel plugin.
+**
+**	@param plugin	common panel plugin data of graph
+*/
+static void GraphResize(Plugin * plugin)
+{
+    GraphCreate(plugin);
+}
+
+/**
+**	Handle a click event on a graph panel plugin.
+**
+**	Runs command associated with graph.
+**
+**	@param plugin	common panel plugin data of graph
+**	@param x	x-coordinate of button press
+**	@param y	y-coordinate of button press
+**	@param mask	button mask
+*/
+static void GraphHandleButtonPress(Plugin * plugin, int
+    __attribute__((unused)) x, int __attribute__((unused)) y, int mask)
+{
+    GraphPlugin *graph_plugin;
+
+    graph_plugin = plugin->Object;
+    PanelExecuteButton(plugin, graph_plugin->Buttons, mask);
+}
+
+/**
+**	Format a graph value.
+**
+**	@param graph_plugin	graph plugin private data
+**	@param value		value to format
+**	@param[out] buf		output buffer (at least 16 bytes)
+**
+**	@returns @a buf.
+*/
+static char *GraphFormat(const GraphPlugin * graph_plugin, uint32_t value,
+    char *buf)
+{
+    const char *scale;
+    uint64_t rate;
+
+    if (graph_plugin->Relative) {
+	sprintf(buf, "%u.%u%%", value / 10, value % 10);
+	return buf;
+    }
+    // KiB in interval to KiB per second
+    rate = ((uint64_t) value * 1000) / GRAPH_INTERVAL;
+    if (rate > (1 << 30) - 1) {
+	scale = "TiB";
+	rate >>= 30;
+    } else if (rate > (1 << 20) - 1) {
+	scale = "GiB";
+	rate >>= 20;
+    } else if (rate > (1 << 10) - 1) {
+	scale = "MiB";
+	rate >>= 10;
+    } else {
+	scale = "KiB";
+    }
+    sprintf(buf, "%u%s/s", (unsigned)rate, scale);
+    return buf;
+}
+
+/**
+**	Show tooltip of graph panel plugin.
+**
+**	@param plugin	common panel plugin data of graph
+**	@param x	current mouse x-coordinate
+**	@param y	current mouse y-coordinate
+*/
+static void GraphTooltip(const Plugin * plugin, int x, int y)
+{
+    const GraphPlugin *graph_plugin;
+    char buf[256];
+    char avg_a[16];
+    char max_a[16];
+    char avg_b[16];
+    char max_b[16];
+
+    graph_plugin = plugin->Object;
+    snprintf(buf, sizeof(buf), "%s%s%s: %s:%s<%s %s:%s<%s",
+	GraphSources[graph_plugin->Source].Name,
+	graph_plugin->Device ? " " : "",
+	graph_plugin->Device ? graph_plugin->Device : "",
+	GraphSources[graph_plugin->Source].Label[0],
+	GraphFormat(graph_plugin, graph_plugin->History.Average[0], avg_a),
+	GraphFormat(graph_plugin, graph_plugin->History.Max[0], max_a),
+	GraphSources[graph_plugin->Source].Label[1],
+	GraphFormat(graph_plugin, graph_plugin->History.Average[1], avg_b),
+	GraphFormat(graph_plugin, graph_plugin->History.Max[1], max_b));
+    TooltipShow(x, y, buf);
+}
+
+/**
+**	Graph panel plugin timeout method.
+**
+**	@param plugin	common panel plugin data of graph
+**	@param tick	current tick in ms
+**	@param x	current mouse x-coordinate
+**	@param y	current mouse y-coordinate
+*/
+static void GraphTimeout(Plugin
+    __attribute__((unused)) * plugin, uint32_t tick, int
+    __attribute__((unused)) x, int __attribute__((unused)) y)
+{
+    // sample only every GRAPH_INTERVAL ms
+    if (GraphLastUpdateTick > tick
+	|| tick >= GraphLastUpdateTick + GRAPH_INTERVAL) {
+	GraphPlugin *graph_plugin;
+	uint32_t elapsed;
+
+	elapsed = tick - GraphLastUpdateTick;
+	GraphLastUpdateTick = tick;
+	++GraphSerial;
+	// all graphs are sampled and redrawn by first plugin
+	SLIST_FOREACH(graph_plugin, &Graphs, Next) {
+	    uint32_t a;
+	    uint32_t b;
+
+	    if (!graph_plugin->History.Values
+		|| !GraphSample(graph_plugin, elapsed, &a, &b)) {
+		continue;
+	    }
+	    HistoryAdd(&graph_plugin->History, a, b);
+	    GraphDraw(graph_plugin);
+	}
+    }
+}
+
+// ------------------------------------------------------------------------ //
+
+/**
+**	Initialize graph panel plugin.
+*/
+void GraphInit(void)
+{
+    GraphPlugin *graph_plugin;
+    int i;
+
+    for (i = 0; i < GRAPH_SOURCE_MAX; ++i) {
+	GraphFiles[i].Fd = -1;
+	GraphFiles[i].Serial = 0;
+    }
+    GraphSerial = 0;
+
+    SLIST_FOREACH(graph_plugin, &Graphs, Next) {
+	Plugin *plugin;
+
+	plugin = graph_plugin->Plugin;
+	if (!plugin->RequestedWidth) {
+	    plugin->RequestedWidth = 56 + 2 * HISTORY_INNER_SPACE;
+	}
+	if (!plugin->RequestedHeight) {
+	    plugin->RequestedHeight = 16 + 2 * HISTORY_INNER_SPACE;
+	}
+    }
+}
+
+/**
+**	Cleanup graph panel plugin.
+*/
+void GraphExit(void)
+{
+    GraphPlugin *graph_plugin;
+    int i;
+
+    while (!SLIST_EMPTY(&Graphs)) {	// list deletion
+	graph_plugin = SLIST_FIRST(&Graphs);
+
+	free(graph_plugin->Device);
+	free(graph_plugin->History.Values);
+
+	MenuButtonDel(graph_plugin->Buttons);
+
+	SLIST_REMOVE_HEAD(&Graphs, Next);
+	free(graph_plugin);
+    }
+
+    for (i = 0; i < GRAPH_SOURCE_MAX; ++i) {
+	if (GraphFiles[i].Fd >= 0) {
+	    close(GraphFiles[i].Fd);
+	    GraphFiles[i].Fd = -1;
+	}
+	free(GraphFiles[i].Buffer);
+	GraphFiles[i].Buffer = NULL;
+	GraphFiles[i].Size = 0;
+    }
+}
+
+// ------------------------------------------------------------------------ //
+// Config
+
+#ifdef USE_RC				// {
+
+/**
+**	Create a new graph panel plugin from config data.
+**
+**	@param array	configuration array for graph panel plugin
+**
+**	@returns created graph panel plugin.
+*/
+Plugin *GraphConfig(const ConfigObject * array)
+{
+    Plugin *plugin;
+    GraphPlugin *graph_plugin;
+    const char *sval;
+
+    graph_plugin = calloc(1, sizeof(*graph_plugin));
+    SLIST_INSERT_HEAD(&Graphs, graph_plugin, Next);
+
+    graph_plugin->Source = GRAPH_SOURCE_CPU;
+    if (ConfigStringsGetString(array, &sval, "source", NULL)) {
+	int i;
+
+	for (i = 0; i < GRAPH_SOURCE_MAX; ++i) {
+	    if (!strcasecmp(sval, GraphSources[i].Name)) {
+		graph_plugin->Source = i;
+		break;
+	    }
+	}
+	if (i == GRAPH_SOURCE_MAX) {
+	    Warning("graph source '%s' not supported\n", sval);
+	}
+    }
+    graph_plugin->Relative = graph_plugin->Source != GRAPH_SOURCE_DISK;
+    // autoscaled graphs start with a minimal scale
+    graph_plugin->History.Max[0] = 1;
+    graph_plugin->History.Max[1] = 1;
+
+    // user specified disk device
+    if (ConfigStringsGetString(array, &sval, "device", NULL)) {
+	graph_plugin->Device = strdup(sval);
+    }
+    if (ConfigStringsGetBoolean(array, "smooth", NULL) > 0) {
+	graph_plugin->History.Smooth = 1;
+    }
+    // common config of pointer buttons to commands
+    MenuButtonsConfig(array, &graph_plugin->Buttons);
+
+    plugin = PanelPluginNew();
+    plugin->Object = graph_plugin;
+    graph_plugin->Plugin = plugin;
+
+    // common config of plugin size
+    PanelPluginConfigSize(array, plugin);
+
+    plugin->Create = GraphCreate;
+    plugin->Delete = PanelPluginDeletePixmap;
+    plugin->Resize = GraphResize;
+    plugin->Tooltip = GraphTooltip;
+    plugin->HandleButtonPress = GraphHandleButtonPress;
+    plugin->Timeout = GraphTimeout;
+
+    return plugin;
+}
+
+#endif // } USE_RC
+
+#endif // } USE_GRAPH
+
+/// @}
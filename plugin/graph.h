@@ -0,0 +1,51 @@
+///
+///	@file graph.h @brief graph panel plugin header file.
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+///	@ingroup panel
+///	@addtogroup graph_plugin
+/// @{
+
+//////////////////////////////////////////////////////////////////////////////
+//	Prototypes
+//////////////////////////////////////////////////////////////////////////////
+
+    /// Initialize graph panel plugin.
+extern void GraphInit(void);
+
+    /// Cleanup graph panel plugin.
+extern void GraphExit(void);
+
+    /// Parse graph panel plugin configuration.
+Plugin *GraphConfig(const ConfigObject *);
+
+#ifndef USE_GRAPH			// {
+
+    /// Dummy for initialize graph panel plugin.
+#define GraphInit()
+    /// Dummy for cleanup graph panel plugin.
+#define GraphExit()
+    /// Dummy for parse graph panel plugin configuration.
+#define GraphConfig(o)	NULL
+
+#endif // } USE_GRAPH
+
+/// @}
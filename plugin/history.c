@@ -0,0 +1,252 @@
+///
+///	@file history.c @brief history graph of panel plugins functions.
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+///
+///	@ingroup panel
+///	@defgroup history	The history graph of panel plugins
+///
+///	This module contains the sample history shared by the netload and
+///	graph panel plugins.  It is only available if compiled with
+///	#USE_NETLOAD or #USE_GRAPH.
+///
+///	The history is kept in a ring buffer of value pairs.  Each new
+///	sample scrolls the graph by one column and draws only the new column
+///	(with smooth also the one before).  Only if the scale has changed,
+///	the complete history is drawn.
+///
+///< @{
+
+#include <xcb/xcb.h>
+#include "uwm.h"
+
+#if defined(USE_NETLOAD) || defined(USE_GRAPH)	// {
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <xcb/xcb_icccm.h>
+
+#include "queue.h"
+#include "core-array/core-array.h"
+#include "core-rc/core-rc.h"
+
+#include "draw.h"
+#include "client.h"
+
+#include "image.h"
+#include "icon.h"
+#include "menu.h"
+
+#include "panel.h"
+#include "plugin/history.h"
+
+/**
+**	Parse an unsigned decimal number.
+**
+**	@param s		string, leading spaces are skipped
+**	@param[out] value	parsed number
+**
+**	@returns pointer behind the number.
+*/
+const char *HistoryParseNumber(const char *s, uint64_t * value)
+{
+    uint64_t v;
+
+    while (*s == ' ') {
+	++s;
+    }
+    v = 0;
+    while ((unsigned)(*s - '0') < 10) {
+	v = v * 10 + *s++ - '0';
+    }
+    *value = v;
+    return s;
+}
+
+/**
+**	Resize history to the width of its plugin.
+**
+**	The old history is lost.
+**
+**	@param history	history of plugin
+**	@param plugin	common panel plugin data
+*/
+void HistoryResize(History * history, const Plugin * plugin)
+{
+    int size;
+
+    size = plugin->Width - HISTORY_INNER_SPACE * 2;
+    if (size < 1) {
+	size = 1;
+    }
+    free(history->Values);
+    history->Values = calloc(sizeof(*history->Values), 2 * size);
+    history->Size = size;
+    history->Head = 0;
+    history->DrawnScale = 0;
+}
+
+/**
+**	Add a sample to the history.
+**
+**	With smooth, the new and the previous sample are set to their
+**	average.  Average and max are taken from the stored values.
+**
+**	@param history	history of plugin
+**	@param a	first value, drawn from bottom
+**	@param b	second value, drawn from top
+*/
+void HistoryAdd(History * history, uint32_t a, uint32_t b)
+{
+    uint32_t *values;
+
+    values = history->Values + history->Head * 2;
+    if (history->Smooth) {
+	uint32_t *previous;
+
+	previous = history->Values + ((history->Head + history->Size - 1)
+	    % history->Size) * 2;
+	a = ((uint64_t) a + previous[0]) / 2;
+	b = ((uint64_t) b + previous[1]) / 2;
+
+	previous[0] = a;
+	previous[1] = b;
+    }
+    values[0] = a;
+    values[1] = b;
+    history->Head = (history->Head + 1) % history->Size;
+
+    // greatest seen value
+    if (history->Max[0] < a) {
+	history->Max[0] = a;
+    }
+    if (history->Max[1] < b) {
+	history->Max[1] = b;
+    }
+    // average value
+    history->Average[0] = (history->Average[0] + a) / 2;
+    history->Average[1] = (history->Average[1] + b) / 2;
+}
+
+/**
+**	Draw a single column of history graph.
+**
+**	@param history	history of plugin
+**	@param plugin	common panel plugin data
+**	@param x	column (graph relative)
+**	@param scale	value of full graph height
+*/
+static void HistoryDrawColumn(const History * history, const Plugin * plugin,
+    int x, uint32_t scale)
+{
+    const uint32_t *values;
+    xcb_rectangle_t rectangle;
+    unsigned height;
+    unsigned a;
+    unsigned b;
+
+    height = plugin->Height - HISTORY_INNER_SPACE * 2;
+
+    // oldest sample is at head
+    values = history->Values + ((history->Head + x) % history->Size) * 2;
+
+    // fit values into area
+    a = MIN(height, ((uint64_t) values[0] * height) / scale);
+    b = MIN(height, ((uint64_t) values[1] * height) / scale);
+
+    rectangle.x = HISTORY_INNER_SPACE + x;
+    rectangle.width = 1;
+
+    if (a + b < height) {		// no overlap clear
+	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	    &Colors.NetloadBG.Pixel);
+	rectangle.y = HISTORY_INNER_SPACE + b;
+	rectangle.height = height - a - b;
+	xcb_poly_fill_rectangle(Connection, plugin->Pixmap, RootGC, 1,
+	    &rectangle);
+    }
+    if (b) {
+	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	    &Colors.NetloadTX.Pixel);
+	rectangle.y = HISTORY_INNER_SPACE;
+	rectangle.height = b;
+	xcb_poly_fill_rectangle(Connection, plugin->Pixmap, RootGC, 1,
+	    &rectangle);
+    }
+    if (a) {
+	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	    &Colors.NetloadRX.Pixel);
+	rectangle.y = HISTORY_INNER_SPACE + height - a;
+	rectangle.height = a;
+	xcb_poly_fill_rectangle(Connection, plugin->Pixmap, RootGC, 1,
+	    &rectangle);
+    }
+}
+
+/**
+**	Draw history graph into its plugin.
+**
+**	@param history	history of plugin
+**	@param plugin	common panel plugin data
+**	@param scale	value of full graph height
+*/
+void HistoryDraw(History * history, Plugin * plugin, uint32_t scale)
+{
+    int size;
+    int x;
+
+    if (!plugin->Panel) {
+	Debug(2, "history not inside a panel\n");
+	return;
+    }
+    if (!plugin->Pixmap || (size = history->Size) <= 0) {
+	return;
+    }
+    if (!scale) {
+	scale = 1;
+    }
+
+    if (scale != history->DrawnScale) {
+	x = 0;
+	history->DrawnScale = scale;
+    } else {
+	// scroll left by one column
+	xcb_copy_area(Connection, plugin->Pixmap, plugin->Pixmap, RootGC,
+	    HISTORY_INNER_SPACE + 1, HISTORY_INNER_SPACE, HISTORY_INNER_SPACE,
+	    HISTORY_INNER_SPACE, size - 1,
+	    plugin->Height - HISTORY_INNER_SPACE * 2);
+	// smooth has changed previous sample too
+	x = size - 1 - history->Smooth;
+	if (x < 0) {
+	    x = 0;
+	}
+    }
+    for (; x < size; ++x) {
+	HistoryDrawColumn(history, plugin, x, scale);
+    }
+
+    PanelUpdatePlugin(plugin->Panel, plugin);
+}
+
+#endif // } USE_NETLOAD || USE_GRAPH
+
+/// @}
@@ -0,0 +1,76 @@
+///
+///	@file history.h @brief history graph of panel plugins header file.
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+///	@ingroup panel
+///	@addtogroup history
+/// @{
+
+//////////////////////////////////////////////////////////////////////////////
+//	Defines
+//////////////////////////////////////////////////////////////////////////////
+
+#define HISTORY_INNER_SPACE	2	///< space around graph
+
+//////////////////////////////////////////////////////////////////////////////
+//	Structures
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+**	History typedef.
+*/
+typedef struct _history_ History;
+
+/**
+**	Structure of a history ring of value pairs.
+**
+**	The first value of a pair is drawn from the bottom, the second from
+**	the top of the graph.
+*/
+struct _history_
+{
+    int Size;				///< number of history columns
+    int Head;				///< ring index of next sample
+    uint32_t *Values;			///< ring buffer of value pairs
+    uint32_t DrawnScale;		///< scale of drawn graph, 0 none
+    uint32_t Average[2];		///< average values
+    uint32_t Max[2];			///< max values
+
+    unsigned Smooth:1;			///< smooth values
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//	Prototypes
+//////////////////////////////////////////////////////////////////////////////
+
+    /// Parse an unsigned decimal number.
+extern const char *HistoryParseNumber(const char *, uint64_t *);
+
+    /// Resize history to the width of its plugin.
+extern void HistoryResize(History *, const Plugin *);
+
+    /// Add a sample to the history.
+extern void HistoryAdd(History *, uint32_t, uint32_t);
+
+    /// Draw history graph into its plugin.
+extern void HistoryDraw(History *, Plugin *, uint32_t);
+
+/// @}
@@ -46,6 +46,14 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <net/if.h>
+
+#ifdef USE_NETLOAD_NETLINK
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#endif
 
 #include <xcb/xcb_icccm.h>
 
@@ -62,10 +70,9 @@
 #include "menu.h"
 
 #include "panel.h"
+#include "plugin/history.h"
 #include "plugin/netload.h"
 
-#define NETLOAD_INNER_SPACE	2	///< space around graph
-
 /**
 **	Netload plugin typedef.
 */
@@ -80,16 +87,12 @@ struct _netload_plugin_
     Plugin *Plugin;			///< common plugin data
 
     char *Interface;			///< network interface to monitor
+    int Slot;				///< interface slot, -1 not found
+    int SlotN;				///< slots searched for interface
 
-    uint32_t *History;			///< rx/tx bytes history
-    uint32_t AverageTX;			///< average tx
-    uint32_t AverageRX;			///< average rx
+    History History;			///< history of rx/tx bytes
     uint32_t LastTX;			///< last tx
     uint32_t LastRX;			///< last rx
-    uint32_t MaxTX;			///< max tx
-    uint32_t MaxRX;			///< max rx
-
-    unsigned Smooth:1;			///< smooth values
 
     MenuButton *Buttons;		///< commands to run on click
 };
@@ -102,213 +105,401 @@ static struct _netload_head_ Netloads = SLIST_HEAD_INITIALIZER(Netloads);
 
 static uint32_t NetloadLastUpdateTick;	///< tick of last netload update
 
+// ------------------------------------------------------------------------ //
+// Interfaces
+
+/**
+**	Network interface typedef.
+*/
+typedef struct _netload_interface_ NetloadInterface;
+
+/**
+**	Structure with collected statistics of a network interface.
+**
+**	The interface table is shared by all netload plugins, each plugin
+**	only remembers the slot of its interface.
+*/
+struct _netload_interface_
+{
+    char Name[IF_NAMESIZE];		///< interface name
+    unsigned Index;			///< interface index (netlink)
+    unsigned Serial;			///< collect serial, when last seen
+    uint64_t RX;			///< received bytes
+    uint64_t TX;			///< transmitted bytes
+};
+
+static NetloadInterface *NetloadInterfaces;	///< interface slot table
+static int NetloadInterfaceN;		///< number of interface slots
+static unsigned NetloadSerial;		///< serial of current collect
+
+/**
+**	Get slot of a network interface, create a new one if needed.
+**
+**	@param name	interface name (not terminated)
+**	@param len	length of interface name
+**	@param hint	slot to try first
+**
+**	@returns slot number of interface.
+*/
+static int NetloadInterfaceSlot(const char *name, size_t len, int hint)
+{
+    int i;
+
+    if (len >= IF_NAMESIZE) {
+	len = IF_NAMESIZE - 1;
+    }
+    // interfaces are reported in the same order each time
+    if (hint < NetloadInterfaceN
+	&& !strncmp(NetloadInterfaces[hint].Name, name, len)
+	&& !NetloadInterfaces[hint].Name[len]) {
+	return hint;
+    }
+    for (i = 0; i < NetloadInterfaceN; ++i) {
+	if (!strncmp(NetloadInterfaces[i].Name, name, len)
+	    && !NetloadInterfaces[i].Name[len]) {
+	    return i;
+	}
+    }
+
+    NetloadInterfaces = realloc(NetloadInterfaces,
+	(NetloadInterfaceN + 1) * sizeof(*NetloadInterfaces));
+    memset(NetloadInterfaces + i, 0, sizeof(*NetloadInterfaces));
+    memcpy(NetloadInterfaces[i].Name, name, len);
+    Debug(3, "netload: new interface %s in slot %d\n",
+	NetloadInterfaces[i].Name, i);
+
+    return NetloadInterfaceN++;
+}
+
 // ------------------------------------------------------------------------ //
 // Proc
 
 #define PROC_NET_DEV	"/proc/net/dev"	///< network statistics
 
+static int ProcNetDevFd = -1;		///< kept open /proc/net/dev
+
 /**
-**	Collect network data.
+**	Collect network data from /proc/net/dev.
+**
+**	The file is kept open and re-read from start each time.
+**
+**	@returns true if statistics could be read.
 */
-static void ProcReadNet(void)
+static int ProcReadNet(void)
 {
-    int fd;
-    char buf[8192];
-    int n;
-    unsigned long rx;
-    unsigned long tx;
-    NetloadPlugin *netload_plugin;
-
-    fd = open(PROC_NET_DEV, O_RDONLY);
-    if (fd < 0) {
-	return;
+    static char buf[16384];
+    const char *s;
+    size_t n;
+    ssize_t r;
+    int line;
+
+    if (ProcNetDevFd < 0) {
+	if ((ProcNetDevFd = open(PROC_NET_DEV, O_RDONLY | O_CLOEXEC)) < 0) {
+	    return 0;
+	}
     }
-    n = read(fd, buf, sizeof(buf));
-    if (n > 0) {
-	const char *s;
-
-	buf[n] = '\0';
-	if (!(s = strchr(buf, '\n'))) {	// skip first line
-	    close(fd);
-	    return;
+    n = 0;
+    while ((r = pread(ProcNetDevFd, buf + n, sizeof(buf) - 1 - n, n)) > 0) {
+	n += r;
+	if (n == sizeof(buf) - 1) {
+	    break;
 	}
-	++s;
-	for (;;) {
-	    char name[512];
-	    int n;
+    }
+    if (!n) {
+	return 0;
+    }
+    buf[n] = '\0';
 
-	    if (!(s = strchr(s, '\n'))) {	// skip to end of line
+    // skip the two header lines
+    if (!(s = strchr(buf, '\n')) || !(s = strchr(s + 1, '\n'))) {
+	return 0;
+    }
+    ++s;
+
+    for (line = 0; *s; ++line) {
+	const char *name;
+	uint64_t rx;
+	uint64_t tx;
+	uint64_t skip;
+	int slot;
+	int i;
+
+	while (*s == ' ') {
+	    ++s;
+	}
+	name = s;
+	while (*s != ':' && *s != '\n' && *s) {
+	    ++s;
+	}
+	if (*s != ':') {		// no valid line
+	    if (!(s = strchr(s, '\n'))) {
 		break;
 	    }
 	    ++s;
+	    continue;
+	}
+	slot = NetloadInterfaceSlot(name, s - name, line);
+	++s;
+
+	// rx bytes, 7 other rx fields, tx bytes
+	s = HistoryParseNumber(s, &rx);
+	for (i = 0; i < 7; ++i) {
+	    s = HistoryParseNumber(s, &skip);
+	}
+	s = HistoryParseNumber(s, &tx);
+	Debug(4, "%s %lu %lu\n", NetloadInterfaces[slot].Name,
+	    (unsigned long)rx, (unsigned long)tx);
+
+	NetloadInterfaces[slot].RX = rx;
+	NetloadInterfaces[slot].TX = tx;
+	NetloadInterfaces[slot].Serial = NetloadSerial;
+
+	if (!(s = strchr(s, '\n'))) {	// skip to end of line
+	    break;
+	}
+	++s;
+    }
+    return 1;
+}
+
+#ifdef USE_NETLOAD_NETLINK
+
+// ------------------------------------------------------------------------ //
+// Netlink
+
+    /// netlink socket, -1 not yet opened, -2 not supported
+static int NetlinkFd = -1;
+static uint32_t NetlinkSequence;	///< sequence number of last request
+
+/**
+**	Get slot of a network interface by its index.
+**
+**	@param index	interface index
+**
+**	@returns slot number of interface, -1 if unknown.
+*/
+static int NetlinkInterfaceSlot(unsigned index)
+{
+    char name[IF_NAMESIZE];
+    int slot;
+    int i;
+
+    for (i = 0; i < NetloadInterfaceN; ++i) {
+	if (NetloadInterfaces[i].Index == index) {
+	    return i;
+	}
+    }
+    // new interface, only here the name is needed
+    if (!if_indextoname(index, name)) {
+	return -1;
+    }
+    slot = NetloadInterfaceSlot(name, strlen(name), NetloadInterfaceN);
+    NetloadInterfaces[slot].Index = index;
+    return slot;
+}
 
-	    rx = 0;
-	    tx = 0;
-	    n = sscanf(s, "%s %lu %*s %*s %*s %*s %*s %*s %*s %lu", name, &rx,
-		&tx);
-	    if (n != 3) {
+/**
+**	Collect network data with netlink RTM_GETSTATS.
+**
+**	@returns true if statistics could be read.
+*/
+static int NetlinkReadNet(void)
+{
+    struct
+    {
+	struct nlmsghdr Header;
+	struct if_stats_msg Message;
+    } request;
+    static uint32_t buf[8192 / sizeof(uint32_t)];
+
+    if (NetlinkFd == -1) {
+	if ((NetlinkFd =
+		socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC,
+		    NETLINK_ROUTE)) < 0) {
+	    NetlinkFd = -2;
+	}
+    }
+    if (NetlinkFd < 0) {
+	return 0;
+    }
+
+    memset(&request, 0, sizeof(request));
+    request.Header.nlmsg_len = sizeof(request);
+    request.Header.nlmsg_type = RTM_GETSTATS;
+    request.Header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.Header.nlmsg_seq = ++NetlinkSequence;
+    request.Message.family = AF_UNSPEC;
+    request.Message.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+    if (send(NetlinkFd, &request, sizeof(request), 0) < 0) {
+	goto error;
+    }
+
+    for (;;) {
+	const struct nlmsghdr *header;
+	ssize_t n;
+
+	if ((n = recv(NetlinkFd, buf, sizeof(buf), 0)) <= 0) {
+	    goto error;
+	}
+	for (header = (const struct nlmsghdr *)buf; NLMSG_OK(header, n);
+	    header = NLMSG_NEXT(header, n)) {
+	    const struct if_stats_msg *message;
+	    const struct rtattr *attr;
+	    int len;
+
+	    if (header->nlmsg_seq != NetlinkSequence) {
 		continue;
 	    }
-	    n = strlen(name);		// remove trailing :
-	    if (name[n - 1] == ':') {
-		name[n - 1] = '\0';
+	    if (header->nlmsg_type == NLMSG_DONE) {
+		return 1;
 	    }
-	    Debug(4, "%s %d %lu %lu\n", name, n, rx, tx);
-
-	    //
-	    //	search plugin
-	    //
-	    SLIST_FOREACH(netload_plugin, &Netloads, Next) {
-		//
-		//	interface not specified, use first usefull network
-		//	device.
-		//
-		if (!netload_plugin->Interface) {
-		    if (!strncmp(name, "lo", 3) || !strncmp(name, "dummy", 5)
-			|| !strncmp(name, "irda", 4)) {
-			continue;
-		    }
-		    Debug(0, "found default interface %s\n", name);
-		    netload_plugin->Interface = strdup(name);
+	    if (header->nlmsg_type != RTM_NEWSTATS) {
+		// NLMSG_ERROR: kernel without RTM_GETSTATS
+		goto error;
+	    }
+	    message = NLMSG_DATA(header);
+	    attr = (const struct rtattr *)((const char *)message +
+		NLMSG_ALIGN(sizeof(*message)));
+	    len = header->nlmsg_len - NLMSG_LENGTH(sizeof(*message));
+	    for (; RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+		struct rtnl_link_stats64 stats;
+		int slot;
+
+		if (attr->rta_type != IFLA_STATS_LINK_64) {
+		    continue;
 		}
-		//
-		//	there can be multiple plugins with the same interface
-		//
-		if (!strcmp(name, netload_plugin->Interface)) {
-		    int size;
-		    unsigned delta_rx;
-		    unsigned delta_tx;
-
-		    Debug(4, "found plugin %s\n", name);
-
-		    // round about
-		    if (rx < netload_plugin->LastRX) {
-			netload_plugin->LastRX = rx;
-		    }
-		    if (tx < netload_plugin->LastTX) {
-			netload_plugin->LastTX = tx;
-		    }
-		    // add values to history
-		    size =
-			netload_plugin->Plugin->Width -
-			NETLOAD_INNER_SPACE * 2;
-		    delta_rx = rx - netload_plugin->LastRX;
-		    delta_tx = tx - netload_plugin->LastTX;
-		    if (netload_plugin->Smooth) {
-			delta_rx += netload_plugin->History[size * 2 - 4];
-			delta_tx += netload_plugin->History[size * 2 - 3];
-
-			netload_plugin->History[size * 2 - 4] = delta_rx / 2;
-			netload_plugin->History[size * 2 - 3] = delta_tx / 2;
-			netload_plugin->History[size * 2 - 2] = delta_rx / 2;
-			netload_plugin->History[size * 2 - 1] = delta_tx / 2;
-		    } else {
-			netload_plugin->History[size * 2 - 2] = delta_rx;
-			netload_plugin->History[size * 2 - 1] = delta_tx;
-		    }
-
-		    // greatest seen value
-		    if (netload_plugin->MaxRX < delta_rx) {
-			netload_plugin->MaxRX = delta_rx;
-		    }
-		    if (netload_plugin->MaxTX < delta_tx) {
-			netload_plugin->MaxTX = delta_tx;
-		    }
-		    // average value
-		    netload_plugin->AverageRX =
-			(netload_plugin->AverageRX + delta_rx) / 2;
-		    netload_plugin->AverageTX =
-			(netload_plugin->AverageTX + delta_tx) / 2;
-
-		    // last value for next round
-		    netload_plugin->LastRX = rx;
-		    netload_plugin->LastTX = tx;
+		if ((slot = NetlinkInterfaceSlot(message->ifindex)) < 0) {
+		    continue;
 		}
+		// attribute data is only 32 bit aligned
+		memcpy(&stats, RTA_DATA(attr), sizeof(stats));
+		NetloadInterfaces[slot].RX = stats.rx_bytes;
+		NetloadInterfaces[slot].TX = stats.tx_bytes;
+		NetloadInterfaces[slot].Serial = NetloadSerial;
 	    }
 	}
-	close(fd);
     }
+
+  error:
+    Warning("netload: netlink statistics failed, using " PROC_NET_DEV "\n");
+    close(NetlinkFd);
+    NetlinkFd = -2;
+    return 0;
 }
 
+#endif
+
+// ------------------------------------------------------------------------ //
+
 /**
-**	Collect the network statistics.
+**	Find interface slot of a netload plugin.
+**
+**	Only searched again, if new interfaces were found.
+**
+**	@param netload_plugin	netload plugin private data
 */
-void NetloadCollect(void)
+static void NetloadFindSlot(NetloadPlugin * netload_plugin)
 {
-    ProcReadNet();
+    int i;
+
+    for (i = netload_plugin->SlotN; i < NetloadInterfaceN; ++i) {
+	const char *name;
+
+	name = NetloadInterfaces[i].Name;
+	//
+	//	interface not specified, use first usefull network device.
+	//
+	if (!netload_plugin->Interface) {
+	    if (!strncmp(name, "lo", 3) || !strncmp(name, "dummy", 5)
+		|| !strncmp(name, "irda", 4)) {
+		continue;
+	    }
+	    Debug(0, "found default interface %s\n", name);
+	    netload_plugin->Interface = strdup(name);
+	}
+	if (!strcmp(name, netload_plugin->Interface)) {
+	    netload_plugin->Slot = i;
+	    break;
+	}
+    }
+    netload_plugin->SlotN = NetloadInterfaceN;
 }
 
-// ------------------------------------------------------------------------ //
-// Draw
-
 /**
-**	Draw a netload panel plugin.
+**	Add a sample to netload plugin history.
 **
 **	@param netload_plugin	netload plugin private data
+**	@param rx		received bytes counter
+**	@param tx		transmitted bytes counter
 */
-static void NetloadDraw(NetloadPlugin * netload_plugin)
+static void NetloadAddSample(NetloadPlugin * netload_plugin, uint32_t rx,
+    uint32_t tx)
 {
-    Plugin *plugin;
-    Panel *panel;
-    int x;
-    unsigned size;
-
-    plugin = netload_plugin->Plugin;
-    if (!(panel = plugin->Panel)) {
-	Debug(2, "netload not inside a panel\n");
-	return;
+    // round about
+    if (rx < netload_plugin->LastRX) {
+	netload_plugin->LastRX = rx;
+    }
+    if (tx < netload_plugin->LastTX) {
+	netload_plugin->LastTX = tx;
     }
+    HistoryAdd(&netload_plugin->History, rx - netload_plugin->LastRX,
+	tx - netload_plugin->LastTX);
 
-    size = plugin->Height - NETLOAD_INNER_SPACE * 2;
-    for (x = 0; x < plugin->Width - NETLOAD_INNER_SPACE * 2; ++x) {
-	xcb_point_t points[2];
-	unsigned rx;
-	unsigned tx;
-	unsigned u;
-
-	rx = netload_plugin->History[x * 2 + 0];
-	tx = netload_plugin->History[x * 2 + 1];
-
-	// fit tx + rx into area
-	u = netload_plugin->MaxRX + netload_plugin->MaxTX;
-	rx = ((unsigned long)rx * size) / u;
-	tx = ((unsigned long)tx * size) / u;
-
-	rx = MIN(size, rx);
-	tx = MIN(size, tx);
-
-	points[0].x = x + NETLOAD_INNER_SPACE;
-	points[1].x = x + NETLOAD_INNER_SPACE;
-
-	if (rx + tx < size) {		// no overlap clear
-	    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
-		&Colors.NetloadBG.Pixel);
-	    points[0].y = NETLOAD_INNER_SPACE + tx;
-	    points[1].y = size - rx;
-	    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, plugin->Pixmap,
-		RootGC, 2, points);
-	}
+    // last value for next round
+    netload_plugin->LastRX = rx;
+    netload_plugin->LastTX = tx;
+}
 
-	if (tx) {
-	    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
-		&Colors.NetloadTX.Pixel);
-	    points[0].y = NETLOAD_INNER_SPACE;
-	    points[1].y = NETLOAD_INNER_SPACE + tx;
-	    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, plugin->Pixmap,
-		RootGC, 2, points);
-	}
+/**
+**	Collect the network statistics.
+**
+**	All interfaces are read once into the shared interface table, then
+**	each plugin picks the counters of its slot.
+*/
+void NetloadCollect(void)
+{
+    NetloadPlugin *netload_plugin;
+    int valid;
 
-	if (rx) {
-	    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
-		&Colors.NetloadRX.Pixel);
-	    points[0].y = size - rx;
-	    points[1].y = size;
-	    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, plugin->Pixmap,
-		RootGC, 2, points);
+    ++NetloadSerial;
+#ifdef USE_NETLOAD_NETLINK
+    if (!(valid = NetlinkReadNet()))
+#endif
+	valid = ProcReadNet();
+
+    SLIST_FOREACH(netload_plugin, &Netloads, Next) {
+	const NetloadInterface *interface;
+
+	if (!netload_plugin->History.Values) {	// not yet created
+	    continue;
+	}
+	if (valid && netload_plugin->SlotN != NetloadInterfaceN) {
+	    NetloadFindSlot(netload_plugin);
 	}
+	// each tick adds one sample, missing interface adds no traffic
+	if (!valid || netload_plugin->Slot < 0
+	    || (interface = &NetloadInterfaces[netload_plugin->Slot])->Serial
+	    != NetloadSerial) {
+	    NetloadAddSample(netload_plugin, netload_plugin->LastRX,
+		netload_plugin->LastTX);
+	    continue;
+	}
+	NetloadAddSample(netload_plugin, interface->RX, interface->TX);
     }
+}
+
+// ------------------------------------------------------------------------ //
+// Draw
 
-    PanelUpdatePlugin(panel, plugin);
+/**
+**	Draw a netload panel plugin.
+**
+**	@param netload_plugin	netload plugin private data
+*/
+static void NetloadDraw(NetloadPlugin * netload_plugin)
+{
+    HistoryDraw(&netload_plugin->History, netload_plugin->Plugin,
+	netload_plugin->History.Max[0] + netload_plugin->History.Max[1]);
 }
 
 // ------------------------------------------------------------------------ //
@@ -322,7 +513,6 @@ static void NetloadDraw(NetloadPlugin * netload_plugin)
 static void NetloadCreate(Plugin * plugin)
 {
     NetloadPlugin *netload_plugin;
-    int size;
 
     // create pixmap
     PanelPluginCreatePixmap(plugin);
@@ -333,19 +523,18 @@ static void NetloadCreate(Plugin * plugin)
     Debug(3, "width %d\n", plugin->Width);
 
     // reallocate history buffer
-    size = plugin->Width - NETLOAD_INNER_SPACE * 2;
-    free(netload_plugin->History);
-    netload_plugin->History =
-	calloc(sizeof(*netload_plugin->History), 2 * size);
+    HistoryResize(&netload_plugin->History, plugin);
     if (!netload_plugin->LastRX) {
 	netload_plugin->LastRX = UINT32_MAX;
 	netload_plugin->LastTX = UINT32_MAX;
     }
-    if (netload_plugin->MaxRX < (unsigned)size) {
-	netload_plugin->MaxRX = size;
+    if (netload_plugin->History.Max[0] <
+	(unsigned)netload_plugin->History.Size) {
+	netload_plugin->History.Max[0] = netload_plugin->History.Size;
     }
-    if (netload_plugin->MaxTX < (unsigned)size) {
-	netload_plugin->MaxTX = size;
+    if (netload_plugin->History.Max[1] <
+	(unsigned)netload_plugin->History.Size) {
+	netload_plugin->History.Max[1] = netload_plugin->History.Size;
     }
     // FIXME: is redraw needed?
     // NetloadDraw(netload_plugin);
@@ -358,7 +547,6 @@ static void NetloadCreate(Plugin * plugin)
 */
 static void NetloadResize(Plugin * plugin)
 {
-    PanelPluginDeletePixmap(plugin);
     NetloadCreate(plugin);
 }
 
@@ -429,10 +617,12 @@ static void NetloadTooltip(const Plugin * plugin, int x, int y)
     const char *max_tx_scale;
 
     netload_plugin = plugin->Object;
-    avg_rx = NetloadScale(netload_plugin->AverageRX * 2, &avg_rx_scale);
-    avg_tx = NetloadScale(netload_plugin->AverageTX * 2, &avg_tx_scale);
-    max_rx = NetloadScale(netload_plugin->MaxRX * 2, &max_rx_scale);
-    max_tx = NetloadScale(netload_plugin->MaxTX * 2, &max_tx_scale);
+    avg_rx = NetloadScale(netload_plugin->History.Average[0] * 2,
+	&avg_rx_scale);
+    avg_tx = NetloadScale(netload_plugin->History.Average[1] * 2,
+	&avg_tx_scale);
+    max_rx = NetloadScale(netload_plugin->History.Max[0] * 2, &max_rx_scale);
+    max_tx = NetloadScale(netload_plugin->History.Max[1] * 2, &max_tx_scale);
 
     snprintf(buf, sizeof(buf), "%s: rx:%4u%s<%4u%s/s tx:%4u%s<%4u%s/s",
 	netload_plugin->Interface, avg_rx, avg_rx_scale, max_rx, max_rx_scale,
@@ -460,13 +650,7 @@ static void NetloadTimeout(Plugin
 	NetloadCollect();
 	// all netloads are redrawn by first plugin
 	SLIST_FOREACH(netload_plugin, &Netloads, Next) {
-	    int size;
-
 	    NetloadDraw(netload_plugin);
-	    size = netload_plugin->Plugin->Width - NETLOAD_INNER_SPACE * 2;
-	    memmove(netload_plugin->History, netload_plugin->History + 2,
-		(size - 1) * sizeof(*netload_plugin->History) * 2);
-
 	}
     }
 }
@@ -492,10 +676,10 @@ void NetloadInit(void)
 	height = 16;
 
 	if (!plugin->RequestedWidth) {
-	    plugin->RequestedWidth = width + 2 * NETLOAD_INNER_SPACE;
+	    plugin->RequestedWidth = width + 2 * HISTORY_INNER_SPACE;
 	}
 	if (!plugin->RequestedHeight) {
-	    plugin->RequestedHeight = height + 2 * NETLOAD_INNER_SPACE;
+	    plugin->RequestedHeight = height + 2 * HISTORY_INNER_SPACE;
 	}
     }
 }
@@ -511,13 +695,27 @@ void NetloadExit(void)
 	netload_plugin = SLIST_FIRST(&Netloads);
 
 	free(netload_plugin->Interface);
-	free(netload_plugin->History);
+	free(netload_plugin->History.Values);
 
 	MenuButtonDel(netload_plugin->Buttons);
 
 	SLIST_REMOVE_HEAD(&Netloads, Next);
 	free(netload_plugin);
     }
+
+    free(NetloadInterfaces);
+    NetloadInterfaces = NULL;
+    NetloadInterfaceN = 0;
+    if (ProcNetDevFd >= 0) {
+	close(ProcNetDevFd);
+	ProcNetDevFd = -1;
+    }
+#ifdef USE_NETLOAD_NETLINK
+    if (NetlinkFd >= 0) {
+	close(NetlinkFd);
+    }
+    NetlinkFd = -1;
+#endif
 }
 
 // ------------------------------------------------------------------------ //
@@ -540,13 +738,14 @@ Plugin *NetloadConfig(const ConfigObject * array)
 
     netload_plugin = calloc(1, sizeof(*netload_plugin));
     SLIST_INSERT_HEAD(&Netloads, netload_plugin, Next);
+    netload_plugin->Slot = -1;
 
     // user specified network interface
     if (ConfigStringsGetString(array, &sval, "interface", NULL)) {
 	netload_plugin->Interface = strdup(sval);
     }
     if (ConfigStringsGetBoolean(array, "smooth", NULL) > 0) {
-	netload_plugin->Smooth = 1;
+	netload_plugin->History.Smooth = 1;
     }
     // common config of pointer buttons to commands
     MenuButtonsConfig(array, &netload_plugin->Buttons);
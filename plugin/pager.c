@@ -44,6 +44,12 @@
 
 #include <xcb/xcb_icccm.h>
 #include <xcb/xcb_event.h>
+#ifdef USE_PAGER_THUMBNAIL
+#include <xcb/render.h>
+#include <xcb/xcb_renderutil.h>
+#include <xcb/composite.h>
+#include <xcb/damage.h>
+#endif
 
 #include "queue.h"
 #include "core-array/core-array.h"
@@ -63,6 +69,36 @@
 #include "desktop.h"
 #include "panel.h"
 #include "plugin/pager.h"
+#include "stats.h"
+
+#ifdef USE_PAGER_THUMBNAIL
+
+/**
+**	Pager thumbnail typedef.
+*/
+typedef struct _pager_thumbnail_ PagerThumbnail;
+
+/**
+**	Structure to represent a cached scaled window content on the pager.
+*/
+struct _pager_thumbnail_
+{
+    xcb_window_t Window;		///< client window of thumbnail
+    xcb_damage_damage_t Damage;		///< damage of client window
+    xcb_render_pictformat_t Format;	///< picture format of client window
+
+    xcb_pixmap_t Pixmap;		///< scaled window content
+    xcb_render_picture_t Picture;	///< render picture of pixmap
+    uint16_t Width;			///< width of thumbnail
+    uint16_t Height;			///< height of thumbnail
+
+    uint32_t Serial;			///< incremented on each refresh
+    unsigned Dirty:1;			///< window content changed
+};
+
+static int PagerDamageEvent;		///< first damage event code, 0 none
+
+#endif
 
 /**
 **	Pager plugin typedef.
@@ -86,6 +122,15 @@ struct _pager_plugin_
 
     int32_t ScaleX;			///< horizontal scale factor
     int32_t ScaleY;			///< vertical scale factor
+
+    int DeskHashN;			///< number of desktop hashes
+    uint32_t *DeskHash;			///< hash of drawn desktops
+
+#ifdef USE_PAGER_THUMBNAIL
+    unsigned Thumbnail:1;		///< draw thumbnails of clients
+    uint32_t ThumbnailTick;		///< tick of last thumbnail refresh
+    Array *Thumbnails;			///< thumbnails by client window
+#endif
 };
 
     /// Pager plugin list head structure
@@ -439,70 +484,317 @@ int PagerMoveLoop(Plugin * plugin, int startx, int starty)
 // Draw
 
 /**
-**	Draw a client on the pager.
+**	Get rectangle of a client on the pager.
 **
 **	@param pager_plugin	pager plugin to draw
-**	@param client		client to check and to draw
+**	@param client		client to check
+**	@param[out] rectangle	rectangle of client on pager plugin
+**
+**	@returns desktop of client on pager, -1 if client isn't shown.
 */
-static void PagerDrawClient(const PagerPlugin * pager_plugin,
-    const Client * client)
+static int PagerClientRectangle(const PagerPlugin * pager_plugin,
+    const Client * client, xcb_rectangle_t * rectangle)
 {
-    xcb_rectangle_t rectangle;
+    int desktop;
     int desk_offset;
 
     // don't draw client if it isn't mapped
     if (!(client->State & WM_STATE_MAPPED)) {
-	return;
+	return -1;
     }
     // client shouldn't be shown on pager
     if (client->State & WM_STATE_NOPAGER) {
-	return;
+	return -1;
     }
     // determine the desktop for client
     // FIXME: sticky clients, should be shown on all desktop (with option)
     if (client->State & WM_STATE_STICKY) {
-	desk_offset = DesktopCurrent;
+	desktop = DesktopCurrent;
     } else {
-	desk_offset = client->Desktop;
+	desktop = client->Desktop;
+    }
+    if (desktop < 0 || desktop >= DesktopN) {
+	return -1;
     }
     if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-	desk_offset *= pager_plugin->DeskWidth + 1;
+	desk_offset = desktop * (pager_plugin->DeskWidth + 1);
     } else {
-	desk_offset *= pager_plugin->DeskHeight + 1;
+	desk_offset = desktop * (pager_plugin->DeskHeight + 1);
     }
 
     // determine the location and size of client on the pager
-    rectangle.x = (client->X * pager_plugin->ScaleX + 65536) / 65536;
-    rectangle.y = (client->Y * pager_plugin->ScaleY + 65536) / 65536;
-    rectangle.width = (client->Width * pager_plugin->ScaleX) / 65536;
-    rectangle.height = (client->Height * pager_plugin->ScaleY) / 65536;
+    rectangle->x = (client->X * pager_plugin->ScaleX + 65536) / 65536;
+    rectangle->y = (client->Y * pager_plugin->ScaleY + 65536) / 65536;
+    rectangle->width = (client->Width * pager_plugin->ScaleX) / 65536;
+    rectangle->height = (client->Height * pager_plugin->ScaleY) / 65536;
 
     // stay on pager desktop, fix size and offset
-    if (rectangle.x + rectangle.width > pager_plugin->DeskWidth) {
-	rectangle.width = pager_plugin->DeskWidth - rectangle.x;
+    if (rectangle->x + rectangle->width > pager_plugin->DeskWidth) {
+	rectangle->width = pager_plugin->DeskWidth - rectangle->x;
     }
-    if (rectangle.y + rectangle.height > pager_plugin->DeskHeight) {
-	rectangle.height = pager_plugin->DeskHeight - rectangle.y;
+    if (rectangle->y + rectangle->height > pager_plugin->DeskHeight) {
+	rectangle->height = pager_plugin->DeskHeight - rectangle->y;
     }
-    if (rectangle.x < 0) {
-	rectangle.width += rectangle.x;
-	rectangle.x = 0;
+    if (rectangle->x < 0) {
+	rectangle->width += rectangle->x;
+	rectangle->x = 0;
     }
-    if (rectangle.y < 0) {
-	rectangle.height += rectangle.y;
-	rectangle.y = 0;
+    if (rectangle->y < 0) {
+	rectangle->height += rectangle->y;
+	rectangle->y = 0;
     }
     // return if there's nothing to do
-    if (rectangle.width <= 0 || rectangle.height <= 0) {
-	return;
+    if (rectangle->width <= 0 || rectangle->height <= 0) {
+	return -1;
     }
     // move to the correct desktop on the pager
     if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-	rectangle.x += desk_offset;
+	rectangle->x += desk_offset;
     } else {
-	rectangle.y += desk_offset;
+	rectangle->y += desk_offset;
+    }
+    return desktop;
+}
+
+#ifdef USE_PAGER_THUMBNAIL
+
+/**
+**	Delete a pager thumbnail.
+**
+**	@param thumbnail	thumbnail to delete
+**
+**	@note client window can already be destroyed, the server then has
+**	freed damage and redirection and reports harmless errors.
+*/
+static void PagerThumbnailDel(PagerThumbnail * thumbnail)
+{
+    xcb_damage_destroy(Connection, thumbnail->Damage);
+    xcb_composite_unredirect_window(Connection, thumbnail->Window,
+	XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+    if (thumbnail->Pixmap) {
+	xcb_render_free_picture(Connection, thumbnail->Picture);
+	xcb_free_pixmap(Connection, thumbnail->Pixmap);
+    }
+    free(thumbnail);
+}
+
+/**
+**	Create thumbnail of a client, if it has none.
+**
+**	New clients are redirected and get a damage object, so that their
+**	content is kept off-screen and changes are reported.
+**
+**	@param pager_plugin	pager plugin
+**	@param client		client shown on pager
+*/
+static void PagerThumbnailAdd(PagerPlugin * pager_plugin,
+    const Client * client)
+{
+    PagerThumbnail *thumbnail;
+
+    if (ArrayGet(pager_plugin->Thumbnails, client->Window)) {
+	return;
+    }
+    thumbnail = calloc(1, sizeof(*thumbnail));
+    thumbnail->Window = client->Window;
+    thumbnail->Dirty = 1;
+
+    xcb_composite_redirect_window(Connection, client->Window,
+	XCB_COMPOSITE_REDIRECT_AUTOMATIC);
+    thumbnail->Damage = xcb_generate_id(Connection);
+    xcb_damage_create(Connection, thumbnail->Damage, client->Window,
+	XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+
+    ArrayIns(&pager_plugin->Thumbnails, client->Window, (size_t) thumbnail);
+}
+
+/**
+**	Resize thumbnail to the rectangle of its client on the pager.
+**
+**	@param thumbnail	thumbnail of client
+**	@param rectangle	rectangle of client on pager plugin
+*/
+static void PagerThumbnailResize(PagerThumbnail * thumbnail,
+    const xcb_rectangle_t * rectangle)
+{
+    // thumbnail fills inside of client outline, old content is useless
+    if (thumbnail->Width != rectangle->width - 1
+	|| thumbnail->Height != rectangle->height - 1) {
+	if (thumbnail->Pixmap) {
+	    xcb_render_free_picture(Connection, thumbnail->Picture);
+	    xcb_free_pixmap(Connection, thumbnail->Pixmap);
+	    thumbnail->Pixmap = XCB_NONE;
+	}
+	thumbnail->Width = rectangle->width - 1;
+	thumbnail->Height = rectangle->height - 1;
+	thumbnail->Dirty = 1;
+    }
+}
+
+/**
+**	Render scaled window content into thumbnail.
+**
+**	@param thumbnail	thumbnail to refresh
+**	@param client		viewable client of thumbnail
+**
+**	@returns true if thumbnail was rendered.
+*/
+static int PagerThumbnailRender(PagerThumbnail * thumbnail,
+    const Client * client)
+{
+    const xcb_render_query_pict_formats_reply_t *formats;
+    const xcb_render_pictvisual_t *pictvisual;
+    xcb_pixmap_t pixmap;
+    xcb_render_picture_t src;
+    xcb_render_transform_t transform;
+
+    formats = xcb_render_util_query_formats(Connection);
+    // window format is constant, only needed once
+    if (!thumbnail->Format) {
+	pictvisual = xcb_render_util_find_visual_format(formats,
+	    client->Visual);
+	if (!pictvisual) {
+	    return 0;
+	}
+	thumbnail->Format = pictvisual->format;
     }
 
+    if (!thumbnail->Pixmap) {
+	pictvisual = xcb_render_util_find_visual_format(formats,
+	    XcbScreen->root_visual);
+
+	thumbnail->Pixmap = xcb_generate_id(Connection);
+	xcb_create_pixmap(Connection, XcbScreen->root_depth,
+	    thumbnail->Pixmap, XcbScreen->root, thumbnail->Width,
+	    thumbnail->Height);
+	thumbnail->Picture = xcb_generate_id(Connection);
+	xcb_render_create_picture(Connection, thumbnail->Picture,
+	    thumbnail->Pixmap, pictvisual->format, 0, NULL);
+    }
+    // off-screen content of redirected window
+    pixmap = xcb_generate_id(Connection);
+    xcb_composite_name_window_pixmap(Connection, client->Window, pixmap);
+    src = xcb_generate_id(Connection);
+    xcb_render_create_picture(Connection, src, pixmap, thumbnail->Format, 0,
+	NULL);
+
+    //
+    //	build scaling transformation
+    //
+    transform.matrix11 = (client->Width * 65536) / thumbnail->Width;
+    transform.matrix12 = 0x0000;
+    transform.matrix13 = 0x0000;
+    transform.matrix21 = 0x0000;
+    transform.matrix22 = (client->Height * 65536) / thumbnail->Height;
+    transform.matrix23 = 0x0000;
+    transform.matrix31 = 0x0000;
+    transform.matrix32 = 0x0000;
+    transform.matrix33 = 1 * 65536;
+    xcb_render_set_picture_transform(Connection, src, transform);
+    xcb_render_set_picture_filter(Connection, src, 8, "bilinear", 0, NULL);
+
+    xcb_render_composite(Connection, XCB_RENDER_PICT_OP_SRC, src, XCB_NONE,
+	thumbnail->Picture, 0, 0, 0, 0, 0, 0, thumbnail->Width,
+	thumbnail->Height);
+
+    xcb_render_free_picture(Connection, src);
+    xcb_free_pixmap(Connection, pixmap);
+
+    // rearm damage, next change reports a new event
+    xcb_damage_subtract(Connection, thumbnail->Damage, XCB_NONE, XCB_NONE);
+    thumbnail->Dirty = 0;
+    thumbnail->Serial++;
+
+    return 1;
+}
+
+/**
+**	Check if client has a thumbnail.
+**
+**	Clients hidden by a desktop switch keep their thumbnail, only
+**	unmapped (minimized, withdrawn) clients lose it.
+**
+**	@param client	client to check
+**
+**	@returns true if client needs a thumbnail.
+*/
+static inline int PagerClientHasThumbnail(const Client * client)
+{
+    return (client->State & (WM_STATE_MAPPED | WM_STATE_NOPAGER))
+	== WM_STATE_MAPPED;
+}
+
+/**
+**	Update thumbnails of all pager plugin(s).
+**
+**	Creates thumbnails of mapped clients and deletes thumbnails of
+**	unmapped or removed clients.  Called when clients are mapped or
+**	removed and when desktops are switched, not on each pager update.
+*/
+void PagerUpdateThumbnails(void)
+{
+    PagerPlugin *pager_plugin;
+
+    SLIST_FOREACH(pager_plugin, &Pagers, Next) {
+	size_t index;
+	size_t *value;
+	int i;
+
+	if (!pager_plugin->Thumbnail) {
+	    continue;
+	}
+	index = 0;
+	value = ArrayFirst(pager_plugin->Thumbnails, &index);
+	while (value) {
+	    PagerThumbnail *thumbnail;
+	    const Client *client;
+
+	    thumbnail = (PagerThumbnail *) * value;
+	    if (!(client = ClientFindByChild(thumbnail->Window))
+		|| !PagerClientHasThumbnail(client)) {
+		ArrayDel(&pager_plugin->Thumbnails, index);
+		PagerThumbnailDel(thumbnail);
+	    }
+	    value = ArrayNext(pager_plugin->Thumbnails, &index);
+	}
+	for (i = LAYER_BOTTOM; i <= LAYER_TOP; i++) {
+	    const Client *client;
+
+	    TAILQ_FOREACH(client, &ClientLayers[i], LayerQueue) {
+		if (PagerClientHasThumbnail(client)) {
+		    PagerThumbnailAdd(pager_plugin, client);
+		}
+	    }
+	}
+    }
+}
+
+#endif
+
+/**
+**	Check if client is drawn as active on the pager.
+**
+**	@param client		client to check
+**
+**	@returns true if client is drawn with active color.
+*/
+static inline int PagerClientIsActive(const Client * client)
+{
+    return (client->State & WM_STATE_ACTIVE)
+	&& (client->Desktop == DesktopCurrent
+	|| (client->State & WM_STATE_STICKY));
+}
+
+/**
+**	Draw a client on the pager.
+**
+**	@param pager_plugin	pager plugin to draw
+**	@param client		client to draw
+**	@param rectangle	rectangle of client on pager plugin
+*/
+static void PagerDrawClient(const PagerPlugin * pager_plugin,
+    const Client * client, xcb_rectangle_t rectangle)
+{
     // draw client outline
     xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
 	&Colors.PagerOutline.Pixel);
@@ -513,9 +805,22 @@ static void PagerDrawClient(const PagerPlugin * pager_plugin,
     if (rectangle.width > 1 && rectangle.height > 1) {
 	uint32_t pixel;
 
-	if ((client->State & WM_STATE_ACTIVE)
-	    && (client->Desktop == DesktopCurrent
-		|| (client->State & WM_STATE_STICKY))) {
+#ifdef USE_PAGER_THUMBNAIL
+	const PagerThumbnail *thumbnail;
+
+	if (pager_plugin->Thumbnail
+	    && (thumbnail = (const PagerThumbnail *)
+		ArrayGet(pager_plugin->Thumbnails, client->Window))
+	    && thumbnail->Pixmap && thumbnail->Width == rectangle.width - 1
+	    && thumbnail->Height == rectangle.height - 1) {
+	    xcb_copy_area(Connection, thumbnail->Pixmap,
+		pager_plugin->Plugin->Pixmap, RootGC, 0, 0, rectangle.x + 1,
+		rectangle.y + 1, thumbnail->Width, thumbnail->Height);
+	    return;
+	}
+#endif
+
+	if (PagerClientIsActive(client)) {
 	    pixel = Colors.PagerActiveFG.Pixel;
 	} else {
 	    pixel = Colors.PagerFG.Pixel;
@@ -532,53 +837,171 @@ static void PagerDrawClient(const PagerPlugin * pager_plugin,
 }
 
 /**
-**	Draw pager label.
+**	Draw pager label of a desktop.
 **
 **	@param pager_plugin	pager plugin to draw
+**	@param desktop		desktop number of label
 */
-static void PagerDrawLabel(const PagerPlugin * pager_plugin)
+static void PagerDrawLabel(const PagerPlugin * pager_plugin, int desktop)
 {
-    int i;
     int x;
     int y;
     const Plugin *plugin;
-    xcb_pixmap_t pixmap;
-    unsigned width;
-    unsigned height;
     unsigned desk_width;
     unsigned desk_height;
     unsigned text_width;
     unsigned text_height;
+    const char *name;
+    xcb_query_text_extents_cookie_t cookie;
 
     plugin = pager_plugin->Plugin;
-    pixmap = plugin->Pixmap;
-    width = plugin->Width;
-    height = plugin->Height;
-    desk_width = pager_plugin->DeskWidth;
     desk_width = pager_plugin->DeskWidth;
     desk_height = pager_plugin->DeskHeight;
 
     text_height = Fonts.Pager.Height;
-    if (text_height < desk_height) {
-	for (i = 0; i < DesktopN; i++) {
-	    const char *name;
-	    xcb_query_text_extents_cookie_t cookie;
-
-	    name = DesktopGetName(i);
-	    cookie = FontQueryExtentsRequest(&Fonts.Pager, strlen(name), name);
-	    text_width = FontTextWidthReply(cookie);
-
-	    if (text_width < desk_width) {
-		if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-		    x = i * (desk_width + 1) + desk_width / 2 - text_width / 2;
-		    y = height / 2 - text_height / 2;
-		} else {
-		    x = width / 2 - text_width / 2;
-		    y = i * (desk_height + 1) + desk_height / 2 -
-			text_height / 2;
+    if (text_height >= desk_height) {
+	return;
+    }
+    name = DesktopGetName(desktop);
+    cookie = FontQueryExtentsRequest(&Fonts.Pager, strlen(name), name);
+    text_width = FontTextWidthReply(cookie);
+
+    if (text_width < desk_width) {
+	if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
+	    x = desktop * (desk_width + 1) + desk_width / 2 - text_width / 2;
+	    y = plugin->Height / 2 - text_height / 2;
+	} else {
+	    x = plugin->Width / 2 - text_width / 2;
+	    y = desktop * (desk_height + 1) + desk_height / 2 -
+		text_height / 2;
+	}
+	FontDrawString(plugin->Pixmap, &Fonts.Pager, Colors.PagerText.Pixel,
+	    x, y, desk_width, NULL, name);
+    }
+}
+
+/**
+**	Get area of a desktop on the pager.
+**
+**	@param pager_plugin	pager plugin
+**	@param desktop		desktop number
+**	@param[out] rectangle	area of desktop on pager plugin
+*/
+static void PagerDeskRectangle(const PagerPlugin * pager_plugin, int desktop,
+    xcb_rectangle_t * rectangle)
+{
+    if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
+	rectangle->x = desktop * (pager_plugin->DeskWidth + 1);
+	rectangle->y = 0;
+	rectangle->width = pager_plugin->DeskWidth;
+	rectangle->height = pager_plugin->Plugin->Height;
+    } else {
+	rectangle->x = 0;
+	rectangle->y = desktop * (pager_plugin->DeskHeight + 1);
+	rectangle->width = pager_plugin->Plugin->Width;
+	rectangle->height = pager_plugin->DeskHeight;
+    }
+}
+
+/**
+**	Draw a single desktop of pager.
+**
+**	@param pager_plugin	pager plugin to draw
+**	@param desktop		desktop number to draw
+*/
+static void PagerDrawDesk(const PagerPlugin * pager_plugin, int desktop)
+{
+    xcb_rectangle_t rectangle;
+    int i;
+
+    StatsRedrawCount(STATS_REDRAW_PAGER);
+
+    // draw background, highlight current desktop
+    PagerDeskRectangle(pager_plugin, desktop, &rectangle);
+    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	desktop == DesktopCurrent ? &Colors.PagerActiveBG.Pixel :
+	&Colors.PagerBG.Pixel);
+    xcb_poly_fill_rectangle(Connection, pager_plugin->Plugin->Pixmap, RootGC,
+	1, &rectangle);
+
+    // draw clients (bottom to top)
+    for (i = LAYER_BOTTOM; i <= LAYER_TOP; i++) {
+	const Client *client;
+
+	TAILQ_FOREACH_REVERSE(client, &ClientLayers[i], _client_layer_,
+	    LayerQueue) {
+	    if (PagerClientRectangle(pager_plugin, client,
+		    &rectangle) == desktop) {
+		PagerDrawClient(pager_plugin, client, rectangle);
+	    }
+	}
+    }
+
+    // draw label
+    if (pager_plugin->Labeled) {
+	PagerDrawLabel(pager_plugin, desktop);
+    }
+}
+
+/**
+**	Hash the content of all desktops of pager.
+**
+**	The hash covers everything drawn for a desktop: current desktop
+**	highlight, desktop name and rectangle and color of each client in
+**	stacking order.  With thumbnails, the refresh serial of the client
+**	thumbnail too.  Only reads state, sends no requests.
+**
+**	@param pager_plugin	pager plugin
+**	@param[out] hash	hash for each desktop
+*/
+static void PagerHashDesks(const PagerPlugin * pager_plugin, uint32_t * hash)
+{
+    int i;
+
+    for (i = 0; i < DesktopN; i++) {	// FNV-1a
+	const char *s;
+
+	hash[i] = 2166136261U ^ (i == DesktopCurrent);
+	if (pager_plugin->Labeled) {
+	    for (s = DesktopGetName(i); *s; ++s) {
+		hash[i] = (hash[i] ^ (uint8_t) * s) * 16777619U;
+	    }
+	}
+    }
+    for (i = LAYER_BOTTOM; i <= LAYER_TOP; i++) {
+	const Client *client;
+
+	TAILQ_FOREACH_REVERSE(client, &ClientLayers[i], _client_layer_,
+	    LayerQueue) {
+	    xcb_rectangle_t rectangle;
+	    uint32_t values[6];
+	    int desktop;
+	    int j;
+
+	    if ((desktop =
+		    PagerClientRectangle(pager_plugin, client,
+			&rectangle)) < 0) {
+		continue;
+	    }
+	    values[0] = rectangle.x;
+	    values[1] = rectangle.y;
+	    values[2] = rectangle.width;
+	    values[3] = rectangle.height;
+	    values[4] = PagerClientIsActive(client);
+	    values[5] = 0;
+#ifdef USE_PAGER_THUMBNAIL
+	    if (pager_plugin->Thumbnail) {
+		const PagerThumbnail *thumbnail;
+
+		if ((thumbnail = (const PagerThumbnail *)
+			ArrayGet(pager_plugin->Thumbnails, client->Window))
+		    && thumbnail->Pixmap) {
+		    values[5] = thumbnail->Serial + 1;
 		}
-		FontDrawString(pixmap, &Fonts.Pager, Colors.PagerText.Pixel, x,
-		    y, desk_width, NULL, name);
+	    }
+#endif
+	    for (j = 0; j < 6; ++j) {
+		hash[desktop] = (hash[desktop] ^ values[j]) * 16777619U;
 	    }
 	}
     }
@@ -586,10 +1009,13 @@ static void PagerDrawLabel(const PagerPlugin * pager_plugin)
 
 /**
 **	Update all pager plugin(s).
+**
+**	Only desktops whose content changed are redrawn and copied to the
+**	panel.
 */
 void PagerUpdate(void)
 {
-    const PagerPlugin *pager_plugin;
+    PagerPlugin *pager_plugin;
 
     if (!KeepLooping) {			// no work if exiting
 	return;
@@ -606,53 +1032,50 @@ void PagerUpdate(void)
 
     SLIST_FOREACH(pager_plugin, &Pagers, Next) {
 	xcb_pixmap_t pixmap;
-	xcb_rectangle_t rectangle;
 	const Plugin *plugin;
-	unsigned desk_width;
-	unsigned desk_height;
+	uint32_t *hash;
 	unsigned width;
 	unsigned height;
+	int full;
 	int i;
 
 	plugin = pager_plugin->Plugin;
-	// draw background
-	PanelClearPluginBackgroundWithColor(plugin, &Colors.PagerBG.Pixel);
-
+	if (!plugin->Pixmap) {		// not yet created
+	    continue;
+	}
 	pixmap = plugin->Pixmap;
 	width = plugin->Width;
 	height = plugin->Height;
-	desk_width = pager_plugin->DeskWidth;
-	desk_height = pager_plugin->DeskHeight;
 
-	// highlight current desktop
-	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
-	    &Colors.PagerActiveBG.Pixel);
-	if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-	    rectangle.x = DesktopCurrent * (desk_width + 1);
-	    rectangle.y = 0;
-	    rectangle.width = desk_width;
-	    rectangle.height = height;
-	} else {
-	    rectangle.x = 0;
-	    rectangle.y = DesktopCurrent * (desk_height + 1);
-	    rectangle.width = width;
-	    rectangle.height = desk_height;
+	hash = alloca(DesktopN * sizeof(*hash));
+	PagerHashDesks(pager_plugin, hash);
+
+	// desktops changed or after resize: draw everything
+	full = pager_plugin->DeskHashN != DesktopN;
+	if (full) {
+	    free(pager_plugin->DeskHash);
+	    pager_plugin->DeskHash = malloc(DesktopN * sizeof(*hash));
+	    pager_plugin->DeskHashN = DesktopN;
+	    PanelClearPluginBackgroundWithColor(plugin,
+		&Colors.PagerBG.Pixel);
 	}
-	xcb_poly_fill_rectangle(Connection, pixmap, RootGC, 1, &rectangle);
 
-	// draw clients (bottom to top)
-	for (i = LAYER_BOTTOM; i <= LAYER_TOP; i++) {
-	    const Client *client;
+	for (i = 0; i < DesktopN; i++) {
+	    xcb_rectangle_t rectangle;
 
-	    TAILQ_FOREACH_REVERSE(client, &ClientLayers[i], _client_layer_,
-		LayerQueue) {
-		PagerDrawClient(pager_plugin, client);
+	    if (!full && hash[i] == pager_plugin->DeskHash[i]) {
+		continue;
+	    }
+	    pager_plugin->DeskHash[i] = hash[i];
+	    PagerDrawDesk(pager_plugin, i);
+	    if (!full) {
+		PagerDeskRectangle(pager_plugin, i, &rectangle);
+		PanelUpdatePluginArea(plugin->Panel, plugin, rectangle.x,
+		    rectangle.y, rectangle.width, rectangle.height);
 	    }
 	}
-
-	// draw labels
-	if (pager_plugin->Labeled) {
-	    PagerDrawLabel(pager_plugin);
+	if (!full) {
+	    continue;
 	}
 	// draw desktop dividers
 	xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
@@ -661,15 +1084,15 @@ void PagerUpdate(void)
 	    xcb_point_t points[2];
 
 	    if (pager_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-		points[0].x = (desk_width + 1) * i - 1;
+		points[0].x = (pager_plugin->DeskWidth + 1) * i - 1;
 		points[0].y = 0;
-		points[1].x = (desk_width + 1) * i - 1;
+		points[1].x = (pager_plugin->DeskWidth + 1) * i - 1;
 		points[1].y = height;
 	    } else {
 		points[0].x = 0;
-		points[0].y = (desk_height + 1) * i - 1;
+		points[0].y = (pager_plugin->DeskHeight + 1) * i - 1;
 		points[1].x = width;
-		points[1].y = (desk_height + 1) * i - 1;
+		points[1].y = (pager_plugin->DeskHeight + 1) * i - 1;
 	    }
 	    xcb_poly_line(Connection, XCB_COORD_MODE_ORIGIN, pixmap, RootGC, 2,
 		points);
@@ -690,9 +1113,12 @@ void PagerUpdate(void)
 */
 static void PagerResize(Plugin * plugin)
 {
-    PanelPluginDeletePixmap(plugin);
-    PanelPluginCreatePixmap(plugin);
-    // FIXME: only current needs a redraw
+    PagerPlugin *pager_plugin;
+
+    PanelPluginCreatePixmap(plugin);	// reuses pixmap of same size
+
+    pager_plugin = plugin->Object;
+    pager_plugin->DeskHashN = 0;	// force full redraw
     PagerUpdate();
 }
 
@@ -800,16 +1226,163 @@ static void PagerHandleButtonPress(Plugin * plugin, int x, int y, int mask)
     }
 }
 
+#ifdef USE_PAGER_THUMBNAIL
+
+/**
+**	Pager panel plugin timeout method.
+**
+**	Refresh changed thumbnails, at most every #PAGER_THUMBNAIL_DELAY ms.
+**	Only viewable clients have content, hidden ones keep their last
+**	thumbnail.
+**
+**	@param plugin	common panel plugin data of pager
+**	@param tick	current tick in ms
+**	@param x	current mouse x-coordinate
+**	@param y	current mouse y-coordinate
+*/
+static void PagerTimeout(Plugin * plugin, uint32_t tick, int
+    __attribute__((unused)) x, int __attribute__((unused)) y)
+{
+    PagerPlugin *pager_plugin;
+    size_t index;
+    size_t *value;
+    int refreshed;
+
+    pager_plugin = plugin->Object;
+    if (!pager_plugin->Thumbnail) {
+	return;
+    }
+    if (pager_plugin->ThumbnailTick <= tick
+	&& tick < pager_plugin->ThumbnailTick + PAGER_THUMBNAIL_DELAY) {
+	return;
+    }
+    pager_plugin->ThumbnailTick = tick;
+
+    refreshed = 0;
+    index = 0;
+    value = ArrayFirst(pager_plugin->Thumbnails, &index);
+    while (value) {
+	PagerThumbnail *thumbnail;
+	const Client *client;
+
+	thumbnail = (PagerThumbnail *) * value;
+	if ((client = ClientFindByChild(thumbnail->Window))
+	    && (client->State & (WM_STATE_MAPPED | WM_STATE_HIDDEN |
+		    WM_STATE_SHADED)) == WM_STATE_MAPPED) {
+	    xcb_rectangle_t rectangle;
+
+	    // thumbnail fills inside of client outline
+	    if (PagerClientRectangle(pager_plugin, client, &rectangle) >= 0
+		&& rectangle.width > 1 && rectangle.height > 1) {
+		PagerThumbnailResize(thumbnail, &rectangle);
+		if (thumbnail->Dirty) {
+		    refreshed |= PagerThumbnailRender(thumbnail, client);
+		}
+	    }
+	}
+	value = ArrayNext(pager_plugin->Thumbnails, &index);
+    }
+    if (refreshed) {
+	PagerUpdate();
+    }
+}
+
+/**
+**	Handle a damage notify event.
+**
+**	Only marks thumbnail dirty, refresh is done by pager timeout.
+**
+**	@param event	X11 generic event
+**
+**	@returns true if event was a damage notify event.
+*/
+int PagerHandleDamageNotify(const xcb_generic_event_t * event)
+{
+    const xcb_damage_notify_event_t *damage_notify;
+    PagerPlugin *pager_plugin;
+
+    if (!PagerDamageEvent
+	|| XCB_EVENT_RESPONSE_TYPE(event) !=
+	PagerDamageEvent + XCB_DAMAGE_NOTIFY) {
+	return 0;
+    }
+    damage_notify = (const xcb_damage_notify_event_t *)event;
+
+    SLIST_FOREACH(pager_plugin, &Pagers, Next) {
+	PagerThumbnail *thumbnail;
+
+	if ((thumbnail = (PagerThumbnail *)
+		ArrayGet(pager_plugin->Thumbnails, damage_notify->drawable))
+	    && thumbnail->Damage == damage_notify->damage) {
+	    thumbnail->Dirty = 1;
+	}
+    }
+    return 1;
+}
+
+#endif
+
 // ------------------------------------------------------------------------ //
 
-#if 0
+#ifdef USE_PAGER_THUMBNAIL
 
 /**
 **	Initialize the pager panel plugin.
+**
+**	Enable composite and damage extensions, if thumbnails are wanted.
+**	Without them pager thumbnails are disabled.
 */
 void PagerInit(void)
 {
+    PagerPlugin *pager_plugin;
+    const xcb_query_extension_reply_t *composite;
+    const xcb_query_extension_reply_t *damage;
+    xcb_composite_query_version_cookie_t composite_cookie;
+    xcb_damage_query_version_cookie_t damage_cookie;
+    xcb_composite_query_version_reply_t *composite_reply;
+    xcb_damage_query_version_reply_t *damage_reply;
+
+    PagerDamageEvent = 0;
+    SLIST_FOREACH(pager_plugin, &Pagers, Next) {
+	if (pager_plugin->Thumbnail) {
+	    break;
+	}
+    }
+    if (!pager_plugin) {		// no pager wants thumbnails
+	return;
+    }
+
+    composite = xcb_get_extension_data(Connection, &xcb_composite_id);
+    damage = xcb_get_extension_data(Connection, &xcb_damage_id);
+    if (HaveRender && composite->present && damage->present) {
+	// versions must be announced, before extensions can be used
+	composite_cookie = xcb_composite_query_version(Connection, 0, 2);
+	damage_cookie = xcb_damage_query_version(Connection, 1, 1);
+	composite_reply = StatsReply(xcb_composite_query_version_reply,
+	    composite_cookie, NULL);
+	damage_reply = StatsReply(xcb_damage_query_version_reply,
+	    damage_cookie, NULL);
+
+	// NameWindowPixmap needs composite 0.2
+	if (composite_reply && damage_reply
+	    && (composite_reply->major_version
+		|| composite_reply->minor_version >= 2)) {
+	    PagerDamageEvent = damage->first_event;
+	}
+	free(composite_reply);
+	free(damage_reply);
+    }
+
+    if (!PagerDamageEvent) {
+	Warning("composite, damage or render missing, no pager thumbnails\n");
+	SLIST_FOREACH(pager_plugin, &Pagers, Next) {
+	    pager_plugin->Thumbnail = 0;
+	}
+	return;
+    }
+    PagerUpdateThumbnails();		// clients of a config reload
 }
+
 #endif
 
 /**
@@ -823,6 +1396,21 @@ void PagerExit(void)
 	pager_plugin = SLIST_FIRST(&Pagers);
 
 	SLIST_REMOVE_HEAD(&Pagers, Next);
+	free(pager_plugin->DeskHash);
+#ifdef USE_PAGER_THUMBNAIL
+	if (pager_plugin->Thumbnails) {
+	    size_t index;
+	    size_t *value;
+
+	    index = 0;
+	    value = ArrayFirst(pager_plugin->Thumbnails, &index);
+	    while (value) {
+		PagerThumbnailDel((PagerThumbnail *) * value);
+		value = ArrayNext(pager_plugin->Thumbnails, &index);
+	    }
+	    ArrayFree(pager_plugin->Thumbnails);
+	}
+#endif
 	free(pager_plugin);
     }
 }
@@ -853,6 +1441,12 @@ Plugin *PagerConfig(const ConfigObject * array)
     if (ConfigStringsGetBoolean(array, "sticky", NULL) > 0) {
 	pager_plugin->Sticky = 1;
     }
+#ifdef USE_PAGER_THUMBNAIL
+    if (ConfigStringsGetBoolean(array, "thumbnail", NULL) > 0) {
+	pager_plugin->Thumbnail = 1;
+	pager_plugin->Thumbnails = ArrayNew();
+    }
+#endif
 
     plugin = PanelPluginNew();
     plugin->Object = pager_plugin;
@@ -864,6 +1458,9 @@ Plugin *PagerConfig(const ConfigObject * array)
     plugin->SetSize = PagerSetSize;
     plugin->Tooltip = PagerTooltip;
     plugin->HandleButtonPress = PagerHandleButtonPress;
+#ifdef USE_PAGER_THUMBNAIL
+    plugin->Timeout = PagerTimeout;
+#endif
 
     return plugin;
 }
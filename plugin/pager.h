@@ -34,14 +34,24 @@ extern void PagerUpdate(void);
     /// Initialize pager panel plugin.
 extern void PagerInit(void);
 
+    /// Handle a damage notify event.
+extern int PagerHandleDamageNotify(const xcb_generic_event_t *);
+
+    /// Update thumbnails of all pager plugin(s).
+extern void PagerUpdateThumbnails(void);
+
     /// Cleanup pager panel plugin.
 extern void PagerExit(void);
 
     /// Parse pager panel plugin configuration.
 Plugin *PagerConfig(const ConfigObject *);
 
+#ifndef USE_PAGER_THUMBNAIL		// {
     /// Dummy for initialize panel plugin.
 #define PagerInit()
+    /// Dummy for update thumbnails of all pager plugin(s).
+#define PagerUpdateThumbnails()
+#endif // } !USE_PAGER_THUMBNAIL
 
 #ifndef USE_PAGER			// {
     /// Dummy for update all pager plugin(s).
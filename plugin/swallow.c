@@ -55,6 +55,7 @@
 
 #include "panel.h"
 #include "plugin/swallow.h"
+#include "stats.h"
 
 /**
 **	Swallow plugin typedef.
@@ -83,20 +84,56 @@ SLIST_HEAD(_swallow_head_, _swallow_plugin_);
     /// list of all swallows of plugin
 static struct _swallow_head_ Swallows = SLIST_HEAD_INITIALIZER(Swallows);
 
+    /// owned swallow windows kept running over reload/restart
+static xcb_window_t *SwallowKept;
+static int SwallowKeptN;		///< number of kept swallow windows
+
 // ------------------------------------------------------------------------ //
 // Callbacks
 
+/**
+**	Close an owned swallow window.
+**
+**	@param window	x11 window id of swallowed client
+*/
+static void SwallowClose(xcb_window_t window)
+{
+    xcb_get_property_cookie_t cookie;
+    xcb_icccm_get_wm_protocols_reply_t protocols;
+
+    cookie =
+	xcb_icccm_get_wm_protocols_unchecked(Connection, window,
+	Atoms.WM_PROTOCOLS.Atom);
+
+    // check if client supports WM_DELETE_WINDOW
+    if (StatsReply(xcb_icccm_get_wm_protocols_reply, cookie, &protocols,
+	    NULL)) {
+	unsigned u;
+
+	for (u = 0; u < protocols.atoms_len; ++u) {
+	    if (protocols.atoms[u] == Atoms.WM_DELETE_WINDOW.Atom) {
+		ClientSendDeleteWindow(window);
+		xcb_icccm_get_wm_protocols_reply_wipe(&protocols);
+		return;
+	    }
+	}
+	xcb_icccm_get_wm_protocols_reply_wipe(&protocols);
+    }
+    xcb_kill_client(Connection, window);
+}
+
 /**
 **	Destroy a swallow panel plugin.
 **
+**	With #KeepRunning (reload/restart) owned windows are only given
+**	back to the root window and swallowed again by the new plugins.
+**
 **	@param plugin	common panel plugin data
 */
 static void SwallowDelete(Plugin * plugin)
 {
     // destroy window if there is one
     if (plugin->Window) {
-	xcb_get_property_cookie_t cookie;
-	xcb_icccm_get_wm_protocols_reply_t protocols;
 	SwallowPlugin *swallow_plugin;
 
 	xcb_reparent_window(Connection, plugin->Window, XcbScreen->root, 0, 0);
@@ -107,27 +144,13 @@ static void SwallowDelete(Plugin * plugin)
 	if (swallow_plugin->UseOld || !swallow_plugin->Command) {
 	    return;
 	}
-
-	cookie =
-	    xcb_icccm_get_wm_protocols_unchecked(Connection, plugin->Window,
-	    Atoms.WM_PROTOCOLS.Atom);
-
-	// FIXME: move into functions...
-	// check if client supports WM_DELETE_WINDOW
-	if (xcb_icccm_get_wm_protocols_reply(Connection, cookie, &protocols,
-		NULL)) {
-	    unsigned u;
-
-	    for (u = 0; u < protocols.atoms_len; ++u) {
-		if (protocols.atoms[u] == Atoms.WM_DELETE_WINDOW.Atom) {
-		    ClientSendDeleteWindow(plugin->Window);
-		    xcb_icccm_get_wm_protocols_reply_wipe(&protocols);
-		    return;
-		}
-	    }
-	    xcb_icccm_get_wm_protocols_reply_wipe(&protocols);
+	if (KeepRunning) {
+	    SwallowKept = realloc(SwallowKept,
+		(SwallowKeptN + 1) * sizeof(*SwallowKept));
+	    SwallowKept[SwallowKeptN++] = plugin->Window;
+	    return;
 	}
-	xcb_kill_client(Connection, plugin->Window);
+	SwallowClose(plugin->Window);
     }
 }
 
@@ -185,13 +208,24 @@ int SwallowTryWindow(int already_mapped, xcb_window_t window)
 	}
 	if (already_mapped && swallow_plugin->Command
 	    && !swallow_plugin->UseOld) {
+	    int i;
+
+	    // kept windows were started by us
+	    for (i = 0; i < SwallowKeptN; ++i) {
+		if (SwallowKept[i] == window) {
+		    break;
+		}
+	    }
 	    // without command, can only use already mapped clients
-	    continue;			// don't use old clients
+	    if (i == SwallowKeptN) {
+		continue;		// don't use old clients
+	    }
 	}
 	// request class hints, if not already done
 	if (!cookie.sequence) {
 	    cookie = xcb_icccm_get_wm_class_unchecked(Connection, window);
-	    if (!xcb_icccm_get_wm_class_reply(Connection, cookie, &prop, NULL)) {
+	    if (!StatsReply(xcb_icccm_get_wm_class_reply, cookie, &prop,
+		    NULL)) {
 		return 0;		// can't get hints, give up
 	    }
 	    // not null terminated class is a xcb bug!
@@ -204,6 +238,7 @@ int SwallowTryWindow(int already_mapped, xcb_window_t window)
 	    uint32_t value[1];
 	    xcb_get_geometry_cookie_t cookie;
 	    xcb_get_geometry_reply_t *geom;
+	    int i;
 
 	    cookie = xcb_get_geometry_unchecked(Connection, window);
 
@@ -218,8 +253,8 @@ int SwallowTryWindow(int already_mapped, xcb_window_t window)
 	    xcb_change_save_set(Connection, XCB_SET_MODE_INSERT, window);
 	    xcb_change_window_attributes(Connection, window,
 		XCB_CW_BORDER_PIXEL, &Colors.PanelBG.Pixel);
-	    xcb_reparent_window(Connection, window, plugin->Panel->Window, 0,
-		0);
+	    xcb_reparent_window(Connection, window, plugin->Panel->Window,
+		plugin->X, plugin->Y);
 	    // raise window
 	    // FIXME: didn't must be above panel?
 	    value[0] = XCB_STACK_MODE_ABOVE;
@@ -229,9 +264,14 @@ int SwallowTryWindow(int already_mapped, xcb_window_t window)
 	    xcb_map_window(Connection, window);
 
 	    plugin->Window = window;
+	    for (i = 0; i < SwallowKeptN; ++i) {
+		if (SwallowKept[i] == window) {
+		    SwallowKept[i] = XCB_NONE;
+		}
+	    }
 
 	    // update size (FIXME: only if not all user)
-	    geom = xcb_get_geometry_reply(Connection, cookie, NULL);
+	    geom = StatsReply(xcb_get_geometry_reply, cookie, NULL);
 	    if (geom) {
 		Debug(3, "swallow '%s' %dx%d border %d\n", prop.instance_name,
 		    geom->width, geom->height, geom->border_width);
@@ -248,6 +288,7 @@ int SwallowTryWindow(int already_mapped, xcb_window_t window)
 	    } else {
 		Warning("Can't get geometry, expect errors\n");
 	    }
+	    plugin->LayoutDirty = 1;	// new window needs plugin size
 	    PanelResize(plugin->Panel);
 
 	    xcb_icccm_get_wm_class_reply_wipe(&prop);
@@ -379,6 +420,7 @@ int SwallowHandleResizeRequest(const xcb_resize_request_event_t * event)
 void SwallowInit(void)
 {
     SwallowPlugin *swallow_plugin;
+    int i;
 
 #ifdef DEBUG
     // clients need to be initialized before this plugin!
@@ -393,6 +435,15 @@ void SwallowInit(void)
 	    CommandRun(swallow_plugin->Command);
 	}
     }
+    // kept windows no longer swallowed by the new configuration
+    for (i = 0; i < SwallowKeptN; ++i) {
+	if (SwallowKept[i]) {
+	    SwallowClose(SwallowKept[i]);
+	}
+    }
+    free(SwallowKept);
+    SwallowKept = NULL;
+    SwallowKeptN = 0;
 }
 
 /**
@@ -67,6 +67,7 @@
 
 #include "panel.h"
 #include "plugin/systray.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 
@@ -84,6 +85,18 @@ struct _systray_window_
 
     xcb_window_t Window;		///< docked window self
     unsigned NeedsReparent:1;		///< flag docked window must reparent
+    unsigned GeometryPending:1;		///< geometry request is pending
+
+    /// pipelined geometry request, send on dock
+    xcb_get_geometry_cookie_t Cookie;
+
+    uint16_t RequestedWidth;		///< size wanted by docked window
+    uint16_t RequestedHeight;		///< size wanted by docked window
+
+    int16_t X;				///< last known x-coordinate in tray
+    int16_t Y;				///< last known y-coordinate in tray
+    uint16_t Width;			///< last known width in tray
+    uint16_t Height;			///< last known height in tray
 };
 
 /**
@@ -123,10 +136,33 @@ static SystrayPlugin *Systray;		///< only one systray plugin
 
 // ------------------------------------------------------------------------ //
 
+/**
+**	Collect pending geometry reply of a docked window.
+**
+**	@param docked	docked window with pending geometry request
+*/
+static void SystrayGeometryReply(SystrayWindow * docked)
+{
+    xcb_get_geometry_reply_t *reply;
+
+    docked->GeometryPending = 0;
+    if ((reply = StatsReply(xcb_get_geometry_reply, docked->Cookie, NULL))) {
+	Debug(3, "\twindow %dx%d\n", reply->width, reply->height);
+	// resize/configure requests can already have given us a size
+	if (!docked->RequestedWidth || !docked->RequestedHeight) {
+	    docked->RequestedWidth = reply->width;
+	    docked->RequestedHeight = reply->height;
+	}
+	free(reply);
+    }
+}
+
 /**
 **	Layout items on systray.
 **
-**	@todo FIXME: split request/reply
+**	Only docked windows, whose slot or size has changed are reconfigured.
+**	Geometry of docked windows is tracked from events, only newly docked
+**	windows have a geometry request pending, which was send on dock.
 */
 static void SystrayUpdate(void)
 {
@@ -155,48 +191,62 @@ static void SystrayUpdate(void)
 	int yoffset;
 	int width;
 	int height;
-	xcb_get_geometry_cookie_t cookie;
-	xcb_get_geometry_reply_t *geom_reply;
 	uint32_t values[4];
 	xcb_configure_notify_event_t event;
 
+	if (docked->GeometryPending) {
+	    SystrayGeometryReply(docked);
+	}
+
 	xoffset = 0;
 	yoffset = 0;
 
 	width = item_width;
 	height = item_height;
 
-	cookie = xcb_get_geometry_unchecked(Connection, docked->Window);
-	geom_reply = xcb_get_geometry_reply(Connection, cookie, NULL);
-	if (geom_reply) {
+	if (docked->RequestedWidth && docked->RequestedHeight) {
 	    int ratio;
 
-	    Debug(3, "\twindow %dx%d\n", geom_reply->width,
-		geom_reply->height);
 	    // keep window aspect ratio
-	    ratio = (geom_reply->width * 65535) / geom_reply->height;
+	    ratio = (docked->RequestedWidth * 65535) / docked->RequestedHeight;
 
 	    if (ratio > 65535) {
-		if (width > geom_reply->width) {
-		    width = geom_reply->width;
+		if (width > docked->RequestedWidth) {
+		    width = docked->RequestedWidth;
 		}
 		height = (width * 65535) / ratio;
 	    } else {
-		if (height > geom_reply->height) {
-		    height = geom_reply->height;
+		if (height > docked->RequestedHeight) {
+		    height = docked->RequestedHeight;
 		}
 		width = (height * ratio) / 65535;
 	    }
 
 	    xoffset = (item_width - width) / 2;
 	    yoffset = (item_height - height) / 2;
+	}
 
-	    free(geom_reply);
+	if (docked->NeedsReparent) {
+	    docked->NeedsReparent = 0;
+	    xcb_reparent_window(Connection, docked->Window,
+		Systray->Plugin->Window, x + xoffset, y + yoffset);
+	    // reparent moves window, force configure
+	    docked->Width = 0;
+	}
+	// slot unchanged, nothing to do
+	if (docked->X == x + xoffset && docked->Y == y + yoffset
+	    && docked->Width == width && docked->Height == height) {
+	    goto next;
 	}
 
 	Debug(3, "\t -> %dx%d%+d%+d\n", width, height, x + xoffset,
 	    y + yoffset);
 
+	docked->X = x + xoffset;
+	docked->Y = y + yoffset;
+	docked->Width = width;
+	docked->Height = height;
+
 	values[0] = x + xoffset;
 	values[1] = y + yoffset;
 	values[2] = width;
@@ -224,11 +274,7 @@ static void SystrayUpdate(void)
 	xcb_send_event(Connection, XCB_SEND_EVENT_DEST_POINTER_WINDOW,
 	    docked->Window, XCB_EVENT_MASK_STRUCTURE_NOTIFY, (void *)&event);
 
-	if (docked->NeedsReparent) {
-	    xcb_reparent_window(Connection, docked->Window,
-		Systray->Plugin->Window, x + xoffset, y + yoffset);
-	}
-
+      next:
 	if (Systray->Orientation == _NET_SYSTEM_TRAY_ORIENTATION_HORZ) {
 	    x += item_width;
 	} else {
@@ -245,6 +291,7 @@ static void SystrayUpdate(void)
 static void SystrayAddWindow(xcb_window_t window)
 {
     SystrayWindow *docked;
+    SystrayWindow *last;
     uint32_t value;
 
     Debug(3, "%s: %x\n", __FUNCTION__, window);
@@ -257,17 +304,26 @@ static void SystrayAddWindow(xcb_window_t window)
 	return;
     }
     // if this window is already in systray, ignore it
+    last = NULL;
     SLIST_FOREACH(docked, &Systray->Docked, Next) {
 	if (docked->Window == window) {
 	    Debug(2, "window is already docked in systray\n");
 	    return;
 	}
+	last = docked;
     }
 
-    // add window to our list
+    // add window to end of our list, other windows keep their slots
     docked = calloc(1, sizeof(*docked));
-    SLIST_INSERT_HEAD(&Systray->Docked, docked, Next);
+    if (last) {
+	SLIST_INSERT_AFTER(last, docked, Next);
+    } else {
+	SLIST_INSERT_HEAD(&Systray->Docked, docked, Next);
+    }
     docked->Window = window;
+    // reply is collected on layout, request is pipelined with following
+    docked->Cookie = xcb_get_geometry_unchecked(Connection, window);
+    docked->GeometryPending = 1;
 
     xcb_change_save_set(Connection, XCB_SET_MODE_INSERT, window);
 
@@ -329,15 +385,12 @@ int SystrayHandleResizeRequest(const xcb_resize_request_event_t * event)
     SLIST_FOREACH(docked, &Systray->Docked, Next) {
 	// look if this window is docked
 	if (docked->Window == event->window) {
-	    uint32_t values[2];
-
-	    // resize window
-	    values[0] = event->width;
-	    values[1] = event->height;
-	    xcb_configure_window(Connection, docked->Window,
-		XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+	    // remember wanted size, layout resizes window into its slot
+	    docked->RequestedWidth = event->width;
+	    docked->RequestedHeight = event->height;
+	    // force configure, tells window the result of its request
+	    docked->Width = 0;
 
-	    // FIXME: this reresizes the window
 	    SystrayUpdate();
 	    return 1;
 	}
@@ -363,23 +416,21 @@ int SystrayHandleConfigureRequest(const xcb_configure_request_event_t * event)
     SLIST_FOREACH(docked, &Systray->Docked, Next) {
 	// look if this window is docked
 	if (docked->Window == event->window) {
-	    uint32_t values[7];
+	    uint32_t values[3];
 	    int i;
 
-	    i = 0;
-	    // send configure to docked client
-	    if (event->value_mask & XCB_CONFIG_WINDOW_X) {
-		values[i++] = event->x;
-	    }
-	    if (event->value_mask & XCB_CONFIG_WINDOW_X) {
-		values[i++] = event->y;
-	    }
+	    // remember wanted size, layout resizes window into its slot
 	    if (event->value_mask & XCB_CONFIG_WINDOW_WIDTH) {
-		values[i++] = event->width;
+		docked->RequestedWidth = event->width;
 	    }
 	    if (event->value_mask & XCB_CONFIG_WINDOW_HEIGHT) {
-		values[i++] = event->height;
+		docked->RequestedHeight = event->height;
 	    }
+	    // force configure, tells window the result of its request
+	    docked->Width = 0;
+
+	    // position and size are controlled by layout, send only the rest
+	    i = 0;
 	    if (event->value_mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) {
 		values[i++] = event->border_width;
 	    }
@@ -389,9 +440,12 @@ int SystrayHandleConfigureRequest(const xcb_configure_request_event_t * event)
 	    if (event->value_mask & XCB_CONFIG_WINDOW_STACK_MODE) {
 		values[i++] = event->stack_mode;
 	    }
-
-	    xcb_configure_window(Connection, docked->Window, event->value_mask,
-		values);
+	    if (i) {
+		xcb_configure_window(Connection, docked->Window,
+		    event->value_mask & (XCB_CONFIG_WINDOW_BORDER_WIDTH |
+			XCB_CONFIG_WINDOW_SIBLING |
+			XCB_CONFIG_WINDOW_STACK_MODE), values);
+	    }
 
 	    SystrayUpdate();
 	    return 1;
@@ -400,6 +454,40 @@ int SystrayHandleConfigureRequest(const xcb_configure_request_event_t * event)
     return 0;
 }
 
+/**
+**	Handle a configure notify event.
+**
+**	Track geometry of docked windows, avoids geometry requests on layout.
+**
+**	@param event	X11 configure notify event
+**
+**	@returns 1 if handled, 0 otherwise.
+*/
+int SystrayHandleConfigureNotify(const xcb_configure_notify_event_t * event)
+{
+    SystrayWindow *docked;
+
+    if (!Systray) {			// no systray ready
+	return 0;
+    }
+    // synthetic events (send_event bit) carry nothing new
+    if (event->response_type & 0x80) {
+	return 0;
+    }
+
+    SLIST_FOREACH(docked, &Systray->Docked, Next) {
+	// look if this window is docked
+	if (docked->Window == event->window) {
+	    docked->X = event->x;
+	    docked->Y = event->y;
+	    docked->Width = event->width;
+	    docked->Height = event->height;
+	    return 1;
+	}
+    }
+    return 0;
+}
+
 /**
 **	Handle a reparent notify event.
 **
@@ -450,6 +538,9 @@ int SystrayHandleDestroyNotify(xcb_window_t window)
 	if (docked->Window == window) {
 	    // remove from list and free
 	    SLIST_REMOVE(&Systray->Docked, docked, _systray_window_, Next);
+	    if (docked->GeometryPending) {
+		xcb_discard_reply(Connection, docked->Cookie.sequence);
+	    }
 	    free(docked);
 
 	    //
@@ -694,7 +785,7 @@ void SystrayInit(void)
 	    XCB_COPY_FROM_PARENT, XCB_CW_BACK_PIXEL, &Colors.PanelBG.Pixel);
 
 	// FIXME: can delay reply until create
-	if (!(reply = xcb_intern_atom_reply(Connection, cookie, NULL))) {
+	if (!(reply = StatsReply(xcb_intern_atom_reply, cookie, NULL))) {
 	    Warning("error getting systray atom\n");
 	    return;
 	}
@@ -731,6 +822,9 @@ void SystrayExit(void)
 		    XcbScreen->root, 0, 0);
 
 		SLIST_REMOVE_HEAD(&Systray->Docked, Next);
+		if (docked->GeometryPending) {
+		    xcb_discard_reply(Connection, docked->Cookie.sequence);
+		}
 		free(docked);
 	    }
 
@@ -35,6 +35,10 @@ extern int SystrayHandleResizeRequest(const xcb_resize_request_event_t *);
 extern int SystrayHandleConfigureRequest(const xcb_configure_request_event_t
     *);
 
+    /// Handle a configure notify event.
+extern int SystrayHandleConfigureNotify(const xcb_configure_notify_event_t
+    *);
+
     /// Handle a reparent notify event.
 extern int SystrayHandleReparentNotify(const xcb_reparent_notify_event_t *);
 
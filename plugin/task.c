@@ -77,6 +77,16 @@
 */
 typedef struct _task_plugin_ TaskPlugin;
 
+/**
+**	Cached rendering of a task button.
+*/
+typedef struct _task_button_
+{
+    const Client *Client;		///< client of button (only compared)
+    uint32_t Hash;			///< hash of rendered content
+    xcb_pixmap_t Pixmap;		///< rendered button
+} TaskButton;
+
 /**
 **	Panel task plugin structure.
 */
@@ -90,6 +100,10 @@ struct _task_plugin_
 
     int16_t ItemHeight;			///< common height of items
     uint16_t MaxItemWidth;		///< maximal item width
+
+    uint16_t ButtonWidth;		///< item width of cached buttons
+    int ButtonN;			///< number of cached buttons
+    TaskButton *Buttons;		///< cached buttons in slot order
 };
 
     /// Task plugin list head structure
@@ -403,9 +417,149 @@ static Client *TaskGetClient(TaskPlugin * task_plugin, int xy)
     return NULL;
 }
 
+/**
+**	Hash the inputs of a task button rendering.
+**
+**	@param client	client of task button
+**	@param width	width of task button
+**	@param height	height of task button
+**
+**	@returns FNV-1a hash over everything drawn for the button.
+*/
+static uint32_t TaskButtonHash(const Client * client, unsigned width,
+    unsigned height)
+{
+    uint32_t hash;
+    uintptr_t values[5];
+    const char *s;
+    int i;
+
+    values[0] = width;
+    values[1] = height;
+    values[2] = client->State & (WM_STATE_ACTIVE | WM_STATE_MINIMIZED);
+#ifdef USE_ICON
+    values[3] = (uintptr_t) client->Icon;
+#else
+    values[3] = 0;
+#endif
+    values[4] = (uintptr_t) client;
+
+    hash = 2166136261U;
+    for (i = 0; i < 5; ++i) {
+	hash = (hash ^ values[i]) * 16777619U;
+    }
+    if ((s = client->Name)) {
+	while (*s) {
+	    hash = (hash ^ (uint8_t) * s++) * 16777619U;
+	}
+    }
+    return hash;
+}
+
+/**
+**	Render a task button into its own pixmap.
+**
+**	@param task_plugin	task plugin data
+**	@param client		client of task button
+**	@param width		width of task button
+**	@param height		height of task button
+**
+**	@returns pixmap with rendered task button.
+*/
+static xcb_pixmap_t TaskRenderButton(const TaskPlugin * task_plugin,
+    const Client * client, unsigned width, unsigned height)
+{
+    xcb_pixmap_t pixmap;
+    xcb_rectangle_t rectangle;
+    Label label;
+    char buf[128];
+
+    pixmap = xcb_generate_id(Connection);
+    xcb_create_pixmap(Connection, XcbScreen->root_depth, pixmap,
+	XcbScreen->root, width, height);
+
+    xcb_change_gc(Connection, RootGC, XCB_GC_FOREGROUND,
+	&Colors.PanelBG.Pixel);
+    rectangle.x = 0;
+    rectangle.y = 0;
+    rectangle.width = width;
+    rectangle.height = height;
+    xcb_poly_fill_rectangle(Connection, pixmap, RootGC, 1, &rectangle);
+
+    LabelReset(&label, pixmap, RootGC);
+    label.Font = &Fonts.Task;
+    if (client->State & WM_STATE_ACTIVE) {
+	label.Type = LABEL_TASK_ACTIVE;
+    } else {
+	label.Type = LABEL_TASK;
+    }
+    label.Width = width;
+    label.Height = height;
+#ifdef USE_ICON
+    label.Icon = client->Icon;
+#endif
+
+    if (client->State & WM_STATE_MINIMIZED) {
+	if (client->Name) {
+	    snprintf(buf, sizeof(buf), "[%s]", client->Name);
+	    label.Text = buf;
+	} else {
+	    label.Text = "[]";
+	}
+    } else {
+	label.Text = client->Name;
+    }
+    LabelDraw(&label);
+
+    if (client->State & WM_STATE_MINIMIZED) {
+	uint32_t values[4];
+
+	values[0] = Colors.TaskFG.Pixel;
+	values[1] = 3;
+	values[2] = task_plugin->ItemHeight - TASK_MINIMIZED_HEIGHT - 3;
+	values[3] = MinimizedPixmap;
+	xcb_change_gc(Connection, RootGC,
+	    XCB_GC_FOREGROUND | XCB_GC_CLIP_ORIGIN_X | XCB_GC_CLIP_ORIGIN_Y |
+	    XCB_GC_CLIP_MASK, values);
+	rectangle.x = 3;
+	rectangle.y = task_plugin->ItemHeight - TASK_MINIMIZED_HEIGHT - 3;
+	rectangle.width = TASK_MINIMIZED_WIDTH;
+	rectangle.height = TASK_MINIMIZED_HEIGHT;
+	xcb_poly_fill_rectangle(Connection, pixmap, RootGC, 1, &rectangle);
+	values[0] = XCB_NONE;
+	xcb_change_gc(Connection, RootGC, XCB_GC_CLIP_MASK, values);
+    }
+
+    return pixmap;
+}
+
+/**
+**	Free cached task buttons.
+**
+**	@param task_plugin	task plugin data
+*/
+static void TaskButtonsDel(TaskPlugin * task_plugin)
+{
+    int i;
+
+    for (i = 0; i < task_plugin->ButtonN; ++i) {
+	if (task_plugin->Buttons[i].Pixmap) {
+	    xcb_free_pixmap(Connection, task_plugin->Buttons[i].Pixmap);
+	}
+    }
+    free(task_plugin->Buttons);
+    task_plugin->Buttons = NULL;
+    task_plugin->ButtonN = 0;
+}
+
 /**
 **	Draw a specific task.
 **
+**	Each task button is rendered into its own cached pixmap.  Buttons
+**	are only rendered again, if their title, state, icon or size changed.
+**	Cached buttons are copied to their slot.  If the layout is unchanged,
+**	only changed slots are copied to the panel.
+**
 **	@param task_plugin	task plugin data
 */
 static void TaskDraw(TaskPlugin * task_plugin)
@@ -413,16 +567,15 @@ static void TaskDraw(TaskPlugin * task_plugin)
     Panel *panel;
     Plugin *plugin;
     int n;
+    int i;
     int x;
     int y;
     unsigned width;
-
-    //unsigned height;
     unsigned item_width;
     int remainder;
-    Label label;
+    int full;
+    TaskButton *buttons;
     Client *client;
-    char buf[128];
 
     plugin = task_plugin->Plugin;
     if (!(panel = plugin->Panel)) {
@@ -430,15 +583,9 @@ static void TaskDraw(TaskPlugin * task_plugin)
 	return;
     }
 
-    PanelClearPluginBackground(plugin);
-
-    if (!(n = TaskGetTaskCount())) {	// no tasks ready
-	PanelUpdatePlugin(panel, plugin);
-	return;
-    }
+    n = TaskGetTaskCount();
 
     width = plugin->Width;
-    //height = plugin->Height;
     x = TASK_INNER_SPACE;
     width -= x;
     y = PANEL_INNER_SPACE;
@@ -451,84 +598,95 @@ static void TaskDraw(TaskPlugin * task_plugin)
 	remainder = 0;
     }
 
-    LabelReset(&label, plugin->Pixmap, RootGC);
-    label.Font = &Fonts.Task;
+    // slots are only kept, if number and size of buttons are unchanged
+    full = !task_plugin->Buttons || n != task_plugin->ButtonN
+	|| item_width != task_plugin->ButtonWidth;
+    if (full) {
+	PanelClearPluginBackground(plugin);
+    }
+    if (!n) {				// no tasks ready
+	TaskButtonsDel(task_plugin);
+	PanelUpdatePlugin(panel, plugin);
+	return;
+    }
 
+    buttons = calloc(n, sizeof(*buttons));
+    i = 0;
     SLIST_FOREACH(client, &ClientNetList, NetClient) {
-	if (TaskShouldShowItem(client)) {
-	    if (client->State & WM_STATE_ACTIVE) {
-		label.Type = LABEL_TASK_ACTIVE;
+	TaskButton *button;
+	unsigned label_width;
+	unsigned label_height;
+	int j;
+
+	if (!TaskShouldShowItem(client)) {
+	    continue;
+	}
+	label_width = item_width - TASK_INNER_SPACE - 1;
+	label_height = task_plugin->ItemHeight - 1;
+	if (remainder) {
+	    if (task_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
+		label_width++;
 	    } else {
-		label.Type = LABEL_TASK;
+		label_height++;
 	    }
+	}
 
-	    label.Width = item_width - TASK_INNER_SPACE - 1;
-	    label.Height = task_plugin->ItemHeight - 1;
-	    if (remainder) {
-		if (task_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-		    label.Width++;
-		} else {
-		    label.Height++;
-		}
-	    }
+	button = buttons + i;
+	button->Client = client;
+	button->Hash = TaskButtonHash(client, label_width, label_height);
 
-	    label.X = x;
-	    label.Y = y;
-#ifdef USE_ICON
-	    label.Icon = client->Icon;
-#endif
+	// find old rendering of client, most likely in same slot
+	for (j = 0; j < task_plugin->ButtonN; ++j) {
+	    TaskButton *old;
 
-	    if (client->State & WM_STATE_MINIMIZED) {
-		if (client->Name) {
-		    snprintf(buf, sizeof(buf), "[%s]", client->Name);
-		    label.Text = buf;
-		} else {
-		    label.Text = "[]";
+	    old = task_plugin->Buttons + (i + j) % task_plugin->ButtonN;
+	    if (old->Pixmap && old->Client == client) {
+		if (old->Hash == button->Hash) {
+		    button->Pixmap = old->Pixmap;	// take over
+		    old->Pixmap = XCB_NONE;
 		}
-	    } else {
-		label.Text = client->Name;
+		break;
 	    }
-	    LabelDraw(&label);
-
-	    if (client->State & WM_STATE_MINIMIZED) {
-		uint32_t values[4];
-		xcb_rectangle_t rectangle;
-
-		values[0] = Colors.TaskFG.Pixel;
-		values[1] = x + 3;
-		values[2] =
-		    y + task_plugin->ItemHeight - TASK_MINIMIZED_HEIGHT - 3;
-		values[3] = MinimizedPixmap;
-		xcb_change_gc(Connection, RootGC,
-		    XCB_GC_FOREGROUND | XCB_GC_CLIP_ORIGIN_X |
-		    XCB_GC_CLIP_ORIGIN_Y | XCB_GC_CLIP_MASK, values);
-		rectangle.x = x + 3;
-		rectangle.y =
-		    y + task_plugin->ItemHeight - TASK_MINIMIZED_HEIGHT - 3;
-		rectangle.width = TASK_MINIMIZED_WIDTH;
-		rectangle.height = TASK_MINIMIZED_HEIGHT;
-		xcb_poly_fill_rectangle(Connection, plugin->Pixmap, RootGC, 1,
-		    &rectangle);
-		values[0] = XCB_NONE;
-		xcb_change_gc(Connection, RootGC, XCB_GC_CLIP_MASK, values);
+	}
+	// same content in same slot, nothing to do
+	if (full || !button->Pixmap || j) {
+	    if (!button->Pixmap) {
+		button->Pixmap =
+		    TaskRenderButton(task_plugin, client, label_width,
+		    label_height);
 	    }
+	    xcb_copy_area(Connection, button->Pixmap, plugin->Pixmap, RootGC,
+		0, 0, x, y, label_width, label_height);
+	    if (!full) {
+		PanelUpdatePluginArea(panel, plugin, x, y, label_width,
+		    label_height);
+	    }
+	}
 
-	    if (task_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
-		x += item_width;
-		if (remainder) {
-		    ++x;
-		    --remainder;
-		}
-	    } else {
-		y += task_plugin->ItemHeight;
-		if (remainder) {
-		    ++y;
-		    --remainder;
-		}
+	if (task_plugin->Layout == PANEL_LAYOUT_HORIZONTAL) {
+	    x += item_width;
+	    if (remainder) {
+		++x;
+		--remainder;
+	    }
+	} else {
+	    y += task_plugin->ItemHeight;
+	    if (remainder) {
+		++y;
+		--remainder;
 	    }
 	}
+	++i;
+    }
+
+    TaskButtonsDel(task_plugin);
+    task_plugin->Buttons = buttons;
+    task_plugin->ButtonN = n;
+    task_plugin->ButtonWidth = item_width;
+
+    if (full) {
+	PanelUpdatePlugin(panel, plugin);
     }
-    PanelUpdatePlugin(panel, plugin);
 }
 
 /**
@@ -634,10 +792,25 @@ static void TaskSetSize(Plugin * plugin, unsigned width, unsigned height)
 */
 void TaskResize(Plugin * plugin)
 {
-    // free old pixmap
-    PanelPluginDeletePixmap(plugin);
-    // create new size pixmap
+    TaskPlugin *task_plugin;
+
+    // create new size pixmap, same size pixmap is reused
     TaskCreate(plugin);
+
+    // new pixmap is empty, all slots must be drawn
+    task_plugin = plugin->Object;
+    task_plugin->ButtonWidth = 0;
+}
+
+/**
+**	Delete a task panel plugin.
+**
+**	@param plugin	panel plugin
+*/
+static void TaskDelete(Plugin * plugin)
+{
+    TaskButtonsDel(plugin->Object);
+    PanelPluginDeletePixmap(plugin);
 }
 
 /**
@@ -742,6 +915,7 @@ void TaskExit(void)
 	task_plugin = SLIST_FIRST(&Tasks);
 
 	SLIST_REMOVE_HEAD(&Tasks, Next);
+	TaskButtonsDel(task_plugin);
 	free(task_plugin);
     }
 
@@ -796,7 +970,7 @@ Plugin *TaskConfig(const ConfigObject * array)
     task_plugin->Plugin = plugin;
 
     plugin->Create = TaskCreate;
-    plugin->Delete = PanelPluginDeletePixmap;
+    plugin->Delete = TaskDelete;
     plugin->SetSize = TaskSetSize;
     plugin->Resize = TaskResize;
     plugin->Tooltip = TaskTooltip;
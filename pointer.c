@@ -55,6 +55,7 @@
 #endif
 
 #include "pointer.h"
+#include "stats.h"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -121,7 +122,7 @@ int PointerGrabReply(xcb_grab_pointer_cookie_t cookie)
 {
     xcb_grab_pointer_reply_t *reply;
 
-    reply = xcb_grab_pointer_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_grab_pointer_reply, cookie, NULL);
     if (reply) {
 	int status;
 
@@ -189,7 +190,7 @@ xcb_button_mask_t PointerQueryReply(xcb_query_pointer_cookie_t cookie)
     xcb_button_mask_t mask;
 
     mask = 0;
-    reply = xcb_query_pointer_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_query_pointer_reply, cookie, NULL);
     if (reply) {
 	PointerX = reply->root_x;
 	PointerY = reply->root_y;
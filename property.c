@@ -56,6 +56,7 @@
 
 #include "panel.h"
 #include "plugin/task.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 // Property
@@ -221,7 +222,7 @@ static int HandlePropertyDebug(uint8_t state, xcb_window_t window,
     }
 
     cookie = xcb_get_atom_name_unchecked(Connection, atom);
-    reply = xcb_get_atom_name_reply(Connection, cookie, NULL);
+    reply = StatsReply(xcb_get_atom_name_reply, cookie, NULL);
     if (reply) {
 	n = xcb_get_atom_name_name_length(reply);
 	name = xcb_get_atom_name_name(reply);
@@ -256,7 +257,7 @@ static xcb_get_property_reply_t *PropertyGet(uint8_t state,
 	cookie =
 	    xcb_get_property_unchecked(Connection, 0, window, atom,
 	    XCB_GET_PROPERTY_TYPE_ANY, 0U, len);
-	reply = xcb_get_property_reply(Connection, cookie, NULL);
+	reply = StatsReply(xcb_get_property_reply, cookie, NULL);
 
 	return reply;
     }
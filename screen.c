@@ -60,6 +60,7 @@
 #include "plugin/pager.h"
 
 #include "screen.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 
@@ -125,8 +126,8 @@ void ScreenInit(void)
     xcb_xinerama_is_active_reply_t *active_reply;
 
     active_cookie = xcb_xinerama_is_active_unchecked(Connection);
-    active_reply =
-	xcb_xinerama_is_active_reply(Connection, active_cookie, NULL);
+    active_reply = StatsReply(xcb_xinerama_is_active_reply, active_cookie,
+	NULL);
 
     if (active_reply) {
 	Debug(3, "xcb_xinerama_is_active %d\n", active_reply->state);
@@ -135,9 +136,8 @@ void ScreenInit(void)
 	    xcb_xinerama_query_screens_reply_t *query_reply;
 
 	    query_cookie = xcb_xinerama_query_screens_unchecked(Connection);
-	    query_reply =
-		xcb_xinerama_query_screens_reply(Connection, query_cookie,
-		NULL);
+	    query_reply = StatsReply(xcb_xinerama_query_screens_reply,
+		query_cookie, NULL);
 	    if (query_reply) {
 		xcb_xinerama_screen_info_iterator_t iter;
 		int i;
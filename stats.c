@@ -0,0 +1,514 @@
+///
+///	@file stats.c	@brief runtime statistics functions
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+///
+///	@defgroup stats The runtime statistics module.
+///
+///	This module collects lightweight runtime statistics: number and
+///	handling time of each event type, round-trips per call site, bytes
+///	sent to the X11 server per event loop iteration and redraws.
+///
+///	The statistics are written as text into the _UWM_STATISTICS
+///	property of the root window, when a _UWM_STATISTICS client message
+///	is received (uwm -s).
+///
+///	With #USE_STATS_AUDIT every reply wait is also timed and the age of
+///	the request is estimated.  The ranked report is printed at exit and
+///	on SIGUSR1.
+///
+/// @{
+
+#define _GNU_SOURCE	1		///< fix open_memstream
+
+#include <xcb/xcb.h>
+#include "uwm.h"
+
+#ifdef USE_STATS			// {
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+
+#include <xcb/xcb_event.h>
+#include <xcb/xcb_icccm.h>
+
+#include "queue.h"
+#include "client.h"
+#include "hints.h"
+#include "stats.h"
+
+/// number of log2 histogram buckets
+#define STATS_BUCKETS	16
+/// maximal tracked nesting of event dispatch
+#define STATS_DEPTH	8
+
+/**
+**	Statistics of one event type.
+*/
+typedef struct _stats_event_
+{
+    unsigned Count;			///< number of handled events
+    unsigned Modal;			///< events running a nested loop
+    unsigned Max;			///< longest handling time in us
+    uint64_t Total;			///< total handling time in us
+    unsigned Histogram[STATS_BUCKETS];	///< log2 handling time in us
+} StatsEventType;
+
+static StatsEventType StatsEvents[128];	///< statistics per event type
+static unsigned StatsEventDepth;	///< nesting of event dispatch
+static char StatsEventModal[STATS_DEPTH];	///< dispatch has nested loop
+
+static StatsSite *StatsSites;		///< list of round-trip call sites
+
+static unsigned StatsLoops;		///< event loop iterations
+static uint64_t StatsWritten;		///< bytes written before iteration
+static unsigned StatsLoopHistogram[STATS_BUCKETS];	///< log2 bytes
+
+static unsigned StatsRedraws[STATS_REDRAW_MAX];	///< redraw counters
+
+/// Names of redraw counters.
+static const char *const StatsRedrawNames[STATS_REDRAW_MAX] = {
+    "border", "panel", "pager"
+};
+
+/**
+**	Get log2 histogram bucket.
+**
+**	@param value	value to account
+**
+**	@returns bucket index, bucket i holds values below 2^i.
+*/
+static int StatsBucket(uint64_t value)
+{
+    int i;
+
+    i = 0;
+    while (i < STATS_BUCKETS - 1 && value >= (1U << i)) {
+	++i;
+    }
+    return i;
+}
+
+/**
+**	Get time stamp for statistics.
+**
+**	@returns monotonic time in us.
+*/
+uint64_t StatsGetTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+**	Start accounting of a handled event.
+**
+**	Menus, move/resize and other modal loops dispatch events from
+**	inside an event handler.  The outer event is marked modal.
+**
+**	@returns time stamp before the event is handled.
+*/
+uint64_t StatsEventStart(void)
+{
+    if (StatsEventDepth && StatsEventDepth <= STATS_DEPTH) {
+	StatsEventModal[StatsEventDepth - 1] = 1;
+    }
+    if (StatsEventDepth < STATS_DEPTH) {
+	StatsEventModal[StatsEventDepth] = 0;
+    }
+    ++StatsEventDepth;
+    return StatsGetTime();
+}
+
+/**
+**	Account a handled event.
+**
+**	The handling time of modal events isn't accounted, it contains the
+**	time of the nested loop, including waiting for user input.
+**
+**	@param type	event response type
+**	@param start	time stamp before the event was handled
+*/
+void StatsEvent(int type, uint64_t start)
+{
+    StatsEventType *stats;
+    uint64_t time;
+
+    time = StatsGetTime() - start;
+    stats = &StatsEvents[type & 0x7F];
+    stats->Count++;
+    if (--StatsEventDepth < STATS_DEPTH
+	&& StatsEventModal[StatsEventDepth]) {
+	stats->Modal++;
+	return;
+    }
+    stats->Total += time;
+    if (time > stats->Max) {
+	stats->Max = time;
+    }
+    stats->Histogram[StatsBucket(time)]++;
+}
+
+/**
+**	Account a round-trip.
+**
+**	@param site	call site waiting for the reply
+*/
+void StatsRoundTrip(StatsSite * site)
+{
+    if (!site->Count++) {		// first use, add to list
+	site->Next = StatsSites;
+	StatsSites = site;
+    }
+}
+
+#ifdef USE_STATS_AUDIT
+
+/// number of request sequence samples
+#define STATS_SAMPLES	64
+
+/**
+**	Sample of request sequence number and time.
+**
+**	Xcb gives no time for issued requests, a no-operation request is
+**	issued after each reply wait and each event loop iteration.  A
+**	request was issued after the newest sample with lower sequence.
+*/
+typedef struct _stats_sample_
+{
+    unsigned Sequence;			///< sequence of no-operation request
+    uint64_t Time;			///< time stamp of sample
+} StatsSample;
+
+static StatsSample StatsSamples[STATS_SAMPLES];	///< ring of samples
+static unsigned StatsSampleIndex;	///< next sample in ring
+static uint64_t StatsSampleWritten;	///< bytes of no-operation requests
+
+    /// audit report requested by signal
+static volatile sig_atomic_t StatsAuditSignaled;
+
+/**
+**	Sample current request sequence number.
+*/
+static void StatsAuditSample(void)
+{
+    StatsSample *sample;
+
+    sample = &StatsSamples[StatsSampleIndex++ % STATS_SAMPLES];
+    sample->Sequence = xcb_no_operation(Connection).sequence;
+    sample->Time = StatsGetTime();
+    StatsSampleWritten += sizeof(xcb_no_operation_request_t);
+}
+
+/**
+**	Estimate time a request was issued.
+**
+**	@param sequence	sequence number of request
+**	@param now	current time stamp
+**
+**	@returns time stamp, at or after which the request was issued.
+*/
+static uint64_t StatsAuditIssued(unsigned sequence, uint64_t now)
+{
+    const StatsSample *sample;
+    unsigned i;
+
+    sample = NULL;
+    for (i = 1; i <= STATS_SAMPLES && i <= StatsSampleIndex; ++i) {
+	sample = &StatsSamples[(StatsSampleIndex - i) % STATS_SAMPLES];
+	if ((int)(sample->Sequence - sequence) < 0) {
+	    break;			// sample before request
+	}
+    }
+    // without sample before, the oldest sample is the best guess
+    return sample ? sample->Time : now;
+}
+
+/**
+**	Audit a reply wait.
+**
+**	@param site	call site waiting for the reply
+**	@param sequence	sequence number of request
+**	@param start	time stamp before waiting for the reply
+*/
+void StatsAuditReply(StatsSite * site, unsigned sequence, uint64_t start)
+{
+    uint64_t now;
+    uint64_t wait;
+    uint64_t age;
+
+    now = StatsGetTime();
+    wait = now - start;
+    age = now - StatsAuditIssued(sequence, now);
+
+    StatsRoundTrip(site);
+    site->Wait += wait;
+    if (wait > site->MaxWait) {
+	site->MaxWait = wait;
+    }
+    site->Age += age;
+    if (age > site->MaxAge) {
+	site->MaxAge = age;
+    }
+
+    StatsAuditSample();
+}
+
+/**
+**	Compare call sites by total wait.
+**
+**	@param a	first call site
+**	@param b	second call site
+**
+**	@returns <0 if a waited longer, >0 if b waited longer, 0 if equal.
+*/
+static int StatsAuditCompare(const void *a, const void *b)
+{
+    const StatsSite *site_a;
+    const StatsSite *site_b;
+
+    site_a = *(const StatsSite * const *)a;
+    site_b = *(const StatsSite * const *)b;
+    if (site_a->Wait != site_b->Wait) {
+	return site_a->Wait > site_b->Wait ? -1 : 1;
+    }
+    return site_b->Count - site_a->Count;
+}
+
+/**
+**	Print round-trip audit, ranked by total wait.
+**
+**	@param out	output stream
+*/
+static void StatsAuditPrint(FILE * out)
+{
+    StatsSite *site;
+    StatsSite **sites;
+    int n;
+    int i;
+
+    n = 0;
+    for (site = StatsSites; site; site = site->Next) {
+	++n;
+    }
+    if (!(sites = malloc(n * sizeof(*sites)))) {
+	return;
+    }
+    n = 0;
+    for (site = StatsSites; site; site = site->Next) {
+	sites[n++] = site;
+    }
+    qsort(sites, n, sizeof(*sites), StatsAuditCompare);
+
+    fprintf(out, "round-trip audit, ranked by total wait (us):\n");
+    fprintf(out, "  %8s %10s %8s %8s %8s  %s\n", "count", "wait", "max",
+	"age avg", "max", "call site");
+    for (i = 0; i < n; ++i) {
+	site = sites[i];
+	fprintf(out, "  %8u %10llu %8u %8llu %8u  %s:%d\n", site->Count,
+	    (unsigned long long)site->Wait, site->MaxWait,
+	    (unsigned long long)(site->Age / site->Count), site->MaxAge,
+	    site->Function, site->Line);
+    }
+    free(sites);
+}
+
+/**
+**	Print round-trip audit report.
+*/
+void StatsAuditReport(void)
+{
+    StatsAuditPrint(stdout);
+    fflush(stdout);
+}
+
+/**
+**	Signal handler for audit report.
+**
+**	The report is printed by the event loop.
+**
+**	@param signum	unused signal number
+*/
+static void StatsAuditSignal(int __attribute__((unused)) signum)
+{
+    signal(SIGUSR1, StatsAuditSignal);
+    StatsAuditSignaled = 1;
+}
+
+/**
+**	Initialize round-trip audit.
+*/
+void StatsAuditInit(void)
+{
+    signal(SIGUSR1, StatsAuditSignal);
+}
+
+#endif
+
+/**
+**	Account an event loop iteration.
+**
+**	Xcb doesn't count the requests, the bytes written to the X11 server
+**	are used instead.  The no-operation requests of the audit aren't
+**	counted.
+*/
+void StatsLoop(void)
+{
+    uint64_t written;
+
+#ifdef USE_STATS_AUDIT
+    // all sampled no-operation requests must be written
+    xcb_flush(Connection);
+    written = xcb_total_written(Connection) - StatsSampleWritten;
+#else
+    written = xcb_total_written(Connection);
+#endif
+    StatsLoops++;
+    StatsLoopHistogram[StatsBucket(written - StatsWritten)]++;
+    StatsWritten = written;
+
+#ifdef USE_STATS_AUDIT
+    StatsAuditSample();
+    if (StatsAuditSignaled) {
+	StatsAuditSignaled = 0;
+	StatsAuditReport();
+    }
+#endif
+}
+
+/**
+**	Account a redraw.
+**
+**	@param counter	which redraw
+*/
+void StatsRedrawCount(StatsRedraw counter)
+{
+    StatsRedraws[counter]++;
+}
+
+/**
+**	Print log2 histogram.
+**
+**	@param out		output stream
+**	@param histogram	histogram buckets
+**	@param unit		unit of values
+*/
+static void StatsPrintHistogram(FILE * out, const unsigned *histogram,
+    const char *unit)
+{
+    int i;
+
+    for (i = 0; i < STATS_BUCKETS; ++i) {
+	if (histogram[i]) {
+	    if (i == STATS_BUCKETS - 1) {
+		fprintf(out, " >=%u%s:%u", 1U << (i - 1), unit, histogram[i]);
+	    } else {
+		fprintf(out, " <%u%s:%u", 1U << i, unit, histogram[i]);
+	    }
+	}
+    }
+    fputc('\n', out);
+}
+
+/**
+**	Print all statistics.
+**
+**	@param out	output stream
+*/
+static void StatsPrint(FILE * out)
+{
+#ifndef USE_STATS_AUDIT
+    const StatsSite *site;
+#endif
+    int i;
+
+    fprintf(out, "events:\n");
+    for (i = 0; i < 128; ++i) {
+	const StatsEventType *stats;
+	const char *label;
+
+	stats = &StatsEvents[i];
+	if (!stats->Count) {
+	    continue;
+	}
+	if (!(label = xcb_event_get_label(i))) {	// extension event
+	    label = "Extension";
+	}
+	fprintf(out, "  %-20s %3d %8u modal %4u avg %6llu max %6u us:",
+	    label, i, stats->Count, stats->Modal,
+	    (unsigned long long)(stats->Count > stats->Modal ? stats->Total /
+		(stats->Count - stats->Modal) : 0), stats->Max);
+	StatsPrintHistogram(out, stats->Histogram, "us");
+    }
+
+#ifdef USE_STATS_AUDIT
+    StatsAuditPrint(out);
+#else
+    fprintf(out, "round-trips:\n");
+    for (site = StatsSites; site; site = site->Next) {
+	fprintf(out, "  %-32s %5d %8u\n", site->Function, site->Line,
+	    site->Count);
+    }
+#endif
+
+    fprintf(out, "loop: %u iterations, %llu bytes written:\n ", StatsLoops,
+	(unsigned long long)StatsWritten);
+    StatsPrintHistogram(out, StatsLoopHistogram, "b");
+
+    fprintf(out, "redraws:");
+    for (i = 0; i < STATS_REDRAW_MAX; ++i) {
+	fprintf(out, " %s:%u", StatsRedrawNames[i], StatsRedraws[i]);
+    }
+    fputc('\n', out);
+}
+
+/**
+**	Write the statistics to the root window property.
+**
+**	The _UWM_STATISTICS property contains the statistics as text.
+*/
+void StatsUpdateProperty(void)
+{
+    FILE *out;
+    char *text;
+    size_t size;
+
+    if (!(out = open_memstream(&text, &size))) {
+	Warning("can't create statistics\n");
+	return;
+    }
+    StatsPrint(out);
+    fclose(out);
+
+    xcb_change_property(Connection, XCB_PROP_MODE_REPLACE, XcbScreen->root,
+	Atoms.UWM_STATISTICS.Atom, XCB_ATOM_STRING, 8, size, text);
+    free(text);
+}
+
+#endif // } USE_STATS
+
+/// @}
@@ -0,0 +1,184 @@
+///
+///	@file stats.h	@brief runtime statistics header file
+///
+///	Copyright (c) 2026 by the uwm contributors.  All Rights Reserved.
+///
+///	Contributor(s):
+///
+///	License: AGPLv3
+///
+///	This program is free software: you can redistribute it and/or modify
+///	it under the terms of the GNU Affero General Public License as
+///	published by the Free Software Foundation, either version 3 of the
+///	License.
+///
+///	This program is distributed in the hope that it will be useful,
+///	but WITHOUT ANY WARRANTY; without even the implied warranty of
+///	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///	GNU Affero General Public License for more details.
+///
+///	$Id$
+//////////////////////////////////////////////////////////////////////////////
+
+/// @addtogroup stats
+/// @{
+
+//////////////////////////////////////////////////////////////////////////////
+//	Defines
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+**	Redraw counters.
+*/
+typedef enum _stats_redraw_
+{
+    STATS_REDRAW_BORDER,		///< client border/title redrawn
+    STATS_REDRAW_PANEL,			///< panel area redrawn
+    STATS_REDRAW_PAGER,			///< pager desktop redrawn
+    STATS_REDRAW_MAX			///< number of redraw counters
+} StatsRedraw;
+
+//////////////////////////////////////////////////////////////////////////////
+//	Structures
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+**	Round-trip call site.
+**
+**	Each wait for a reply has its own static call site, which is
+**	linked into the list of all call sites with its first round-trip.
+*/
+typedef struct _stats_site_ StatsSite;
+
+/**
+**	Structure of a round-trip call site.
+*/
+struct _stats_site_
+{
+    StatsSite *Next;			///< next call site in list
+    const char *Function;		///< function name of call site
+    int Line;				///< source line of call site
+    unsigned Count;			///< number of round-trips
+#ifdef USE_STATS_AUDIT
+    unsigned MaxWait;			///< longest wait for reply in us
+    uint64_t Wait;			///< total wait for reply in us
+    unsigned MaxAge;			///< longest request age in us
+    uint64_t Age;			///< total request age in us
+#endif
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//	Prototypes
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef USE_STATS
+
+    /// Get time stamp for statistics.
+extern uint64_t StatsGetTime(void);
+
+    /// Start accounting of a handled event.
+extern uint64_t StatsEventStart(void);
+
+    /// Account a handled event.
+extern void StatsEvent(int, uint64_t);
+
+    /// Account an event loop iteration.
+extern void StatsLoop(void);
+
+    /// Account a round-trip.
+extern void StatsRoundTrip(StatsSite *);
+
+    /// Account a redraw.
+extern void StatsRedrawCount(StatsRedraw);
+
+    /// Write the statistics to the root window property.
+extern void StatsUpdateProperty(void);
+
+#ifdef USE_STATS_AUDIT
+
+    /// Audit a reply wait.
+extern void StatsAuditReply(StatsSite *, unsigned, uint64_t);
+
+    /// Print round-trip audit report.
+extern void StatsAuditReport(void);
+
+    /// Initialize round-trip audit.
+extern void StatsAuditInit(void);
+
+/**
+**	Wait for reply and audit the round-trip of this call site.
+**
+**	Measures the time waiting for the reply and the age of the request.
+**
+**	@param function	xcb reply function
+**	@param cookie	cookie of request
+**	@param args	further arguments of @a function
+**
+**	@returns result of @a function.
+*/
+#define StatsReply(function, cookie, args...) \
+    ({ static StatsSite _site_ = {.Function = __FUNCTION__, \
+	.Line = __LINE__}; \
+	__typeof__(cookie) _cookie_ = (cookie); \
+	uint64_t _start_ = StatsGetTime(); \
+	__typeof__(function(Connection, _cookie_, ##args)) _reply_ = \
+	    function(Connection, _cookie_, ##args); \
+	StatsAuditReply(&_site_, _cookie_.sequence, _start_); _reply_; })
+
+#else
+
+    /// Dummy for print round-trip audit report.
+#define StatsAuditReport()
+    /// Dummy for initialize round-trip audit.
+#define StatsAuditInit()
+
+/**
+**	Wait for reply and account the round-trip to this call site.
+**
+**	@param function	xcb reply function
+**	@param cookie	cookie of request
+**	@param args	further arguments of @a function
+**
+**	@returns result of @a function.
+*/
+#define StatsReply(function, cookie, args...) \
+    ({ static StatsSite _site_ = {.Function = __FUNCTION__, \
+	.Line = __LINE__}; StatsRoundTrip(&_site_); \
+	function(Connection, cookie, ##args); })
+
+#endif
+
+#else
+
+    /// Dummy for get time stamp for statistics.
+#define StatsGetTime()	0
+    /// Dummy for start accounting of a handled event.
+#define StatsEventStart()	0
+    /// Dummy for account a handled event.
+#define StatsEvent(type, start)
+    /// Dummy for account an event loop iteration.
+#define StatsLoop()
+    /// Dummy for account a redraw.
+#define StatsRedrawCount(counter)
+    /// Dummy for write the statistics to the root window property.
+#define StatsUpdateProperty()
+    /// Dummy for print round-trip audit report.
+#define StatsAuditReport()
+    /// Dummy for initialize round-trip audit.
+#define StatsAuditInit()
+    /// Dummy for wait for reply and account the round-trip.
+#define StatsReply(function, cookie, args...) \
+    function(Connection, cookie, ##args)
+
+#endif
+
+/**
+**	Synchronize with the X server, like xcb_aux_sync.
+**
+**	The round-trip is accounted to this call site.
+*/
+#define StatsSync() \
+    free(StatsReply(xcb_get_input_focus_reply, \
+	xcb_get_input_focus(Connection), NULL))
+
+/// @}
@@ -50,6 +50,7 @@
 **	- builtin panel(s) (other names are slit/bar/dock) with:
 **		- button
 **		- clock
+**		- graph (cpu, memory, disk, pressure)
 **		- netload
 **		- pager
 **		- swallow (dock)
@@ -88,8 +89,10 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <poll.h>
 
 #include <xcb/xcb_atom.h>
+#include <xcb/xcb_event.h>
 #include <xcb/xcb_aux.h>
 #include <xcb/xcb_icccm.h>
 #ifdef USE_SHAPE
@@ -129,6 +132,7 @@
 #include "plugin/button.h"
 #include "plugin/clock.h"
 #include "plugin/netload.h"
+#include "plugin/graph.h"
 #include "plugin/pager.h"
 #include "plugin/swallow.h"
 #include "plugin/systray.h"
@@ -136,6 +140,7 @@
 
 #include "dia.h"
 #include "td.h"
+#include "stats.h"
 
 // ------------------------------------------------------------------------ //
 // Variables
@@ -234,6 +239,7 @@ static void ModulesInit(void)
     TaskInit();				// need client
     SystrayInit();
     NetloadInit();
+    GraphInit();
     PanelInit();
     ClientInit();			// need task, pager
     SwallowInit();			// needs client
@@ -245,7 +251,7 @@ static void ModulesInit(void)
     HintGetNetCurrentDesktop(net_current_desktop_cookie);
 
     // allow clients to do their thing
-    xcb_aux_sync(Connection);
+    StatsSync();
     xcb_ungrab_server(Connection);
 
     // draw all panels
@@ -271,9 +277,11 @@ static void ModulesExit(void)
     //StatusExit();
     PlacementExit();
     TooltipExit();
+    DiaExit();
 
     PanelExit();			// panel exit befor plugin exit
     NetloadExit();
+    GraphExit();
     SystrayExit();
     SwallowExit();
     TaskExit();
@@ -410,6 +418,7 @@ static void ConnectionInit(void)
     signal(SIGTERM, SignalHandler);
     signal(SIGINT, SignalHandler);
     signal(SIGHUP, SignalHandler);
+    StatsAuditInit();
 
 #ifdef USE_SHAPE
     query_extension_reply = xcb_get_extension_data(Connection, &xcb_shape_id);
@@ -551,11 +560,199 @@ static void GlobalConfig(const Config * config)
 }
 
 /**
-**	Parse configuration file.
+**	Config sections, which can be reloaded independently.
+*/
+typedef enum _reload_section_
+{
+    RELOAD_GLOBAL,			///< global scalar settings
+    RELOAD_COLOR,			///< colors
+    RELOAD_FONT,			///< fonts
+    RELOAD_BORDER,			///< window borders
+    RELOAD_KEYBOARD,			///< key bindings
+    RELOAD_RULE,			///< client rules
+    RELOAD_MENU,			///< menus
+    RELOAD_TOOLTIP,			///< tooltip
+    RELOAD_BACKGROUND,			///< desktop backgrounds
+    RELOAD_PANEL,			///< panels and plugins
+    RELOAD_RESTART,			///< needs a full restart
+    RELOAD_MAX				///< number of reload sections
+} ReloadSection;
+
+/**
+**	Table of config keys and their reload section.
+**
+**	Unknown keys need a full restart.
+*/
+static const struct
+{
+    const char *Key;			///< top level config key
+    ReloadSection Section;		///< section of key
+} ReloadKeys[] = {
+    {"focus-model", RELOAD_GLOBAL},
+    {"double-click", RELOAD_GLOBAL},
+    {"move", RELOAD_GLOBAL},
+    {"resize", RELOAD_GLOBAL},
+    {"snap", RELOAD_GLOBAL},
+    {"dia", RELOAD_GLOBAL},
+    {"color", RELOAD_COLOR},
+    {"font", RELOAD_FONT},
+    {"border", RELOAD_BORDER},
+    {"key-binding", RELOAD_KEYBOARD},
+    {"key-sequence", RELOAD_KEYBOARD},
+    {"rule", RELOAD_RULE},
+    {"root-menu", RELOAD_MENU},
+    {"root", RELOAD_MENU},
+    {"show-exit-confirmation", RELOAD_MENU},
+    {"show-kill-confirmation", RELOAD_MENU},
+    {"window-menu-user-height", RELOAD_MENU},
+    {"tooltip", RELOAD_TOOLTIP},
+    {"background", RELOAD_BACKGROUND},
+    {"panel", RELOAD_PANEL},
+};
+
+static const char *ConfigFileName;	///< config file name for reload
+static uint32_t ReloadHashes[RELOAD_MAX];	///< hashes of loaded config
+
+/**
+**	Hash bytes (FNV-1a).
+**
+**	@param hash	start value
+**	@param data	bytes to hash
+**	@param size	number of bytes
+**
+**	@returns hash of data.
+*/
+static uint32_t ConfigHashBytes(uint32_t hash, const void *data, size_t size)
+{
+    const uint8_t *s;
+
+    for (s = data; size--; ++s) {
+	hash = (hash ^ *s) * 16777619U;
+    }
+    return hash;
+}
+
+static uint32_t ConfigHashArray(const ConfigObject *);
+
+/**
+**	Hash a config key/value pair.
+**
+**	@param array	array containing the pair
+**	@param index	key of the pair
+**	@param value	value of the pair
+**
+**	@returns hash of the key/value pair.
+*/
+static uint32_t ConfigHashValue(const ConfigObject * array,
+    const ConfigObject * index, const ConfigObject * value)
+{
+    uint32_t hash;
+    const char *key;
+    const char *sval;
+    const ConfigObject *aval;
+    ssize_t ival;
+    double dval;
+
+    hash = 2166136261U;
+    key = NULL;
+    if (ConfigCheckString(index, &key)) {
+	hash = ConfigHashBytes(hash, key, strlen(key) + 1);
+    } else if (ConfigCheckInteger(index, &ival)) {
+	hash = ConfigHashBytes(hash, &ival, sizeof(ival));
+    }
+
+    if (ConfigCheckString(value, &sval)) {
+	hash = ConfigHashBytes(hash, "s", 1);
+	hash = ConfigHashBytes(hash, sval, strlen(sval));
+    } else if (ConfigCheckInteger(value, &ival)) {
+	hash = ConfigHashBytes(hash, "i", 1);
+	hash = ConfigHashBytes(hash, &ival, sizeof(ival));
+    } else if (ConfigCheckArray(value, &aval)) {
+	uint32_t array_hash;
+
+	array_hash = ConfigHashArray(aval);
+	hash = ConfigHashBytes(hash, "a", 1);
+	hash = ConfigHashBytes(hash, &array_hash, sizeof(array_hash));
+    } else if (key && ConfigStringsGetDouble(array, &dval, key, NULL)) {
+	hash = ConfigHashBytes(hash, "d", 1);
+	hash = ConfigHashBytes(hash, &dval, sizeof(dval));
+    } else if (key) {
+	ival = ConfigStringsGetBoolean(array, key, NULL);
+	hash = ConfigHashBytes(hash, "b", 1);
+	hash = ConfigHashBytes(hash, &ival, sizeof(ival));
+    }
+    return hash;
+}
+
+/**
+**	Hash a config array.
+**
+**	The entries are summed, the result doesn't depend on the order in
+**	which entries are returned.
+**
+**	@param array	config array (list or dictionary)
+**
+**	@returns hash of array.
+*/
+static uint32_t ConfigHashArray(const ConfigObject * array)
+{
+    const ConfigObject *index;
+    const ConfigObject *value;
+    uint32_t hash;
+
+    hash = 0;
+    index = NULL;
+    value = ConfigArrayFirst(array, &index);
+    while (value) {
+	hash += ConfigHashValue(array, index, value);
+	value = ConfigArrayNext(array, &index);
+    }
+    return hash;
+}
+
+/**
+**	Hash all reload sections of a configuration.
+**
+**	@param config		global config dictionary
+**	@param[out] hashes	hash of each reload section
+*/
+static void ConfigHashSections(const Config * config,
+    uint32_t hashes[RELOAD_MAX])
+{
+    const ConfigObject *index;
+    const ConfigObject *value;
+
+    memset(hashes, 0, RELOAD_MAX * sizeof(*hashes));
+
+    index = NULL;
+    value = ConfigArrayFirst(ConfigDict(config), &index);
+    while (value) {
+	ReloadSection section;
+	const char *key;
+	size_t i;
+
+	section = RELOAD_RESTART;
+	if (ConfigCheckString(index, &key)) {
+	    for (i = 0; i < sizeof(ReloadKeys) / sizeof(*ReloadKeys); ++i) {
+		if (!strcmp(key, ReloadKeys[i].Key)) {
+		    section = ReloadKeys[i].Section;
+		    break;
+		}
+	    }
+	}
+	hashes[section] += ConfigHashValue(ConfigDict(config), index, value);
+	value = ConfigArrayNext(ConfigDict(config), &index);
+    }
+}
+
+/**
+**	Read configuration file.
 **
 **	@param filename config file name
+**
+**	@returns parsed config, NULL if no config could be parsed.
 */
-static void ParseConfig(const char *filename)
+static Config *ConfigLoad(const char *filename)
 {
     char *name;
     Config *config;
@@ -582,6 +779,23 @@ static void ParseConfig(const char *filename)
     } else {
 	Debug(2, "Config '%s' loaded\n", filename);
     }
+    return config;
+}
+
+/**
+**	Parse configuration file.
+**
+**	@param filename config file name
+*/
+static void ParseConfig(const char *filename)
+{
+    Config *config;
+
+    config = ConfigLoad(filename);
+    ConfigFileName = filename;
+    if (config) {
+	ConfigHashSections(config, ReloadHashes);
+    }
 
     GlobalConfig(config);
     CommandConfig(config);
@@ -606,8 +820,226 @@ static void ParseConfig(const char *filename)
     ConfigFreeMem(config);
 }
 
-#else // }{ USE_RC
+/**
+**	Swallow windows again after panel reload.
+**
+**	The old swallow plugins have reparented their windows to the root
+**	window, look for them in the unmanaged top level windows.  Windows
+**	started by swallow commands are kept and adopted again.
+*/
+static void ReloadSwallow(void)
+{
+    xcb_query_tree_reply_t *reply;
+    xcb_window_t *children;
+    int len;
+    int i;
+
+    if (!(reply = StatsReply(xcb_query_tree_reply,
+	    xcb_query_tree_unchecked(Connection, XcbScreen->root), NULL))) {
+	return;
+    }
+    len = xcb_query_tree_children_length(reply);
+    children = xcb_query_tree_children(reply);
+    for (i = 0; i < len; ++i) {
+	if (!ClientFindByAny(children[i])) {
+	    SwallowTryWindow(1, children[i]);
+	}
+    }
+    free(reply);
+}
+
+/**
+**	Reload configuration without restart.
+**
+**	The configuration file is parsed again and compared section by
+**	section with the running configuration.  Only modules of changed
+**	sections are cleaned up and initialized again, clients and their
+**	frames are kept.  Changes which can't be applied in place (desktops,
+**	commands, icon paths, ...) restart the window manager.
+*/
+void ReloadConfig(void)
+{
+    Config *config;
+    uint32_t hashes[RELOAD_MAX];
+    unsigned changed;
+    Client *client;
+    int i;
+
+    if (!(config = ConfigLoad(ConfigFileName))) {
+	Warning("reload failed, keeping running configuration\n");
+	return;
+    }
+    ConfigHashSections(config, hashes);
+
+    changed = 0;
+    for (i = 0; i < RELOAD_MAX; ++i) {
+	if (hashes[i] != ReloadHashes[i]) {
+	    changed |= 1 << i;
+	}
+    }
+    Debug(2, "reload: changed sections %#x\n", changed);
+    if (!changed) {
+	ConfigFreeMem(config);
+	return;
+    }
+    if (changed & (1 << RELOAD_RESTART)) {
+	Debug(2, "reload: changes need restart\n");
+	ConfigFreeMem(config);
+	KeepRunning = 1;
+	KeepLooping = 0;
+	return;
+    }
+    memcpy(ReloadHashes, hashes, sizeof(ReloadHashes));
+
+    // dependencies: panels, menus and tooltip are drawn with colors/fonts,
+    // frames with fonts
+    if (changed & (1 << RELOAD_COLOR)) {
+	changed |=
+	    (1 << RELOAD_MENU) | (1 << RELOAD_TOOLTIP) | (1 << RELOAD_PANEL);
+    }
+    if (changed & (1 << RELOAD_FONT)) {
+	changed |=
+	    (1 << RELOAD_BORDER) | (1 << RELOAD_MENU) | (1 << RELOAD_PANEL);
+    }
+    //
+    //	cleanup changed modules, like ModulesExit
+    //
+    if (changed & (1 << RELOAD_PANEL)) {
+	KeepRunning = 1;		// keep systray, docked and swallowed
+	PanelExit();
+	NetloadExit();
+	GraphExit();
+	SystrayExit();
+	SwallowExit();
+	TaskExit();
+	PagerExit();
+	PanelButtonExit();
+	ClockExit();
+	KeepRunning = 0;
+    }
+    if (changed & (1 << RELOAD_MENU)) {
+	RootMenuExit();
+    }
+    if (changed & (1 << RELOAD_TOOLTIP)) {
+	TooltipExit();
+    }
+    if (changed & (1 << RELOAD_RULE)) {
+	RuleExit();
+    }
+    if (changed & (1 << RELOAD_KEYBOARD)) {
+	KeyboardExit();
+    }
+    if (changed & (1 << RELOAD_BORDER)) {
+	BorderExit();
+    }
+    if (changed & (1 << RELOAD_FONT)) {
+	FontExit();
+    }
+    if (changed & (1 << RELOAD_BACKGROUND)) {
+	BackgroundExit();
+    }
+    if (changed & (1 << RELOAD_COLOR)) {
+	ColorExit();
+    }
+    //
+    //	parse changed sections, like ParseConfig
+    //
+    if (changed & (1 << RELOAD_GLOBAL)) {
+	GlobalConfig(config);
+	StatusConfig(config);
+	OutlineConfig(config);
+	SnapConfig(config);
+	DiaConfig(config);
+    }
+    if (changed & (1 << RELOAD_COLOR)) {
+	ColorConfig(config);
+    }
+    if (changed & (1 << RELOAD_FONT)) {
+	FontConfig(config);
+    }
+    if (changed & (1 << RELOAD_TOOLTIP)) {
+	TooltipConfig(config);
+    }
+    if (changed & (1 << RELOAD_BACKGROUND)) {
+	BackgroundConfig(config);
+    }
+    if (changed & (1 << RELOAD_RULE)) {
+	RuleConfig(config);
+    }
+    if (changed & (1 << RELOAD_BORDER)) {
+	BorderConfig(config);
+    }
+    if (changed & (1 << RELOAD_KEYBOARD)) {
+	KeyboardConfig(config);
+    }
+    if (changed & (1 << RELOAD_MENU)) {
+	MenuConfig(config);
+	RootMenuConfig(config);
+    }
+    if (changed & (1 << RELOAD_PANEL)) {
+	PanelConfig(config);
+    }
+    ConfigFreeMem(config);
 
+    //
+    //	initialize changed modules, like ModulesInit
+    //
+    if (changed & (1 << RELOAD_COLOR)) {
+	ColorInit();
+    }
+    if (changed & (1 << RELOAD_BACKGROUND)) {
+	BackgroundPreInit();
+	BackgroundInit();
+	BackgroundLoad(DesktopCurrent);
+    }
+    if (changed & (1 << RELOAD_FONT)) {
+	FontInit();
+    }
+    if (changed & (1 << RELOAD_BORDER)) {
+	BorderInit();
+	// border or title size may have changed
+	SLIST_FOREACH(client, &ClientNetList, NetClient) {
+	    ClientUpdateFrame(client);
+	}
+    }
+    if (changed & (1 << RELOAD_KEYBOARD)) {
+	KeyboardInit();
+	SLIST_FOREACH(client, &ClientNetList, NetClient) {
+	    xcb_ungrab_key(Connection, XCB_GRAB_ANY, client->Window,
+		XCB_MOD_MASK_ANY);
+	    KeyboardGrabBindings(client);
+	}
+    }
+    if (changed & (1 << RELOAD_RULE)) {
+	RuleInit();
+    }
+    if (changed & (1 << RELOAD_TOOLTIP)) {
+	TooltipInit();
+    }
+    if (changed & (1 << RELOAD_MENU)) {
+	RootMenuInit();
+    }
+    if (changed & (1 << RELOAD_PANEL)) {
+	ClockInit();
+	PanelButtonInit();
+	PagerInit();
+	TaskInit();
+	SystrayInit();
+	NetloadInit();
+	GraphInit();
+	PanelInit();
+	ReloadSwallow();
+	SwallowInit();
+
+	TaskUpdate();
+	PagerUpdate();
+    }
+
+    PanelsDraw();
+    RedrawCurrentDesktop();
+}
+
+#else // }{ USE_RC
     /// Dummy for Parse configuration file.
 #define ParseConfig(filename)
 
@@ -616,19 +1048,18 @@ static void ParseConfig(const char *filename)
 // ------------------------------------------------------------------------ //
 
 /**
-**	Send message to root window.
+**	Send message to root window over open connection.
 **
 **	@param string	Message string
 **
-**	@note when this function is called, no module is available
+**	@returns atom of message string.
 */
-static void SendClientMessage(const char *string)
+static xcb_atom_t SendClientMessageAtom(const char *string)
 {
     xcb_client_message_event_t event;
     xcb_intern_atom_cookie_t cookies;
     xcb_intern_atom_reply_t *reply;
 
-    ConnectionOpen();
     cookies = xcb_intern_atom_unchecked(Connection, 0, strlen(string), string);
 
     memset(&event, 0, sizeof(event));
@@ -646,7 +1077,20 @@ static void SendClientMessage(const char *string)
     } else {
 	FatalError("Can't send client message '%s'\n", string);
     }
+    return event.type;
+}
 
+/**
+**	Send message to root window.
+**
+**	@param string	Message string
+**
+**	@note when this function is called, no module is available
+*/
+static void SendClientMessage(const char *string)
+{
+    ConnectionOpen();
+    SendClientMessageAtom(string);
     ConnectionClose();
 }
 
@@ -658,6 +1102,14 @@ static void SendRestart(void)
     SendClientMessage("_UWM_RESTART");
 }
 
+/**
+**	Send _UWM_RELOAD to root window.
+*/
+static void SendReload(void)
+{
+    SendClientMessage("_UWM_RELOAD");
+}
+
 /**
 **	Send _UWM_EXIT to root window.
 */
@@ -666,6 +1118,69 @@ static void SendExit(void)
     SendClientMessage("_UWM_EXIT");
 }
 
+#ifdef USE_STATS
+
+/**
+**	Query runtime statistics of running window manager.
+**
+**	Sends _UWM_STATISTICS to the root window and prints the
+**	_UWM_STATISTICS property of the root window, after the window
+**	manager has updated it.
+**
+**	@returns -1 on failures, 0 success.
+*/
+static int QueryStatistics(void)
+{
+    uint32_t value;
+    xcb_atom_t atom;
+    xcb_generic_event_t *event;
+    xcb_get_property_cookie_t cookie;
+    xcb_get_property_reply_t *reply;
+    struct pollfd fds[1];
+    int updated;
+
+    ConnectionOpen();
+
+    // must select property changes, before the message is sent
+    value = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(Connection, XcbScreen->root,
+	XCB_CW_EVENT_MASK, &value);
+    atom = SendClientMessageAtom("_UWM_STATISTICS");
+    xcb_flush(Connection);
+
+    fds[0].fd = xcb_get_file_descriptor(Connection);
+    fds[0].events = POLLIN;
+    updated = 0;
+    while (!updated) {
+	if (poll(fds, 1, 2000) <= 0 || xcb_connection_has_error(Connection)) {
+	    fprintf(stderr, "No statistics from window manager\n");
+	    ConnectionClose();
+	    return -1;
+	}
+	while ((event = xcb_poll_for_event(Connection))) {
+	    if (XCB_EVENT_RESPONSE_TYPE(event) == XCB_PROPERTY_NOTIFY
+		&& ((xcb_property_notify_event_t *) event)->atom == atom) {
+		updated = 1;
+	    }
+	    free(event);
+	}
+    }
+
+    cookie =
+	xcb_get_property_unchecked(Connection, 0, XcbScreen->root, atom,
+	XCB_ATOM_STRING, 0, UINT32_MAX / 4);
+    if ((reply = xcb_get_property_reply(Connection, cookie, NULL))) {
+	fwrite(xcb_get_property_value(reply), 1,
+	    xcb_get_property_value_length(reply), stdout);
+	free(reply);
+    }
+
+    ConnectionClose();
+    return 0;
+}
+
+#endif
+
 // ------------------------------------------------------------------------ //
 
 /**
@@ -686,12 +1201,17 @@ static void PrintVersion(void)
 */
 static void PrintUsage(void)
 {
-    printf("Usage: wm [-?|-h] [-c config] [-d X] [-e] [-p] [-r] [-v]\n"
+    printf("Usage: wm [-?|-h] [-c config] [-d X] [-e] [-l] [-p] [-r] [-s]"
+	" [-v]\n"
 	"\t-c config\tload configuration from config\n"
 	"\t-d X\tset the X display to use\n"
 	"\t-e\texit WM (send _UWM_EXIT to the root window)\n"
+	"\t-l\treload WM configuration (send _UWM_RELOAD to the root window)\n"
 	"\t-r\trestart WM (send _UWM_RESTART to the root window)\n"
 	"\t-p\tparse the configuration file and exit\n"
+#ifdef USE_STATS
+	"\t-s\tprint runtime statistics of the running WM\n"
+#endif
 #ifdef DEBUG
 	"\t-D\tincrease debug level (more and verbose output)\n"
 #endif
@@ -737,7 +1257,7 @@ int main(int argc, char *const argv[])
     //	Parse command line arguments
     //
     for (;;) {
-	switch (getopt(argc, argv, "hv?-c:d:eprD")) {
+	switch (getopt(argc, argv, "hv?-c:d:elprsD")) {
 	    case 'c':			// config file
 		config_filename = optarg;
 		continue;
@@ -747,9 +1267,19 @@ int main(int argc, char *const argv[])
 	    case 'e':			// send exit
 		SendExit();
 		return 0;
+	    case 'l':			// send reload
+		SendReload();
+		return 0;
 	    case 'r':			// send restart
 		SendRestart();
 		return 0;
+	    case 's':			// query statistics
+#ifdef USE_STATS
+		return QueryStatistics();
+#else
+		fprintf(stderr, "\nCompiled without statistics support\n");
+		return -1;
+#endif
 	    case 'p':			// parse configuration only
 		ConnectionOpen();
 		ParseConfig(config_filename);
@@ -818,6 +1348,8 @@ int main(int argc, char *const argv[])
 
     } while (KeepRunning);
 
+    StatsAuditReport();
+
     ConnectionExit();
 
     //
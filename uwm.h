@@ -52,6 +52,9 @@
 #if defined(DOXYGEN) || !defined(NO_MENU_DIR) && !defined(USE_MENU_DIR)
 #define USE_MENU_DIR			///< include directory menu
 #endif
+#if defined(DOXYGEN) || !defined(NO_MENU_FILTER) && !defined(USE_MENU_FILTER)
+#define USE_MENU_FILTER			///< include menu type-to-filter
+#endif
 #endif
 
 #if defined(DOXYGEN) || !defined(NO_TOOLTIP) && !defined(USE_TOOLTIP)
@@ -83,6 +86,16 @@
 #if defined(DOXYGEN) || !defined(NO_NETLOAD) && !defined(USE_NETLOAD)
 #define USE_NETLOAD			///< include panel netload plugin
 #endif
+#if defined(DOXYGEN) || !defined(NO_GRAPH) && !defined(USE_GRAPH)
+#define USE_GRAPH			///< include panel graph plugin
+#endif
+#ifdef USE_NETLOAD
+#if defined(DOXYGEN) || !defined(NO_NETLOAD_NETLINK) \
+    && !defined(USE_NETLOAD_NETLINK)
+#define USE_NETLOAD_NETLINK		///< netload uses netlink statistics
+#undef USE_NETLOAD_NETLINK
+#endif
+#endif
 #endif
 
 #if defined(DOXYGEN) || !defined(NO_BACKGROUND) && !defined(USE_BACKGROUND)
@@ -137,6 +150,16 @@
 #endif
 #if defined(DOXYGEN) || !defined(NO_RENDER) && !defined(USE_RENDER)
 #define USE_RENDER			///< render support
+#endif
+	// thumbnails are scaled by render and drawn by pager plugin
+#if defined(USE_RENDER) && defined(USE_PAGER)
+#if defined(DOXYGEN) || !defined(NO_PAGER_THUMBNAIL) \
+    && !defined(USE_PAGER_THUMBNAIL)
+#define USE_PAGER_THUMBNAIL		///< pager thumbnails (composite+damage)
+#undef USE_PAGER_THUMBNAIL
+#endif
+#else
+#undef USE_PAGER_THUMBNAIL
 #endif
 #if defined(DOXYGEN) || !defined(NO_XMU) && !defined(USE_XMU)
 #define USE_XMU				///< xmu emulation support
@@ -154,6 +177,16 @@
 #undef USE_MOTIF_HINTS
 #endif
 
+#if defined(DOXYGEN) || !defined(NO_STATS) && !defined(USE_STATS)
+#define USE_STATS			///< include runtime statistics
+#endif
+#ifdef USE_STATS			// audit needs statistics
+#if defined(DOXYGEN) || !defined(NO_STATS_AUDIT) && !defined(USE_STATS_AUDIT)
+#define USE_STATS_AUDIT			///< include round-trip audit
+#undef USE_STATS_AUDIT
+#endif
+#endif
+
 #if defined(DOXYGEN) || !defined(NO_DEBUG) && !defined(USE_DEBUG)
 #define USE_DEBUG			///< generate debug code
 #undef USE_DEBUG
@@ -194,6 +227,9 @@
 
 #define MENU_INNER_SPACE 2		///< inner border of menu items
 #define MENU_SEPARATOR_HEIGHT 5		///< height of menu separator item
+#define MENU_DIR_CACHE_SIZE 32		///< number of cached directory menus
+#define MENU_FILTER_MAX 32		///< max length of menu filter text
+#define MENU_FILTER_RESULTS 500		///< max shown filter matches
 
 #define PANEL_DEFAULT_WIDTH 32		///< default panel width
 #define PANEL_DEFAULT_HEIGHT 32		///< default panel height
@@ -201,6 +237,9 @@
 #define PANEL_DEFAULT_BORDER 1		///< default border width
 #define PANEL_MAXIMAL_BORDER 32		///< maximal panel border width
 #define PANEL_DEFAULT_HIDE_SIZE 1	///< default size while hideing
+#define PANEL_DEFAULT_SHOW_DELAY 0	///< default autohide show delay in ms
+#define PANEL_DEFAULT_HIDE_DELAY 0	///< default autohide hide delay in ms
+#define PANEL_SLIDE_STEPS 4		///< steps of panel slide animation
 
 #define PANEL_INNER_SPACE 1		///< panel inner space
 
@@ -212,6 +251,8 @@
 #define CLOCK_DEFAULT_LONG_FORMAT "%c"	///< default long time format
 #endif
 
+#define PAGER_THUMBNAIL_DELAY 500	///< min. ms between thumbnail refresh
+
 #define TASK_INNER_SPACE 2		///< task inner spacing
 
 #define TOOLTIP_DEFAULT_DELAY 500	///< tooltip delay
@@ -236,6 +277,10 @@
 #define DOUBLE_CLICK_DEFAULT_SPEED 250	///< default time for double click
 #define DOUBLE_CLICK_MAXIMAL_SPEED 2000	///< maximal time for double click
 
+#define KEYBOARD_MINIMAL_TIMEOUT 100	///< minimal key sequence timeout
+#define KEYBOARD_DEFAULT_TIMEOUT 1500	///< default key sequence timeout
+#define KEYBOARD_MAXIMAL_TIMEOUT 10000	///< maximal key sequence timeout
+
 #define SNAP_MINIMAL_DISTANCE 1		///< minimum snap distance
 #define SNAP_DEFAULT_DISTANCE 5		///< default snap distance
 #define SNAP_MAXIMAL_DISTANCE 32	///< maximal snap distance
@@ -356,6 +401,18 @@ extern volatile char KeepLooping;	///< keep looping
     /// Parse gravity.
 extern Gravity ParseGravity(const char *, const char *);
 
+#ifdef USE_RC				// {
+
+    /// Reload configuration without restart.
+extern void ReloadConfig(void);
+
+#else // }{ USE_RC
+
+    /// Dummy for reload configuration.
+#define ReloadConfig()
+
+#endif // } !USE_RC
+
     /// Signal desktop change
 #define DesktopUpdate() \
     PanelButtonDesktopUpdate()